@@ -2,7 +2,7 @@
 cd ..
 
 echo Starting premake...
-premake5 vs2015
+premake5 vs2019
 
 cd bat
 @echo on
@@ -15,6 +15,8 @@ local winApps =
 local consoleApps =
 {
   "unit-test",  -- unit test
+  "benchmark",  -- performance benchmarks
+  "compile-benchmark",  -- compile-time benchmark over a generated unit catalog
 }
 -- Table of projects that use Unicode.  These names should have the
 --   same name as the folder the project's source code is located in
@@ -112,6 +114,10 @@ local sourceDir   = "./src"
 local outDir      = "./bin"
 local debugDir    = "./working"
 
+-- compile-time benchmark catalog size, e.g. "premake5 vs2019 --units=1000 --relations=2000"
+newoption({trigger = "units",     value = "N", description = "Basic units generated for the compile-time benchmark (default 400)"})
+newoption({trigger = "relations", value = "M", description = "Derived units generated for the compile-time benchmark (default 400)"})
+
 
 -- Search through all directories and subdirectories of path and return all of them
 -- t - file directory table (to be filled)
@@ -145,11 +151,49 @@ function ReadDependencies(fileName)
   return t
 end
 
+-- Writes the compile-time benchmark's unit catalog into path/generated
+-- numUnits basic units, and numRelations derived units, each the product or quotient of two basic units,
+--   plus a source file that evaluates every relation
+function GenerateUnitCatalog(path, numUnits, numRelations)
+  numUnits = math.max(2, numUnits)
+  os.mkdir(path .. "/generated")
+  local header = io.open(path .. "/generated/catalog.h", "w")
+  local source = io.open(path .. "/generated/relations.cpp", "w")
+
+  header:write("// generated by premake5.lua, do not edit\n\n")
+  header:write("#ifndef COMPILE_BENCHMARK_CATALOG_H\n#define COMPILE_BENCHMARK_CATALOG_H\n\n\n")
+  header:write("#include \"units/units.h\"\n\n")
+  header:write(string.format("static const int kNumUnits = %d;\nstatic const int kNumRelations = %d;\n\n", numUnits, numRelations))
+  for i = 0, numUnits - 1 do
+    header:write(string.format("MAKE_BASIC_UNIT(Unit%d, float, _u%d);\n", i, i))
+  end
+  header:write("\n")
+
+  source:write("// generated by premake5.lua, do not edit\n\n")
+  source:write("#include \"generated/catalog.h\"\n\nfloat EvaluateRelations()\n{\n  float sum = 0.0f;\n")
+  for i = 0, numRelations - 1 do
+    local lhs = i % numUnits
+    local rhs = (i * 7 + 1) % numUnits
+    if rhs == lhs then
+      rhs = (rhs + 1) % numUnits
+    end
+    local isProduct = (i % 2 == 0)
+    header:write(string.format("MAKE_DERIVED_UNIT_%s(Relation%d, float, _r%d, Unit%d, Unit%d);\n", isProduct and "MUL" or "DIV", i, i, lhs, rhs))
+    source:write(string.format("  sum += (Unit%d::From(1.5f) %s Unit%d::From(2.0f) + Relation%d::From(1.0f)).GetRaw();\n", lhs, isProduct and "*" or "/", rhs, i))
+  end
+  header:write("\n\n#endif\n")
+  source:write("  return sum;\n}\n")
+
+  header:close()
+  source:close()
+end
+
 -- This function sets up a visual studio project
 local allProjectIncludeDirs = {}
 function SetUpProj(projName, projType, locPath, pchFile, fileDir, outDir)
   kind(projType)
   language("C++")
+  cppdialect("C++20")
   location(locPath)
   libdirs(libDirs)
   objdir(objDir)
@@ -207,6 +251,15 @@ function SetUpProj(projName, projType, locPath, pchFile, fileDir, outDir)
   -- set build options
   opt = "/FI" .. pchFile .. ".h"  -- force include precompiled header
   buildoptions({opt})	                        -- apply build options to project
+
+  -- per-file compile times for the compile-time benchmark
+  if projName == "compile-benchmark" then
+    filter("toolset:msc*")
+      buildoptions({"/Bt+", "/d1reportTime"})
+    filter("toolset:clang")
+      buildoptions({"-ftime-trace"})
+    filter({})
+  end
   
   -- set character set
   for _, name in ipairs(unicodeApps)
@@ -265,6 +318,9 @@ if _ACTION ~= nil then
       return
     end
     
+    -- generate the compile-time benchmark's sources before its project picks up files
+    GenerateUnitCatalog(sourceDir .. "/app/compile-benchmark", tonumber(_OPTIONS["units"] or 400), tonumber(_OPTIONS["relations"] or 400))
+
     -- create windowed apps, libraries, and console apps
     for j = 1, 4 do
     -- set default variable names
@@ -0,0 +1,40 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+// best-of-N wall time of a function, in nanoseconds per element
+template <typename Function>
+double MeasureNanosecondsPerElement(const std::size_t numElements, const Function &function)
+{
+  const int kNumRuns = 20;
+  double best = 0.0;
+  for (int run = 0; run < kNumRuns; ++run)
+  {
+    const auto begin = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double, std::nano>(end - begin).count();
+    best = (run == 0 || elapsed < best) ? elapsed : best;
+  }
+  return best / double(numElements);
+}
+
+// keeps results alive without the optimizer seeing through them
+void Consume(const float value);
+
+void RunMathBenchmark();
+void RunParseBenchmark();
+void RunIngestBenchmark();
+void RunReduceBenchmark();
+void RunHistogramBenchmark();
+
+
+#endif
@@ -0,0 +1,40 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#include "benchmark.h"
+
+#include "units/units.h"
+#include "units/histogram.h"
+
+
+MAKE_BASIC_UNIT(Time, float, _s);
+
+void RunHistogramBenchmark()
+{
+  // latencies spread over 5 decades
+  const std::size_t kNumValues = 1 << 16;
+  std::vector<Time> latencies(kNumValues);
+  for (std::size_t i = 0; i < kNumValues; ++i)
+    latencies[i] = Time::From(1.0e-5f * std::pow(10.0f, 5.0f * float(i * 7919 % kNumValues) / float(kNumValues)));
+
+  units::Histogram<Time> histogram(1.0e-6_s, 60_s);
+  const double histogramTime = MeasureNanosecondsPerElement(kNumValues, [&]() { for (const Time latency : latencies) histogram.Record(latency); });
+
+  units::ShardedHistogram<Time> sharded(1.0e-6_s, 60_s);
+  units::ShardedHistogram<Time>::Recorder recorder = sharded.GetRecorder();
+  const double recorderTime = MeasureNanosecondsPerElement(kNumValues, [&]() { for (const Time latency : latencies) recorder.Record(latency); });
+
+  units::QuantileSketch<Time> sketch;
+  const double sketchTime = MeasureNanosecondsPerElement(kNumValues, [&]() { for (const Time latency : latencies) sketch.Record(latency); });
+
+  Consume(histogram.GetPercentile(0.99).GetRaw() + sharded.Snapshot().GetPercentile(0.99).GetRaw() + sketch.GetPercentile(0.99).GetRaw());
+  std::printf("histogram: record cost, %zu latencies over 5 decades\n", kNumValues);
+  std::printf("  Histogram         %6.2f ns\n", histogramTime);
+  std::printf("  ShardedHistogram  %6.2f ns   per-thread recorder\n", recorderTime);
+  std::printf("  QuantileSketch    %6.2f ns\n", sketchTime);
+}
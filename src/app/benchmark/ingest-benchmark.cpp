@@ -0,0 +1,59 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#include "benchmark.h"
+
+#include "units/units.h"
+#include "units/ingest.h"
+
+
+MAKE_BASIC_UNIT(Length, float, _m);
+MAKE_BASIC_UNIT(Time, float, _s);
+MAKE_BASIC_UNIT(Voltage, float, _v);
+MAKE_SCALED_UNIT(Kilometers, _km, Length, std::kilo);
+MAKE_SCALED_UNIT(Milliseconds, _ms, Time, std::milli);
+MAKE_SCALED_UNIT(Millivolts, _mv, Voltage, std::milli);
+
+void RunIngestBenchmark()
+{
+  constexpr auto kTimeSymbols = units::MakeSymbolSet<Time>(units::Symbol<Time>("s"), units::Symbol<Milliseconds>("ms"));
+  constexpr auto kLengthSymbols = units::MakeSymbolSet<Length>(units::Symbol<Length>("m"), units::Symbol<Kilometers>("km"));
+  constexpr auto kVoltageSymbols = units::MakeSymbolSet<Voltage>(units::Symbol<Voltage>("V"), units::Symbol<Millivolts>("mV"));
+
+  // sensor log: bare milliseconds, an unused field, then values with symbols
+  const std::size_t kNumRows = 1 << 19;
+  std::string csv = "time_ms,sensor,altitude,voltage\n";
+  char line[96];
+  for (std::size_t i = 0; i < kNumRows; ++i)
+  {
+    const int length = std::snprintf(line, sizeof(line), "%zu,probe-%zu,%.4g %s,%.4g %s\n", i * 10, i % 16, 0.01 * double(i * 7919 % 100003), (i % 2) ? "km" : "m", 0.1 * double(i % 3301), (i % 3) ? "mV" : "V");
+    csv.append(line, std::size_t(length));
+  }
+
+  std::vector<Time> times;
+  std::vector<Length> altitudes;
+  std::vector<Voltage> voltages;
+  const int numHardwareThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+  std::printf("ingest: %zu rows, %zu bytes, 3 of 4 fields, %d hardware threads\n", kNumRows, csv.size(), numHardwareThreads);
+  for (int numThreads = 1;; numThreads = std::min(2 * numThreads, numHardwareThreads))
+  {
+    units::IngestOptions options;
+    options.m_numThreads = numThreads;
+    bool ok = true;
+    const double nanoseconds = MeasureNanosecondsPerElement(csv.size(), [&]()
+    {
+      const units::IngestResult result = units::ingest_csv(csv, options, units::csv_column(0, kTimeSymbols, times, "ms"), units::csv_column(2, kLengthSymbols, altitudes), units::csv_column(3, kVoltageSymbols, voltages));
+      ok = ok && result && result.m_rows == kNumRows;
+      Consume(voltages[kNumRows - 1].GetRaw());
+    });
+    std::printf("  %2d thread%s %8.1f MB/s%s\n", numThreads, (numThreads == 1) ? " " : "s", 1000.0 / nanoseconds, ok ? "" : "   FAILED");
+
+    if (numThreads == numHardwareThreads)
+      break;
+  }
+}
@@ -0,0 +1,34 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#include "benchmark.h"
+
+static volatile float s_sink;
+
+void Consume(const float value)
+{
+  s_sink = value;
+}
+
+int main()
+{
+  std::printf("BENCHMARK\n\n");
+  RunMathBenchmark();
+  std::printf("\n");
+  RunParseBenchmark();
+  std::printf("\n");
+  RunIngestBenchmark();
+  std::printf("\n");
+  RunReduceBenchmark();
+  std::printf("\n");
+  RunHistogramBenchmark();
+  std::printf("\n");
+
+  std::system("pause");
+  return 0;
+}
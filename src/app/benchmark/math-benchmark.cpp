@@ -0,0 +1,77 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#include "benchmark.h"
+
+#include "units/units.h"
+#include "units/math.h"
+
+
+MAKE_BASIC_UNIT(Length, float, _m);
+MAKE_BASIC_UNIT(Time, float, _s);
+MAKE_DERIVED_UNIT_DIV(Velocity, float, _m_s, Length, Time);
+MAKE_DERIVED_UNIT_MUL(Area, float, _m2, Length, Length);
+
+namespace
+{
+  typedef units::Precision Precision;
+
+  const std::size_t kNumElements = 1 << 16;
+
+  // times one unit function under both policies, and reports the max relative error of the fast one against the exact one
+  template <typename In, typename Out, typename Exact, typename Fast>
+  void Compare(const char *name, const std::vector<In> &in, std::vector<Out> &exactOut, std::vector<Out> &fastOut, const Exact &exact, const Fast &fast)
+  {
+    const double exactTime = MeasureNanosecondsPerElement(in.size(), [&]() { for (std::size_t i = 0; i < in.size(); ++i) exactOut[i] = exact(in[i]); Consume(units::internal::RawValue(exactOut[0])); });
+    const double fastTime = MeasureNanosecondsPerElement(in.size(), [&]() { for (std::size_t i = 0; i < in.size(); ++i) fastOut[i] = fast(in[i]); Consume(units::internal::RawValue(fastOut[0])); });
+
+    double maxError = 0.0;
+    for (std::size_t i = 0; i < in.size(); ++i)
+    {
+      const double reference = units::internal::RawValue(exactOut[i]);
+      const double error = std::abs(units::internal::RawValue(fastOut[i]) - reference) / std::abs(reference);
+      maxError = (error > maxError) ? error : maxError;
+    }
+
+    std::printf("  %-12s exact %6.2f ns   fast %6.2f ns   speed-up %5.2fx   max relative error %.2e\n", name, exactTime, fastTime, exactTime / fastTime, maxError);
+  }
+}
+
+void RunMathBenchmark()
+{
+  std::printf("math: exact vs fast precision policy, %zu float elements\n", kNumElements);
+
+  std::vector<Area> areas(kNumElements);
+  std::vector<Time> times(kNumElements);
+  std::vector<float> exponents(kNumElements);
+  std::vector<float> positives(kNumElements);
+  for (std::size_t i = 0; i < kNumElements; ++i)
+  {
+    const float t = float(i + 1) / float(kNumElements);
+    areas[i] = Area::From(1000.0f * t);
+    times[i] = Time::From(0.001f + 10.0f * t);
+    exponents[i] = 80.0f * (2.0f * t - 1.0f);
+    positives[i] = std::exp(50.0f * (2.0f * t - 1.0f));
+  }
+
+  std::vector<Length> lengths[2] = { std::vector<Length>(kNumElements), std::vector<Length>(kNumElements) };
+  Compare("sqrt", areas, lengths[0], lengths[1], [](const Area a) { return units::sqrt<Precision::kExact>(a); }, [](const Area a) { return units::sqrt<Precision::kFast>(a); });
+
+  std::vector<decltype(units::rsqrt(Area()))> inverseLengths[2] = { std::vector<decltype(units::rsqrt(Area()))>(kNumElements), std::vector<decltype(units::rsqrt(Area()))>(kNumElements) };
+  Compare("rsqrt", areas, inverseLengths[0], inverseLengths[1], [](const Area a) { return units::rsqrt<Precision::kExact>(a); }, [](const Area a) { return units::rsqrt<Precision::kFast>(a); });
+
+  std::vector<decltype(units::reciprocal(Time()))> frequencies[2] = { std::vector<decltype(units::reciprocal(Time()))>(kNumElements), std::vector<decltype(units::reciprocal(Time()))>(kNumElements) };
+  Compare("reciprocal", times, frequencies[0], frequencies[1], [](const Time t) { return units::reciprocal<Precision::kExact>(t); }, [](const Time t) { return units::reciprocal<Precision::kFast>(t); });
+
+  std::vector<Velocity> velocities[2] = { std::vector<Velocity>(kNumElements), std::vector<Velocity>(kNumElements) };
+  Compare("divide", times, velocities[0], velocities[1], [](const Time t) { return units::divide<Precision::kExact>(100_m, t); }, [](const Time t) { return units::divide<Precision::kFast>(100_m, t); });
+
+  std::vector<float> raw[2] = { std::vector<float>(kNumElements), std::vector<float>(kNumElements) };
+  Compare("exp", exponents, raw[0], raw[1], [](const float x) { return units::exp<Precision::kExact>(x); }, [](const float x) { return units::exp<Precision::kFast>(x); });
+  Compare("log", positives, raw[0], raw[1], [](const float x) { return units::log<Precision::kExact>(x); }, [](const float x) { return units::log<Precision::kFast>(x); });
+}
@@ -0,0 +1,69 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#include "benchmark.h"
+
+#include "units/units.h"
+#include "units/parse.h"
+#include "units/registry.h"
+
+
+MAKE_BASIC_UNIT(Length, float, _m);
+MAKE_BASIC_UNIT(Time, float, _s);
+MAKE_DERIVED_UNIT_DIV(Velocity, float, _m_s, Length, Time);
+MAKE_SCALED_UNIT(Kilometers, _km, Length, std::kilo);
+MAKE_SCALED_UNIT(Hours, _h, Time, std::ratio<3600>);
+MAKE_DERIVED_UNIT_DIV(KilometersPerHour, float, _km_h, Kilometers, Hours);
+
+UNITS_REGISTER_SYMBOL(Velocity, "m/s");
+UNITS_REGISTER_SYMBOL(KilometersPerHour, "km/h");
+
+void RunParseBenchmark()
+{
+  constexpr auto kSymbols = units::MakeSymbolSet<Velocity>(units::Symbol<Velocity>("m/s"), units::Symbol<KilometersPerHour>("km/h"));
+
+  // one value per line, alternating symbols, e.g. "12.5 km/h"
+  const std::size_t kNumValues = 1 << 18;
+  std::string column;
+  char line[64];
+  for (std::size_t i = 0; i < kNumValues; ++i)
+  {
+    const int length = std::snprintf(line, sizeof(line), "%.4g %s\n", 0.001 * double(i * 7919 % 1000003), (i % 2) ? "km/h" : "m/s");
+    column.append(line, std::size_t(length));
+  }
+
+  std::vector<Velocity> values(kNumValues);
+  bool ok = true;
+  const double nanoseconds = MeasureNanosecondsPerElement(column.size(), [&]()
+  {
+    const units::ColumnParseResult result = units::parse_column(column, values, kSymbols);
+    ok = ok && result && result.m_count == kNumValues;
+    Consume(values[kNumValues - 1].GetRaw());
+  });
+
+  std::printf("parse: %zu values, %zu bytes, one value per line\n", kNumValues, column.size());
+  std::printf("  parse_column %8.1f MB/s   %6.2f ns per value%s\n", 1000.0 / nanoseconds, nanoseconds * double(column.size()) / double(kNumValues), ok ? "" : "   FAILED");
+
+  // labeled metrics resolved through the runtime registry, e.g. ("speed", "km/h", 12.5)
+  const char *const kLabels[] = { "m", "km", "s", "h", "m/s", "km/h", "m_s", "km_h" };
+  const std::size_t kNumLabels = sizeof(kLabels) / sizeof(kLabels[0]);
+  std::vector<std::string_view> labels(kNumValues);
+  for (std::size_t i = 0; i < kNumValues; ++i)
+    labels[i] = kLabels[i * 7919 % kNumLabels];
+
+  const units::UnitRegistry &registry = units::UnitRegistry::Instance();
+  std::size_t numFound = 0;
+  const double lookupNanoseconds = MeasureNanosecondsPerElement(kNumValues, [&]()
+  {
+    numFound = 0;
+    for (const std::string_view label : labels)
+      numFound += registry.Find(label) ? 1 : 0;
+    Consume(float(numFound));
+  });
+  std::printf("  registry Find                %6.2f ns per label%s\n", lookupNanoseconds, (numFound == kNumValues) ? "" : "   FAILED");
+}
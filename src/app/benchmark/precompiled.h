@@ -0,0 +1,25 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#ifndef BENCHMARK_PRECOMPILED_H
+#define BENCHMARK_PRECOMPILED_H
+
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ratio>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+#endif
@@ -0,0 +1,54 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#include "benchmark.h"
+
+#include "units/units.h"
+#include "units/accumulator.h"
+#include "units/reduce.h"
+
+
+MAKE_BASIC_UNIT(Energy, float, _j);
+
+void RunReduceBenchmark()
+{
+  const std::size_t kNumElements = 1 << 24;
+  std::vector<Energy> energies(kNumElements);
+  double exact = 0.0;
+  for (std::size_t i = 0; i < kNumElements; ++i)
+  {
+    energies[i] = Energy::From(0.001f * float(i % 1000) + 0.1f);
+    exact += double(energies[i].GetRaw());
+  }
+
+  Energy serial = Energy::Zero();
+  const double serialTime = MeasureNanosecondsPerElement(kNumElements, [&]()
+  {
+    serial = Energy::Zero();
+    for (const Energy energy : energies)
+      serial += energy;
+    Consume(serial.GetRaw());
+  });
+  std::printf("reduce: %zu float elements, %u hardware threads\n", kNumElements, std::max(1u, std::thread::hardware_concurrency()));
+  std::printf("  running sum   %6.3f ns   relative error %.2e\n", serialTime, std::abs(double(serial.GetRaw()) - exact) / exact);
+
+  for (const int numThreads : { 1, 0 })
+  {
+    Energy sum = Energy::Zero();
+    const double time = MeasureNanosecondsPerElement(kNumElements, [&]() { sum = units::reduce_sum(energies, numThreads); Consume(sum.GetRaw()); });
+    std::printf("  reduce_sum    %6.3f ns   relative error %.2e   %s\n", time, std::abs(double(sum.GetRaw()) - exact) / exact, numThreads ? "1 thread" : "all threads");
+  }
+
+  Energy compensated = Energy::Zero();
+  const double compensatedTime = MeasureNanosecondsPerElement(kNumElements, [&]() { compensated = units::compensated_sum(energies); Consume(compensated.GetRaw()); });
+  std::printf("  compensated   %6.3f ns   relative error %.2e   1 thread\n", compensatedTime, std::abs(double(compensated.GetRaw()) - exact) / exact);
+
+  std::pair<Energy, Energy> range;
+  const double minmaxTime = MeasureNanosecondsPerElement(kNumElements, [&]() { range = units::reduce_minmax(energies); Consume(range.second.GetRaw()); });
+  std::printf("  reduce_minmax %6.3f ns   all threads\n", minmaxTime);
+}
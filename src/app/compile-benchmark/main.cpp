@@ -0,0 +1,24 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+// compile-time benchmark: the interesting numbers are the per-file compile times in the build output
+// generated/catalog.h & generated/relations.cpp are written by premake5.lua (see GenerateUnitCatalog, --units & --relations)
+
+#include "generated/catalog.h"
+
+float EvaluateRelations();
+
+int main()
+{
+  std::printf("COMPILE-TIME BENCHMARK\n\n");
+  std::printf("%d units, %d relations, each file compiled with per-file timing (MSVC /Bt+ & /d1reportTime, clang -ftime-trace)\n", kNumUnits, kNumRelations);
+  std::printf("  sum of relations %g\n", double(EvaluateRelations()));
+
+  std::system("pause");
+  return 0;
+}
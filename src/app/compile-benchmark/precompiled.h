@@ -0,0 +1,19 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+ */
+/******************************************************************************/
+
+#ifndef COMPILE_BENCHMARK_PRECOMPILED_H
+#define COMPILE_BENCHMARK_PRECOMPILED_H
+
+
+// STL
+// units headers are deliberately left out, so every file pays their full cost
+#include <cstdio>
+#include <cstdlib>
+
+
+#endif
@@ -25,9 +25,15 @@
 #endif
 
 // STL
+#include <cfloat>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <mutex>
+#include <ratio>
 #include <thread>
 #include <vector>
 
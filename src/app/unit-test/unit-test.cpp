@@ -9,6 +9,26 @@
 #include "unit-test.h"
 
 #include "units/units.h"
+#include "units/accumulator.h"
+#include "units/atomic.h"
+#include "units/batch.h"
+#include "units/dynamic.h"
+#include "units/expr.h"
+#include "units/fixed.h"
+#include "units/format.h"
+#include "units/half.h"
+#include "units/histogram.h"
+#include "units/ingest.h"
+#include "units/mapped.h"
+#include "units/math.h"
+#include "units/matrix.h"
+#include "units/pack.h"
+#include "units/parse.h"
+#include "units/reduce.h"
+#include "units/registry.h"
+#include "units/soa.h"
+#include "units/span.h"
+#include "units/vector.h"
 
 
 // Registers the fixture into the 'registry'
@@ -17,11 +37,33 @@ CPPUNIT_TEST_SUITE_REGISTRATION(UnitTest);
 MAKE_BASIC_UNIT(Length, float, _m);                         // meter (m)
 MAKE_BASIC_UNIT(Time, float, _s);                           // second (s)
 MAKE_DERIVED_UNIT_DIV(Velocity, float, _m_s, Length, Time); // meters per second (m/s)
+MAKE_DERIVED_UNIT_DIV(Acceleration, float, _m_ss, Velocity, Time); // meters per second squared (m/s^2)
+MAKE_DERIVED_UNIT_MUL(Area, float, _m2, Length, Length);    // square meter (m^2)
 
 MAKE_BASIC_UNIT(Current, float, _a);                        // ampere (a)
 MAKE_BASIC_UNIT(Voltage, float, _v);                        // volt (v)
 MAKE_DERIVED_UNIT_MUL(Power, float, _w, Current, Voltage);  // watt (w)
 
+MAKE_UNIT_VARIANT(FixedLength, units::Q16_16, _fm, Length);                           // meter (m), Q16.16
+MAKE_UNIT_VARIANT(FixedTime, units::Q16_16, _fs, Time);                               // second (s), Q16.16
+MAKE_DERIVED_UNIT_DIV(FixedVelocity, units::Q16_16, _fm_s, FixedLength, FixedTime);   // meters per second (m/s), Q16.16
+
+MAKE_SCALED_UNIT(Kilometers, _km, Length, std::kilo);                                 // kilometer (km)
+MAKE_SCALED_UNIT(Millimeters, _mm, Length, std::milli);                               // millimeter (mm)
+MAKE_SCALED_UNIT(Milliseconds, _ms, Time, std::milli);                                // millisecond (ms)
+MAKE_SCALED_UNIT(Hours, _h, Time, std::ratio<3600>);                                  // hour (h)
+MAKE_DERIVED_UNIT_DIV(KilometersPerHour, float, _km_h, Kilometers, Hours);            // kilometers per hour (km/h)
+MAKE_UNIT_VARIANT(Seconds64, long long, _s64, Time);                                  // second (s), integer
+MAKE_SCALED_UNIT(Nanoseconds, _ns, Seconds64, std::nano);                             // nanosecond (ns), integer
+MAKE_SCALED_UNIT(Microseconds, _us, Seconds64, std::micro);                           // microsecond (us), integer
+
+MAKE_UNIT_VARIANT(Voltage16, units::Half, _v16, Voltage);                             // volt (v), half precision
+MAKE_UNIT_VARIANT(Current16, units::BFloat16, _a16, Current);                         // ampere (a), bfloat16
+
+UNITS_REGISTER_SYMBOL(Velocity, "m/s");
+UNITS_REGISTER_SYMBOL(KilometersPerHour, "km/h");
+UNITS_REGISTER_SYMBOL(Power, "W");
+
 
 void UnitTest::TestBasicUnits()
 {
@@ -82,3 +124,1325 @@ void UnitTest::TestDerivedUnits()
   CPPUNIT_ASSERT(current == derivedCurrent);
   CPPUNIT_ASSERT(voltage == derivedVoltage);
 }
+
+void UnitTest::TestDimensions()
+{
+  // relationships never declared by hand
+  static_assert(std::is_same<decltype(Acceleration() * Time()), Velocity>::value, "acceleration * time != velocity");
+  static_assert(std::is_same<decltype(Velocity() / Acceleration()), Time>::value, "velocity / acceleration != time");
+  static_assert(std::is_same<decltype(Area() / Length()), Length>::value, "area / length != length");
+  static_assert(std::is_same<decltype(Power() / Current() / Voltage()), float>::value, "power / current / voltage != scalar");
+  static_assert(std::is_same<decltype(Length() / Length()), float>::value, "length / length != scalar");
+  static_assert(!std::is_same<Length, Time>::value, "distinct basic units share a dimension");
+  static_assert(sizeof(Length) == sizeof(float), "unit storage overhead");
+
+  const Acceleration acceleration = 2.0_m_ss;
+  const Time time = 3.0_s;
+  const Velocity velocity = acceleration * time;
+  const Length length = 0.5f * acceleration * time * time;
+  const Area area = length * length;
+  const float ratio = length / 3.0_m;
+  const auto frequency = 1.0f / time;
+
+  CPPUNIT_ASSERT_EQUAL(6.0f, velocity.GetRaw());
+  CPPUNIT_ASSERT_EQUAL(9.0f, length.GetRaw());
+  CPPUNIT_ASSERT_EQUAL(81.0f, area.GetRaw());
+  CPPUNIT_ASSERT_EQUAL(3.0f, ratio);
+  CPPUNIT_ASSERT(velocity == 2.0f * length / time);
+  CPPUNIT_ASSERT(1.0f == (frequency * time));
+}
+
+namespace
+{
+  // folded at compile time; no dynamic initializers
+  constexpr Length kMaxLength = 100.0_m * 2;
+  constexpr Velocity kSpeedTable[] = { 1.0_m / 2.0_s, 3_m / 1_s, 4.0_m_s + 1.0_m_s };
+
+  template <int kMeters> struct LengthTag { static constexpr int kValue = kMeters; };
+}
+
+void UnitTest::TestConstexpr()
+{
+  static_assert(kMaxLength.GetRaw() == 200.0f, "constexpr literal arithmetic");
+  static_assert(kMaxLength == 200_m, "constexpr comparison");
+  static_assert(kSpeedTable[0].GetRaw() == 0.5f && kSpeedTable[1].GetRaw() == 3.0f && kSpeedTable[2].GetRaw() == 5.0f, "constexpr table");
+  static_assert(Length::Zero().GetRaw() == 0.0f, "constexpr zero");
+  static_assert(Length::PosInfinity().To<float>() == FLT_MAX, "constexpr infinity");
+  static_assert(Length::NegInfinity() < -kMaxLength, "constexpr negation");
+  static_assert((2.0_m_ss * 3.0_s).GetRaw() == 6.0f, "constexpr derived multiplication");
+  static_assert(8.0_m / 2.0_m == 4.0f, "constexpr dimensionless division");
+  static_assert(LengthTag<(5_m * 2).To<int>()>::kValue == 10, "constexpr template argument");
+  static_assert(noexcept(1.0_m + 2.0_m) && noexcept(Length::From(1)) && noexcept(1.0_w / 2.0_v), "noexcept surface");
+
+  constexpr Length kAccumulated = []
+  {
+    Length length = 1_m;
+    length += 2_m;
+    length *= 3;
+    length -= 1_m;
+    length /= 2;
+    return length;
+  }();
+  static_assert(kAccumulated.GetRaw() == 4.0f, "constexpr compound assignment");
+
+  CPPUNIT_ASSERT_EQUAL(200.0f, kMaxLength.GetRaw());
+  CPPUNIT_ASSERT_EQUAL(4.0f, kAccumulated.GetRaw());
+}
+
+void UnitTest::TestLayout()
+{
+  static_assert(std::is_trivially_copyable<Velocity>::value, "velocity must be trivially copyable");
+  static_assert(std::is_standard_layout<Velocity>::value, "velocity must be standard layout");
+  static_assert(std::is_trivially_default_constructible<Length>::value, "length must be trivially default constructible");
+  static_assert(sizeof(Power) == sizeof(float) && alignof(Power) == alignof(float), "power must be layout-compatible with float");
+  static_assert(units::IsSpanCastable<Length, float>::value, "float -> length");
+  static_assert(units::IsSpanCastable<const float, const Length>::value, "const length -> const float");
+  static_assert(!units::IsSpanCastable<Length, const float>::value, "span_cast must not cast away const");
+  static_assert(!units::IsSpanCastable<Time, Length>::value, "span_cast must not re-label dimensions");
+  static_assert(!units::IsSpanCastable<Length, double>::value, "span_cast must not change storage");
+
+  std::vector<float> samples = { 1.0f, 2.0f, 3.0f, 4.0f };
+  const std::span<Length> lengths = units::span_cast<Length>(std::span<float>(samples));
+  CPPUNIT_ASSERT_EQUAL(samples.size(), lengths.size());
+  CPPUNIT_ASSERT(static_cast<void *>(lengths.data()) == static_cast<void *>(samples.data()));
+  CPPUNIT_ASSERT(lengths[2] == 3.0_m);
+
+  lengths[0] += 1.0_m;
+  CPPUNIT_ASSERT_EQUAL(2.0f, samples[0]);
+
+  const std::span<const float> raw = units::span_cast<const float>(std::span<const Length>(lengths));
+  CPPUNIT_ASSERT_EQUAL(4.0f, raw[3]);
+
+  std::vector<Length> copy(lengths.begin(), lengths.end());
+  std::vector<Length> moved = std::move(copy);
+  CPPUNIT_ASSERT(moved[1] == 2.0_m);
+}
+
+void UnitTest::TestStructureOfArrays()
+{
+  typedef units::UnitSoA<Length, Velocity, float> Bodies;
+  static_assert(std::is_same<decltype(Bodies().Column<1>()), std::span<Velocity>>::value, "typed column");
+  static_assert(std::is_same<decltype(Bodies().RawColumn<1>()), std::span<float>>::value, "raw column");
+
+  Bodies bodies;
+  for (int i = 0; i < 100; ++i)
+    bodies.PushBack(Length::From(i), Velocity::From(2 * i), 1.0f);
+
+  CPPUNIT_ASSERT_EQUAL(std::size_t(100), bodies.Size());
+  CPPUNIT_ASSERT(bodies.Capacity() >= bodies.Size());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(0), reinterpret_cast<std::uintptr_t>(bodies.RawColumn<0>().data()) % Bodies::kAlignment);
+  CPPUNIT_ASSERT_EQUAL(std::size_t(0), reinterpret_cast<std::uintptr_t>(bodies.RawColumn<1>().data()) % Bodies::kAlignment);
+  CPPUNIT_ASSERT_EQUAL(std::size_t(0), reinterpret_cast<std::uintptr_t>(bodies.RawColumn<2>().data()) % Bodies::kAlignment);
+
+  // stream a single column
+  const Time dt = 0.5_s;
+  const std::span<Length> positions = bodies.Column<0>();
+  const std::span<const Velocity> velocities = bodies.Column<1>();
+  for (std::size_t i = 0; i < bodies.Size(); ++i)
+    positions[i] += velocities[i] * dt;
+
+  CPPUNIT_ASSERT(bodies[10].Get<0>() == 20.0_m);
+  bodies[10].Get<1>() = 1.0_m_s;
+  CPPUNIT_ASSERT(std::get<1>(bodies.Load(10)) == 1.0_m_s);
+  CPPUNIT_ASSERT_EQUAL(1.0f, bodies[99].Get<2>());
+
+  const Bodies copy = bodies;
+  bodies.Resize(200);
+  CPPUNIT_ASSERT(bodies[150].Get<0>() == 0.0_m);
+  CPPUNIT_ASSERT(copy[99].Get<0>() == 198.0_m);
+  CPPUNIT_ASSERT_EQUAL(std::size_t(100), copy.Size());
+
+  Bodies moved = std::move(bodies);
+  CPPUNIT_ASSERT_EQUAL(std::size_t(200), moved.Size());
+  CPPUNIT_ASSERT(bodies.Empty());
+}
+
+void UnitTest::TestBatch()
+{
+  const std::size_t kCount = 1027; // not a multiple of any vector width, to cover the tails
+
+  std::vector<Length> lengths(kCount);
+  std::vector<Time> times(kCount);
+  std::vector<double> raw(kCount);
+  for (std::size_t i = 0; i < kCount; ++i)
+  {
+    lengths[i] = Length::From(i);
+    times[i] = Time::From(1 + i % 4);
+    raw[i] = 0.5 * i;
+  }
+
+  for (int isa = 0; isa <= static_cast<int>(units::GetSupportedInstructionSet()); ++isa)
+  {
+    units::SetInstructionSet(static_cast<units::InstructionSet>(isa));
+
+    std::vector<Length> sums(kCount);
+    std::vector<Length> differences(kCount);
+    std::vector<Velocity> velocities(kCount);
+    std::vector<Area> areas(kCount);
+    std::vector<Length> scaled(kCount);
+    std::vector<Length> positions(lengths);
+    std::vector<Area> fused(kCount);
+    std::vector<double> rawSums(kCount);
+
+    units::add(lengths, lengths, sums);
+    units::subtract(sums, lengths, differences);
+    units::divide(lengths, times, velocities);
+    units::multiply(std::span<const Length>(lengths), std::span<const Length>(lengths), std::span<Area>(areas));
+    units::scale(lengths, 3, scaled);
+    units::fma(velocities, 0.5_s, positions, positions);
+    units::fma(lengths, lengths, areas, fused);
+    units::add(raw, raw, rawSums);
+
+    for (std::size_t i = 0; i < kCount; ++i)
+    {
+      const float l = static_cast<float>(i);
+      const float t = static_cast<float>(1 + i % 4);
+      CPPUNIT_ASSERT_EQUAL(2.0f * l, sums[i].GetRaw());
+      CPPUNIT_ASSERT_EQUAL(l, differences[i].GetRaw());
+      CPPUNIT_ASSERT_EQUAL(l / t, velocities[i].GetRaw());
+      CPPUNIT_ASSERT_EQUAL(l * l, areas[i].GetRaw());
+      CPPUNIT_ASSERT_EQUAL(3.0f * l, scaled[i].GetRaw());
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(l + 0.5f * l / t, positions[i].GetRaw(), 1e-3f * l);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0f * l * l, fused[i].GetRaw(), 1e-6f * l * l);
+      CPPUNIT_ASSERT_EQUAL(1.0 * i, rawSums[i]);
+    }
+
+    // dimensionless results of scaled units carry the scale, like 1_km / 1_m = 1000
+    typedef decltype(1.0f / Length()) PerMeter;
+    std::vector<Kilometers> kilometers(kCount, 2.0_km);
+    std::vector<PerMeter> perMeters(kCount, 0.5f / 1.0_m);
+    std::vector<float> ratios(kCount);
+    std::vector<float> products(kCount);
+    std::vector<float> factors(kCount);
+    std::vector<float> offsets(kCount);
+    units::divide(kilometers, lengths, ratios);
+    units::multiply(kilometers, perMeters, products);
+    units::scale(kilometers, 0.5f / 1.0_m, factors);
+    units::fma(kilometers, perMeters, products, offsets);
+    for (std::size_t i = 1; i < kCount; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(2000.0f / static_cast<float>(i), ratios[i], 1e-3f);
+      CPPUNIT_ASSERT_EQUAL(1000.0f, products[i]);
+      CPPUNIT_ASSERT_EQUAL(1000.0f, factors[i]);
+      CPPUNIT_ASSERT_EQUAL(2000.0f, offsets[i]);
+    }
+  }
+
+  units::SetInstructionSet(units::GetSupportedInstructionSet());
+}
+
+void UnitTest::TestPacks()
+{
+  typedef units::PackOf<Length, 8> Length8;
+  typedef units::PackOf<Time, 8> Time8;
+  typedef units::PackOf<Velocity, 8> Velocity8;
+  UNITS_LAYOUT_CHECK(Length8);
+  static_assert(sizeof(Length8) == 8 * sizeof(float) && alignof(Length8) == 32, "packs fill a whole register");
+  static_assert(std::is_same<decltype(Length8() / Time8()), Velocity8>::value, "packed dimensions");
+  static_assert(std::is_same<units::ScalarOf<Velocity8>, Velocity>::value, "scalar unit of a pack");
+  static_assert(std::is_same<decltype(Length8() < Length8()), units::PackMask<float, 8>>::value, "comparisons return lane masks");
+
+  const Length lengths[8] = { 1_m, 2_m, 3_m, 4_m, 5_m, 6_m, 7_m, 8_m };
+  const Length8 l = units::load<Length8>(lengths);
+  const Time8 t = units::broadcast<Time8>(2.0_s);
+  const Velocity8 v = l / t;
+  const Length8 doubled = 2.0f * l;
+  const Length8 zero = Length8::Zero();
+
+  CPPUNIT_ASSERT(units::get_lane(v, 3) == 2.0_m_s);
+  CPPUNIT_ASSERT(units::get_lane(doubled, 7) == 16_m);
+  CPPUNIT_ASSERT(units::get_lane(Length8::PosInfinity(), 5) == Length::PosInfinity());
+  CPPUNIT_ASSERT(units::horizontal_sum(l) == 36_m);
+  CPPUNIT_ASSERT(units::horizontal_min(l) == 1_m);
+  CPPUNIT_ASSERT(units::horizontal_max(v) == 4.0_m_s);
+  CPPUNIT_ASSERT(units::horizontal_sum(zero) == 0_m);
+  CPPUNIT_ASSERT_EQUAL(8.0f, units::horizontal_sum(l / l)); // dimensionless packs are raw packs
+
+  const units::PackMask<float, 8> mask = l > units::broadcast<Length8>(4.5_m);
+  CPPUNIT_ASSERT(!mask[3] && mask[4]);
+  CPPUNIT_ASSERT(units::any(mask) && !units::all(mask) && units::all(mask | ~mask) && units::none(mask & ~mask));
+
+  const Length8 clamped = units::select(mask, units::broadcast<Length8>(4.5_m), l);
+  Length out[8];
+  units::store(out, clamped);
+  CPPUNIT_ASSERT(out[3] == 4_m);
+  CPPUNIT_ASSERT(out[6] == 4.5_m);
+
+  // double lanes, several registers per pack, and lane loops in constant evaluation
+  typedef units::Pack<double, 4> Double4;
+  typedef units::Pack<float, 32> Float32;
+  static_assert((-Float32(2.0f) * Float32(3.0f))[31] == -6.0f, "constant evaluated packs");
+  const Double4 d = Double4(1.0) / Double4(4.0) - Double4(0.5);
+  CPPUNIT_ASSERT(units::all(d == Double4(-0.25)) && units::none(d != Double4(-0.25)));
+  const Float32 f = units::Select(Float32(1.0f) < Float32(2.0f), -Float32(8.0f), Float32(0.0f));
+  CPPUNIT_ASSERT_EQUAL(-256.0f, units::horizontal_sum(f));
+  CPPUNIT_ASSERT(units::all(~(f > Float32(0.0f))));
+}
+
+void UnitTest::TestExpressions()
+{
+  const std::size_t kCount = 100; // one full cache line step plus a tail
+
+  std::vector<Length> positions(kCount);
+  std::vector<Velocity> velocities(kCount);
+  std::vector<Acceleration> accelerations(kCount);
+  for (std::size_t i = 0; i < kCount; ++i)
+  {
+    positions[i] = Length::From(i);
+    velocities[i] = Velocity::From(2 * i);
+    accelerations[i] = Acceleration::From(4);
+  }
+
+  const Time dt = 0.5_s;
+  const auto p = units::lazy(positions);
+  const auto v = units::lazy(velocities);
+  const auto a = units::lazy(accelerations);
+  static_assert(std::is_same<decltype(v * dt)::Unit, Length>::value, "velocity * time -> length");
+  static_assert(std::is_same<decltype(0.5f * a * dt * dt)::Unit, Length>::value, "acceleration * time^2 -> length");
+  static_assert(std::is_same<decltype(p / v)::Unit, Time>::value, "length / velocity -> time");
+
+  // nothing is evaluated until assignment; aliasing the output element for element is fine
+  units::lazy(positions) = p + v * dt + 0.5f * a * dt * dt;
+  for (std::size_t i = 0; i < kCount; ++i)
+    CPPUNIT_ASSERT_EQUAL(static_cast<float>(i) + static_cast<float>(i) + 0.5f, positions[i].GetRaw());
+
+  std::vector<Time> times(kCount);
+  units::lazy(times) = -(units::lazy(positions) - 0.5_m) / v;
+  CPPUNIT_ASSERT(times[10] == -1.0_s);
+
+  std::vector<float> ratios(kCount);
+  units::lazy(ratios) = units::lazy(times) * v / p;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-20.0f / 20.5f, ratios[10], 1e-6f);
+
+  // scaled operands are converted like their scalar counterparts (1 m + 1 km = 1001 m, 1 km / 1 m = 1000)
+  std::vector<Length> meters(kCount, 1.0_m);
+  std::vector<Kilometers> kilometers(kCount, 1.0_km);
+  static_assert(std::is_same<decltype(units::lazy(meters) + units::lazy(kilometers))::Unit, Length>::value, "sums take the lhs unit");
+  static_assert(std::is_same<decltype(units::lazy(kilometers) / units::lazy(meters))::Unit, float>::value, "dimensionless ratio");
+  units::lazy(positions) = units::lazy(meters) + units::lazy(kilometers);
+  CPPUNIT_ASSERT(positions[0] == 1001.0_m && positions[kCount - 1] == 1001.0_m);
+  units::lazy(positions) = units::lazy(meters) + 1.0_km - units::lazy(meters);
+  CPPUNIT_ASSERT(positions[kCount - 1] == 1000.0_m);
+  units::lazy(kilometers) = units::lazy(kilometers) + 2.0_m;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.002f, kilometers[kCount - 1].GetRaw(), 1e-6f);
+  units::lazy(ratios) = units::lazy(kilometers) / units::lazy(meters);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1002.0f, ratios[0], 1e-3f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1002.0f, ratios[kCount - 1], 1e-3f);
+}
+
+void UnitTest::TestFixedPoint()
+{
+  typedef units::Quantity<units::Q16_16Saturated, Length::kDimension> SaturatedLength;
+  UNITS_LAYOUT_CHECK(SaturatedLength);
+  static_assert(std::is_same<decltype(FixedLength() / FixedTime()), FixedVelocity>::value, "fixed-point derived units");
+  static_assert(std::is_same<decltype(FixedLength() / FixedLength()), units::Q16_16>::value, "dimensionless fixed-point ratio");
+  static_assert(sizeof(FixedLength) == 4 && sizeof(units::Q32_32) == 8, "fixed-point storage is its raw integer");
+
+  // literals & From scale into the fractional bits at compile time
+  constexpr FixedLength kHalf = 0.5_fm;
+  static_assert(kHalf.GetRaw().GetRaw() == 0x8000, "0.5 in Q16.16");
+  static_assert((2_fm).GetRaw().GetRaw() == 0x20000, "2 in Q16.16");
+  static_assert(FixedLength::Zero().GetRaw().GetRaw() == 0, "zero");
+  static_assert(FixedLength::From(-1.25).To<float>() == -1.25f, "round trip");
+  static_assert(FixedLength::PosInfinity().GetRaw().GetRaw() == std::numeric_limits<std::int32_t>::max(), "infinity is the largest raw value");
+
+  // products & quotients keep their fractional bits
+  const FixedVelocity v = 1_fm / 3_fs;
+  CPPUNIT_ASSERT_EQUAL(0x5555, v.GetRaw().GetRaw());
+  CPPUNIT_ASSERT_EQUAL(0xffff, (v * 3_fs).GetRaw().GetRaw());
+  CPPUNIT_ASSERT(kHalf * 3 == 1.5_fm);
+  CPPUNIT_ASSERT(kHalf * 0.5 == 0.25_fm);
+  CPPUNIT_ASSERT(3.0 * kHalf / 2 == 0.75_fm);
+  typedef decltype(1 / FixedTime()) FixedFrequency;
+  CPPUNIT_ASSERT(2.0 / 4_fs == FixedFrequency::From(0.5));
+  CPPUNIT_ASSERT((1.5_fm / kHalf) == units::Q16_16(3));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 / 3.0, v.To<double>(), 1.0 / 65536.0);
+
+  FixedLength l = 1_fm;
+  l *= 2.5;
+  l -= kHalf;
+  CPPUNIT_ASSERT(l == 2_fm);
+  CPPUNIT_ASSERT(-l < kHalf);
+
+  // conversions to & from float units
+  const FixedLength fromFloat = units::unit_cast<FixedLength>(2.25_m); // quantizes, so explicit
+  const Length toFloat = fromFloat;
+  CPPUNIT_ASSERT(fromFloat == 2.25_fm);
+  CPPUNIT_ASSERT(toFloat == 2.25_m);
+
+  // overflow policies
+  const FixedLength wrapped = FixedLength::PosInfinity() + FixedLength::From(units::Q16_16::FromRaw(1));
+  CPPUNIT_ASSERT(wrapped == FixedLength::NegInfinity());
+  const SaturatedLength saturated = SaturatedLength::PosInfinity() + SaturatedLength::From(1.0);
+  CPPUNIT_ASSERT(saturated == SaturatedLength::PosInfinity());
+  CPPUNIT_ASSERT(SaturatedLength::From(30000.0) * 4 == SaturatedLength::PosInfinity());
+  CPPUNIT_ASSERT(-SaturatedLength::NegInfinity() == SaturatedLength::PosInfinity());
+  CPPUNIT_ASSERT(SaturatedLength::From(1e9) == SaturatedLength::PosInfinity());
+  CPPUNIT_ASSERT(kHalf / 0 == FixedLength::PosInfinity());
+  static_assert((units::Q16_16::FromRaw(1) * ((1ll << 32) + 3)).GetRaw() == 3, "integral factors wrap like the product");
+  static_assert(units::Q16_16Saturated::FromRaw(1) * ((1ll << 32) + 3) == std::numeric_limits<units::Q16_16Saturated>::max(), "or saturate");
+
+  // Q32.32 uses a 128-bit intermediate
+  constexpr units::Q32_32 kThird = units::Q32_32(1) / units::Q32_32(3);
+  static_assert(kThird.GetRaw() == 0x55555555, "1/3 in Q32.32");
+  static_assert(units::Q32_32(1.5) * units::Q32_32(-0.25) == units::Q32_32(-0.375), "Q32.32 product");
+  static_assert(units::Q32_32(-6) / units::Q32_32(0.25) == units::Q32_32(-24), "Q32.32 quotient");
+  static_assert(std::numeric_limits<units::Q32_32>::max() + units::Q32_32::FromRaw(1) == std::numeric_limits<units::Q32_32>::lowest(), "Q32.32 wraps");
+  static_assert(units::Q32_32Saturated(100000) * units::Q32_32Saturated(100000) == std::numeric_limits<units::Q32_32Saturated>::max(), "Q32.32 saturates");
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1234.5678, static_cast<double>(units::Q32_32(-1234.5678)), 1e-9);
+  // conversions round in the input's own precision, so results don't depend on long double (2^52 + 1 is odd, a double + 0.5 would round to even)
+  static_assert(units::Q32_32(1048576.0 + 0x1p-32).GetRaw() == (1ll << 52) + 1 && units::Q32_32(-1048576.0 - 0x1p-32).GetRaw() == -(1ll << 52) - 1, "|x| >= 2^20");
+  static_assert(units::Q16_16(2.5f / 65536.0f).GetRaw() == 3 && units::Q16_16(-2.5 / 65536.0).GetRaw() == -3, "half away from zero");
+}
+
+void UnitTest::TestHalfPrecision()
+{
+  static_assert(sizeof(Voltage16) == 2 && sizeof(Current16) == 2, "16-bit storage");
+  static_assert((1.5_v16).GetRaw().GetBits() == 0x3e00, "1.5 in half");
+  static_assert((-2_a16).GetRaw().GetBits() == 0xc000, "-2 in bfloat16");
+  static_assert(Voltage16::Zero().GetRaw().GetBits() == 0, "zero");
+  static_assert(Voltage16::PosInfinity().To<float>() == 65504.0f, "largest finite half");
+
+  // round to nearest even, overflow to infinity, gradual underflow
+  CPPUNIT_ASSERT_EQUAL(2048.0f, static_cast<float>(units::Half(2049.0f)));
+  CPPUNIT_ASSERT_EQUAL(2052.0f, static_cast<float>(units::Half(2051.0f)));
+  CPPUNIT_ASSERT_EQUAL(65504.0f, static_cast<float>(units::Half(65519.0f)));
+  CPPUNIT_ASSERT(units::Half(65520.0f).GetBits() == 0x7c00);
+  CPPUNIT_ASSERT(units::Half(-1e-7f).GetBits() == 0x8002);
+  CPPUNIT_ASSERT(units::Half(1e-9f).GetBits() == 0);
+  CPPUNIT_ASSERT_EQUAL(256.0f, static_cast<float>(units::BFloat16(257.0f)));
+  CPPUNIT_ASSERT_EQUAL(260.0f, static_cast<float>(units::BFloat16(259.0f)));
+  CPPUNIT_ASSERT_EQUAL(258.0f, static_cast<float>(units::BFloat16(257.1f)));
+
+  // every finite half survives the round trip through float
+  for (int bits = 0; bits < 0x10000; ++bits)
+  {
+    const units::Half half = units::Half::FromBits(static_cast<std::uint16_t>(bits));
+    if ((bits & 0x7c00) != 0x7c00)
+      CPPUNIT_ASSERT_EQUAL(bits, int(units::Half(static_cast<float>(half)).GetBits()));
+  }
+
+  // arithmetic is float arithmetic rounded to 16 bits
+  Voltage16 v = 1.5_v16 + 0.25_v16;
+  CPPUNIT_ASSERT(v == 1.75_v16);
+  v *= 2;
+  CPPUNIT_ASSERT(v / 0.5 == 7_v16);
+  CPPUNIT_ASSERT(-v < 0_v16);
+  CPPUNIT_ASSERT(v.To<double>() == 3.5);
+  CPPUNIT_ASSERT(Current16::From(1.0) / Current16::From(3.0) == units::BFloat16(1.0f / 3.0f));
+
+  // batch widening & narrowing match the scalar conversions on every instruction set
+  const std::size_t kCount = 1027;
+  std::vector<Voltage> voltages(kCount);
+  for (std::size_t i = 0; i < kCount; ++i)
+    voltages[i] = Voltage::From(std::ldexp(static_cast<float>(i) + 0.5f, static_cast<int>(i % 48) - 32) * ((i & 1) ? -1.0f : 1.0f));
+  voltages[3] = Voltage::PosInfinity();
+  voltages[5] = Voltage::From(std::numeric_limits<float>::quiet_NaN());
+  voltages[7] = Voltage::From(2049.0f);
+
+  for (int isa = 0; isa <= static_cast<int>(units::GetSupportedInstructionSet()); ++isa)
+  {
+    units::SetInstructionSet(static_cast<units::InstructionSet>(isa));
+
+    std::vector<Voltage16> halves(kCount);
+    std::vector<Current16> bfloats(kCount);
+    std::vector<Voltage> widened(kCount);
+    units::convert(voltages, halves);
+    units::convert(units::span_cast<const float>(std::span<const Voltage>(voltages)), units::raw_span(std::span<Current16>(bfloats)));
+
+    for (std::size_t i = 0; i < kCount; ++i)
+    {
+      const float raw = voltages[i].GetRaw();
+      CPPUNIT_ASSERT_EQUAL(units::Half(raw).GetBits(), halves[i].GetRaw().GetBits());
+      CPPUNIT_ASSERT_EQUAL(units::BFloat16(raw).GetBits(), bfloats[i].GetRaw().GetBits());
+    }
+
+    units::convert(halves, widened);
+    for (std::size_t i = 0; i < kCount; ++i)
+    {
+      const float expected = static_cast<float>(halves[i].GetRaw());
+      CPPUNIT_ASSERT(expected == widened[i].GetRaw() || (expected != expected && widened[i].GetRaw() != widened[i].GetRaw()));
+    }
+  }
+  units::SetInstructionSet(units::GetSupportedInstructionSet());
+}
+
+void UnitTest::TestScaledUnits()
+{
+  static_assert(Kilometers::kDimension.m_scaleNumerator == 1000 && Kilometers::kDimension.m_scaleDenominator == 1, "kilo");
+  static_assert(units::HasSameBaseDimensions(Kilometers::kDimension, Length::kDimension), "scaled units keep their base dimensions");
+  static_assert(!std::is_same<Kilometers, Length>::value, "scaled units are distinct types");
+  static_assert(std::is_same<decltype(1_km * 1_km), units::Scaled<Area, std::mega>>::value, "scales fold through products");
+  static_assert(KilometersPerHour::kDimension.m_scaleNumerator == 5 && KilometersPerHour::kDimension.m_scaleDenominator == 18, "km/h = 5/18 m/s");
+  static_assert(std::is_same<decltype(1_m_s * 1_ms), units::Scaled<Length, std::milli>>::value, "m/s * ms -> mm");
+  static_assert(!std::is_convertible<Kilometers, Time>::value, "no conversion across dimensions");
+
+  // conversions multiply by a factor folded at compile time
+  constexpr Length kLength = 2.5_km;
+  constexpr Kilometers kKilometers = 1500_m;
+  static_assert(kLength == 2500_m, "km -> m");
+  static_assert(kKilometers == 1.5_km, "m -> km");
+  static_assert(Time(2_h) == 7200_s, "h -> s");
+  static_assert(Milliseconds(Hours::From(1)) == 3600000_ms, "h -> ms");
+
+  // integer storage converts implicitly only by whole factors; narrowing & float -> integer conversions truncate toward zero, so they're explicit
+  static_assert(Nanoseconds(Seconds64::From(2)).GetRaw() == 2000000000, "s -> ns");
+  static_assert(Nanoseconds(1500_us).GetRaw() == 1500000, "us -> ns");
+  static_assert(units::unit_cast<Seconds64>(Nanoseconds::From(2999999999ll)).GetRaw() == 2, "ns -> s truncates");
+  static_assert(units::unit_cast<Seconds64>(1.7_s).GetRaw() == 1, "float -> integer truncates");
+  static_assert(std::is_convertible<Seconds64, Nanoseconds>::value && std::is_convertible<Seconds64, Time>::value, "exact conversions are implicit");
+  static_assert(!std::is_convertible<Nanoseconds, Seconds64>::value && !std::is_convertible<Time, Seconds64>::value, "truncating conversions are explicit");
+  static_assert(Nanoseconds::From(1500000000) > Seconds64::From(1) && Nanoseconds::From(1500000000) != Seconds64::From(1), "compared in the finer unit");
+
+  // mixed scales meet in the left operand's unit
+  const Kilometers sum = 1_km + 500_m;
+  CPPUNIT_ASSERT(sum == 1.5_km);
+  const Velocity v = 36_km_h;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0f, v.GetRaw(), 1e-5f);
+  const Length l = 2_m_s * 500_ms;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, l.GetRaw(), 1e-6f);
+  CPPUNIT_ASSERT_EQUAL(3000.0f, 3_km / 1_m); // dimensionless ratios apply their scale
+  static_assert(3_s64 / 2_ns == 1500000000ll && Nanoseconds::From(3000000000ll) / Seconds64::From(2) == 1, "integer ratios scale before truncating");
+  std::vector<Seconds64> seconds(3, 3_s64);
+  std::vector<Nanoseconds> nanoseconds(3, 2_ns);
+  std::vector<long long> ratios(3);
+  units::divide(seconds, nanoseconds, ratios);
+  CPPUNIT_ASSERT_EQUAL(1500000000ll, ratios[2]);
+  units::lazy(ratios) = units::lazy(seconds) / units::lazy(nanoseconds);
+  CPPUNIT_ASSERT_EQUAL(1500000000ll, ratios[2]);
+  const Hours h = 90_km / 60_km_h;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5f, h.GetRaw(), 1e-6f);
+}
+
+void UnitTest::TestVectors()
+{
+  typedef units::Vec3<Length> Position;
+  typedef units::Vec3<Velocity> Velocity3;
+  static_assert(sizeof(Position) == 16 && alignof(Position) == 16, "3D vectors are padded to one 16-byte register");
+  static_assert(sizeof(units::Vec2<Length>) == 8 && sizeof(units::Vec4<Length>) == 16 && alignof(units::Vec4<Length>) == 16, "2D & 4D layouts");
+  static_assert(std::is_trivially_copyable<Position>::value && std::is_standard_layout<Position>::value, "vectors are plain data");
+  static_assert(std::is_same<decltype(units::dot(Position(), Position())), Area>::value, "length . length -> area");
+  static_assert(std::is_same<decltype(units::cross(Position(), Position())), units::Vec3<Area>>::value, "length x length -> area");
+  static_assert(std::is_same<decltype(Velocity3() * 1_s), Position>::value, "velocity * time -> length");
+  static_assert(std::is_same<decltype(Position() / 1_s), Velocity3>::value, "length / time -> velocity");
+  static_assert(std::is_same<decltype(units::normalize(Position())), units::Vec3<float>>::value, "directions are dimensionless");
+
+  constexpr Position kUp(0_m, 1_m, 0_m);
+  constexpr Position kRight(1_m, 0_m, 0_m);
+  static_assert(units::dot(kUp, kUp) == 1_m2 && units::dot(kUp, kRight) == 0_m2, "constexpr dot");
+  static_assert(units::cross(kRight, kUp) == units::Vec3<Area>(0_m2, 0_m2, 1_m2), "constexpr cross");
+  static_assert((kUp + kRight * 2).X() == 2_m && (-kUp).Y() == -1_m, "constexpr arithmetic");
+
+  Position p(3_m, 4_m, 0_m);
+  const Velocity3 v(1_m_s, 2_m_s, 3_m_s);
+  p += v * 0.5_s;
+  CPPUNIT_ASSERT(p == Position(3.5_m, 5_m, 1.5_m));
+  p -= 2.0f * v * 1_s;
+  CPPUNIT_ASSERT(p == Position(1.5_m, 1_m, -4.5_m));
+  p /= 0.5f;
+  CPPUNIT_ASSERT(p.Z() == -9_m);
+  p.Z() = 0_m;
+
+  CPPUNIT_ASSERT(units::length(Position(3_m, 4_m, 0_m)) == 5_m);
+  CPPUNIT_ASSERT(units::length_squared(units::Vec2<Length>(3_m, 4_m)) == 25_m2);
+  const units::Vec3<float> direction = units::normalize(Position(3_m, 0_m, 4_m));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.6f, direction.X(), 1e-6f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.8f, direction.Z(), 1e-6f);
+  const Position scaledDirection = direction * 2_m;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.6f, scaledDirection.Z().GetRaw(), 1e-6f);
+
+  const units::Vec4<Power> power = units::Vec4<Current>(1_a, 2_a, 3_a, 4_a) * 2_v;
+  CPPUNIT_ASSERT(power.W() == 8_w);
+  const units::Vec2<Length> meters = units::Vec2<Kilometers>(1_km, 2.5_km);
+  CPPUNIT_ASSERT(meters == units::Vec2<Length>(1000_m, 2500_m));
+}
+
+void UnitTest::TestMatrices()
+{
+  typedef units::Vec3<Length> Position;
+  typedef units::Vec3<Velocity> Velocity3;
+  typedef units::Mat4<Length> Frame;
+  static_assert(sizeof(units::Mat3<float>) == 48 && alignof(units::Mat3<float>) == 16, "padded columns");
+  static_assert(sizeof(Frame) == 64 && std::is_trivially_copyable<Frame>::value, "4 padded columns");
+  static_assert(std::is_same<decltype(units::Mat3<float>() * Velocity3()), Velocity3>::value, "linear maps preserve units");
+  static_assert(std::is_same<decltype(Frame().TransformPoint(Position())), Position>::value, "points stay in the frame's unit");
+
+  constexpr units::Mat3<float> kScale = units::Mat3<float>::FromColumns(units::Vec3<float>(2, 0, 0), units::Vec3<float>(0, 4, 0), units::Vec3<float>(0, 0, 8));
+  static_assert(kScale * Position(1_m, 1_m, 1_m) == Position(2_m, 4_m, 8_m), "constexpr transform");
+  static_assert(kScale * kScale.Inverse() == units::Mat3<float>::Identity(), "constexpr inverse");
+  static_assert(Frame::Identity()(3, 3) == 1.0f && Frame::Identity()(3, 0) == 0.0f, "implied last row");
+
+  // quarter turn about z, then a translation
+  const float kQuarterTurn = 1.57079632679f;
+  const units::Quaternion<float> q = units::Quaternion<float>::FromAxisAngle(units::Vec3<float>(0, 0, 1), kQuarterTurn);
+  const Frame frame = Frame::FromRotationTranslation(q, Position(10_m, 0_m, 0_m));
+
+  const Position rotated = q.Rotate(Position(1_m, 0_m, 0_m));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0f, rotated.X().GetRaw(), 1e-6f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, rotated.Y().GetRaw(), 1e-6f);
+
+  const Position p = frame.TransformPoint(Position(1_m, 2_m, 3_m));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(8.0f, p.X().GetRaw(), 1e-5f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, p.Y().GetRaw(), 1e-5f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0f, p.Z().GetRaw(), 1e-5f);
+  const Velocity3 v = frame.TransformVector(Velocity3(1_m_s, 0_m_s, 0_m_s)); // no translation for free vectors
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, v.Y().GetRaw(), 1e-6f);
+
+  const Position back = frame.InverseRigid().TransformPoint(p);
+  const Position backGeneral = frame.Inverse().TransformPoint(p);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0f, back.X().GetRaw(), 1e-5f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0f, backGeneral.Y().GetRaw(), 1e-5f);
+
+  const units::Quaternion<float> halfTurn = (q * q).Normalized();
+  const Position twice = (frame * frame).TransformPoint(Position(1_m, 0_m, 0_m));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0f, halfTurn.Rotate(Position(1_m, 0_m, 0_m)).X().GetRaw(), 1e-5f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(9.0f, twice.X().GetRaw(), 1e-5f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0f, twice.Y().GetRaw(), 1e-5f);
+
+  // batch transforms, array-of-structures and structure-of-arrays
+  const std::size_t kCount = 37;
+  std::vector<Position> points(kCount);
+  std::vector<Length> xs(kCount), ys(kCount), zs(kCount);
+  std::vector<Velocity3> velocities(kCount, Velocity3(0_m_s, 2_m_s, 0_m_s));
+  for (std::size_t i = 0; i < kCount; ++i)
+  {
+    points[i] = Position(Length::From(i), 1_m, 2_m);
+    xs[i] = points[i].X();
+    ys[i] = points[i].Y();
+    zs[i] = points[i].Z();
+  }
+
+  std::vector<Position> transformed(kCount);
+  units::transform_points(frame, points, transformed);
+  units::transform_points(frame, xs, ys, zs, xs, ys, zs);
+  units::rotate(q, velocities, velocities);
+  for (std::size_t i = 0; i < kCount; ++i)
+  {
+    const Position expected = frame.TransformPoint(points[i]);
+    CPPUNIT_ASSERT(transformed[i] == expected);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.X().GetRaw(), xs[i].GetRaw(), 1e-5f);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.Y().GetRaw(), ys[i].GetRaw(), 1e-5f);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.Z().GetRaw(), zs[i].GetRaw(), 1e-5f);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.0f, velocities[i].X().GetRaw(), 1e-5f);
+  }
+}
+
+void UnitTest::TestMath()
+{
+  static_assert(std::is_same<decltype(units::sqrt(Area())), Length>::value, "sqrt(m^2) -> m");
+  static_assert(std::is_same<decltype(units::pow<2>(Length())), Area>::value, "m^2");
+  static_assert(std::is_same<decltype(Length() * units::pow<-1>(Time())), Velocity>::value, "m * s^-1 -> m/s");
+  static_assert(std::is_same<decltype(units::pow<0>(Length())), float>::value, "m^0 is dimensionless");
+  static_assert(std::is_same<decltype(units::cbrt(units::pow<3>(Length()))), Length>::value, "cbrt(m^3) -> m");
+  static_assert(std::is_same<decltype(units::sqrt(units::pow<2>(Kilometers()))), Kilometers>::value, "roots keep the scale");
+  static_assert(units::pow<3>(2_m) / 2_m == 4_m2, "constexpr powers");
+  static_assert(units::clamp(5_m, 1_m, 3_m) == 3_m && units::min(1_s, 2_s) == 1_s && units::max(1_s, 2_s) == 2_s, "constexpr min, max & clamp");
+
+  CPPUNIT_ASSERT(units::sqrt(9_m2) == 3_m);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0f, units::cbrt(units::pow<3>(2_m)).GetRaw(), 1e-6f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4e6f, Area(units::pow<2>(2_km)).GetRaw(), 1.0f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5f, units::pow<-1>(2_s).GetRaw(), 1e-6f);
+  CPPUNIT_ASSERT(units::abs(-2_m) == 2_m);
+  CPPUNIT_ASSERT(units::abs(-1.5_fm) == 1.5_fm);
+  CPPUNIT_ASSERT(units::fma(2_m_s, 3_s, 1_m) == 7_m);
+  CPPUNIT_ASSERT(units::fma(2.0f, 3_m, 1_m) == 7_m);
+  CPPUNIT_ASSERT(units::hypot(3_m, 4_m) == 5_m);
+  CPPUNIT_ASSERT(units::lerp(0_m, 10_m, 0.25f) == 2.5_m);
+  CPPUNIT_ASSERT(units::lerp(2_s64, 6_s64, 0.5) == 4_s64);
+  CPPUNIT_ASSERT(units::sqrt(4_fm * 4_fm) == 4_fm);
+
+  // batch forms match the scalar forms element by element
+  const std::size_t kCount = 37;
+  std::vector<Area> areas(kCount);
+  std::vector<Length> lengths(kCount), others(kCount), results(kCount);
+  for (std::size_t i = 0; i < kCount; ++i)
+  {
+    areas[i] = Area::From(i * i);
+    lengths[i] = Length::From(int(i) - 18);
+    others[i] = Length::From(18 - int(i % 5) * 9);
+  }
+
+  units::sqrt(areas, results);
+  for (std::size_t i = 0; i < kCount; ++i)
+    CPPUNIT_ASSERT(results[i] == Length::From(i));
+  units::abs(lengths, results);
+  for (std::size_t i = 0; i < kCount; ++i)
+    CPPUNIT_ASSERT(results[i] == units::abs(lengths[i]));
+  units::min(lengths, others, results);
+  for (std::size_t i = 0; i < kCount; ++i)
+    CPPUNIT_ASSERT(results[i] == units::min(lengths[i], others[i]));
+  units::max(lengths, others, results);
+  for (std::size_t i = 0; i < kCount; ++i)
+    CPPUNIT_ASSERT(results[i] == units::max(lengths[i], others[i]));
+  units::clamp(lengths, -5_m, 5_m, results);
+  for (std::size_t i = 0; i < kCount; ++i)
+    CPPUNIT_ASSERT(results[i] == units::clamp(lengths[i], -5_m, 5_m));
+}
+
+void UnitTest::TestPrecision()
+{
+  typedef units::Precision Precision;
+  static_assert(units::kDefaultPrecision == Precision::kExact, "exact unless UNITS_FAST_MATH is defined");
+  static_assert(std::is_same<decltype(units::divide<Precision::kFast>(Length(), Time())), Velocity>::value, "same type as operator/");
+  static_assert(std::is_same<decltype(units::reciprocal<Precision::kFast>(Time()) * Length()), Velocity>::value, "1 / s");
+  static_assert(std::is_same<decltype(units::rsqrt<Precision::kFast>(Area()) * Length()), float>::value, "1 / m");
+  static_assert(std::is_same<decltype(units::divide<Precision::kFast>(90_km, 1.5_h)), decltype(90_km / 1.5_h)>::value, "scales carry over");
+
+  // the exact policy is the standard library
+  CPPUNIT_ASSERT(units::sqrt<Precision::kExact>(2_m2).GetRaw() == std::sqrt(2.0f));
+  CPPUNIT_ASSERT(units::divide(3_m, 7_s) == 3_m / 7_s);
+  CPPUNIT_ASSERT(units::exp<Precision::kFast>(1.0) == std::exp(1.0)); // fast paths are float only
+
+  // fast paths stay within their documented max relative errors
+  auto relativeError = [](const double value, const double reference) { return std::abs(value - reference) / std::abs(reference); };
+  for (float x = 1e-6f; x < 1e6f; x *= 1.0137f)
+  {
+    const Area area = Area::From(x);
+    CPPUNIT_ASSERT(relativeError(units::sqrt<Precision::kFast>(area).GetRaw(), std::sqrt(double(x))) <= 1.8e-3);
+    CPPUNIT_ASSERT(relativeError((units::rsqrt<Precision::kFast>(area) * 1_m), 1.0 / std::sqrt(double(x))) <= 1.8e-3);
+    CPPUNIT_ASSERT(relativeError(units::reciprocal<Precision::kFast>(x), 1.0 / double(x)) <= 1.03e-2);
+    CPPUNIT_ASSERT(relativeError(units::divide<Precision::kFast>(3_m, Time::From(x)).GetRaw(), 3.0 / double(x)) <= 1.04e-2);
+    CPPUNIT_ASSERT(relativeError(units::log<Precision::kFast>(x), std::log(double(x))) <= 2.3e-7);
+  }
+  for (float x = -87.0f; x < 88.0f; x += 0.0731f)
+    CPPUNIT_ASSERT(relativeError(units::exp<Precision::kFast>(x), std::exp(double(x))) <= 2.6e-7);
+  for (float x = std::numeric_limits<float>::denorm_min(); x < 1e38f; x = std::max(x * 1.37f, std::nextafter(x, 1.0f))) // through FLT_MIN & the subnormals
+  {
+    const Area area = Area::From(x);
+    CPPUNIT_ASSERT(relativeError(units::sqrt<Precision::kFast>(area).GetRaw(), std::sqrt(double(x))) <= 1.8e-3);
+    CPPUNIT_ASSERT(relativeError((units::rsqrt<Precision::kFast>(area) * 1_m), 1.0 / std::sqrt(double(x))) <= 1.8e-3);
+  }
+  CPPUNIT_ASSERT(relativeError((units::rsqrt<Precision::kFast>(Area::From(std::numeric_limits<float>::min())) * 1_m), 1.0 / std::sqrt(double(std::numeric_limits<float>::min()))) <= 1.8e-3);
+
+  // edges
+  CPPUNIT_ASSERT(units::sqrt<Precision::kFast>(0_m2) == 0_m);
+  CPPUNIT_ASSERT(units::exp<Precision::kFast>(-100.0f) == 0.0f);
+  CPPUNIT_ASSERT(units::exp<Precision::kFast>(100.0f) == std::numeric_limits<float>::infinity());
+  CPPUNIT_ASSERT(units::log<Precision::kFast>(0.0f) == -std::numeric_limits<float>::infinity());
+  CPPUNIT_ASSERT(units::log<Precision::kFast>(1.0f) == 0.0f);
+  CPPUNIT_ASSERT(std::abs(units::log<Precision::kFast>(1e-40f) - std::log(1e-40f)) <= 2.3e-7f * 92.1f); // subnormal
+  CPPUNIT_ASSERT(units::log<Precision::kFast>(-1.0f) != units::log<Precision::kFast>(-1.0f));
+}
+
+void UnitTest::TestParsing()
+{
+  typedef units::ParseError ParseError;
+  constexpr auto kLengthSymbols = units::MakeSymbolSet<Length>(units::Symbol<Length>("m"), units::Symbol<Kilometers>("km"));
+  constexpr auto kTimeSymbols = units::MakeSymbolSet<Time>(units::Symbol<Time>("s"), units::Symbol<Milliseconds>("ms"), units::Symbol<Hours>("h"));
+  constexpr auto kVelocitySymbols = units::MakeSymbolSet<Velocity>(units::Symbol<Velocity>("m/s"), units::Symbol<KilometersPerHour>("km/h"));
+  constexpr auto kCurrentSymbols = units::MakeSymbolSet<Current>(units::Symbol<Current>("A"));
+  constexpr auto kNanosecondSymbols = units::MakeSymbolSet<Nanoseconds>(units::Symbol<Nanoseconds>("ns"), units::Symbol<Microseconds>("us"), units::Symbol<Seconds64>("s"));
+  static_assert(kTimeSymbols.Find("ms") == &kTimeSymbols[1] && kTimeSymbols.Find("m") == nullptr, "constexpr perfect hash lookup");
+  static_assert(kTimeSymbols[2].m_numerator == 3600 && kNanosecondSymbols[2].m_numerator == 1000000000, "scales folded at compile time");
+
+  Velocity velocity;
+  Current current;
+  Time time;
+  Length length = 7_m;
+  Nanoseconds nanoseconds;
+  CPPUNIT_ASSERT(units::parse("12.5 km/h", velocity, kVelocitySymbols));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(12.5f / 3.6f, velocity.GetRaw(), 1e-6f);
+  CPPUNIT_ASSERT(units::parse("3.2e-3 A", current, kCurrentSymbols) && current == 3.2e-3_a);
+  CPPUNIT_ASSERT(units::parse("850ms", time, kTimeSymbols) && time == 0.85_s);
+  CPPUNIT_ASSERT(units::parse("  +2 km", length, kLengthSymbols) && length == 2000_m);
+  CPPUNIT_ASSERT(units::parse("-1.5 h", time, kTimeSymbols) && time == -5400_s);
+  CPPUNIT_ASSERT(units::parse("3 s", nanoseconds, kNanosecondSymbols) && nanoseconds.GetRaw() == 3000000000);
+  CPPUNIT_ASSERT(units::parse("2.5 us", nanoseconds, kNanosecondSymbols) && nanoseconds.GetRaw() == 2500);
+
+  // the fast decimal path rounds exactly like std::from_chars
+  const char *kDecimals[] = { "0", "-0.5", "12.5", "3.2e-3", "7E+2", "1e22", "1e-22", "9007199254740992", "123456.789e-5", ".5", "5.", "0.1" };
+  for (const char *text : kDecimals)
+  {
+    double simple = 0.0;
+    double reference = 0.0;
+    const char *end = text + std::strlen(text);
+    CPPUNIT_ASSERT(units::internal::ParseSimpleDecimal(text, end, simple) == end);
+    std::from_chars(text, end, reference);
+    CPPUNIT_ASSERT(simple == reference);
+  }
+  double unused = 0.0;
+  const char kLong[] = "9007199254740993";
+  CPPUNIT_ASSERT(units::internal::ParseSimpleDecimal(kLong, kLong + sizeof(kLong) - 1, unused) == nullptr); // beyond 2^53: from_chars
+
+  // precise errors, pointing at the offending text, with the value left untouched
+  const std::string_view kUnknown = "5 furlongs";
+  const units::ParseResult unknown = units::parse(kUnknown, length, kLengthSymbols);
+  CPPUNIT_ASSERT(unknown.m_error == ParseError::kUnknownUnit && unknown.m_end == kUnknown.data() + 2 && length == 2000_m);
+  CPPUNIT_ASSERT(units::parse("m", length, kLengthSymbols).m_error == ParseError::kInvalidNumber);
+  CPPUNIT_ASSERT(units::parse("5 ", length, kLengthSymbols).m_error == ParseError::kMissingUnit);
+  CPPUNIT_ASSERT(units::parse("1e400 m", length, kLengthSymbols).m_error == ParseError::kOutOfRange);
+  CPPUNIT_ASSERT(units::parse("1e36 km", length, kLengthSymbols).m_error == ParseError::kOutOfRange);
+  CPPUNIT_ASSERT(units::parse("1.5 ns", nanoseconds, kNanosecondSymbols).m_error == ParseError::kInexact);
+  CPPUNIT_ASSERT(units::parse("9223372036854775807 s", nanoseconds, kNanosecondSymbols).m_error == ParseError::kOutOfRange);
+  CPPUNIT_ASSERT(length == 2000_m && nanoseconds.GetRaw() == 2500);
+
+  // unsigned storage takes its full range, from whole numbers as well as fractions & exponents
+  typedef units::Quantity<unsigned long long, Nanoseconds::kDimension> UnsignedNanoseconds;
+  typedef units::Quantity<unsigned, Seconds64::kDimension> UnsignedSeconds;
+  constexpr auto kUnsignedNanosecondSymbols = units::MakeSymbolSet<UnsignedNanoseconds>(units::Symbol<UnsignedNanoseconds>("ns"), units::Symbol<Seconds64>("s"));
+  constexpr auto kUnsignedSecondSymbols = units::MakeSymbolSet<UnsignedSeconds>(units::Symbol<UnsignedSeconds>("s"));
+  UnsignedNanoseconds unsignedNanoseconds;
+  UnsignedSeconds unsignedSeconds;
+  CPPUNIT_ASSERT(units::parse("5 ns", unsignedNanoseconds, kUnsignedNanosecondSymbols) && unsignedNanoseconds.GetRaw() == 5);
+  CPPUNIT_ASSERT(units::parse("5.0 ns", unsignedNanoseconds, kUnsignedNanosecondSymbols) && unsignedNanoseconds.GetRaw() == 5);
+  CPPUNIT_ASSERT(units::parse("1e10 s", unsignedNanoseconds, kUnsignedNanosecondSymbols) && unsignedNanoseconds.GetRaw() == 10000000000000000000ull);
+  CPPUNIT_ASSERT(units::parse("18446744073709551615 ns", unsignedNanoseconds, kUnsignedNanosecondSymbols) && unsignedNanoseconds.GetRaw() == 18446744073709551615ull);
+  CPPUNIT_ASSERT(units::parse("18446744074 s", unsignedNanoseconds, kUnsignedNanosecondSymbols).m_error == ParseError::kOutOfRange);
+  CPPUNIT_ASSERT(units::parse("2e19 ns", unsignedNanoseconds, kUnsignedNanosecondSymbols).m_error == ParseError::kOutOfRange);
+  CPPUNIT_ASSERT(units::parse("-5 ns", unsignedNanoseconds, kUnsignedNanosecondSymbols).m_error == ParseError::kOutOfRange);
+  CPPUNIT_ASSERT(units::parse("4294967295 s", unsignedSeconds, kUnsignedSecondSymbols) && unsignedSeconds.GetRaw() == 4294967295u);
+  CPPUNIT_ASSERT(units::parse("2.5e1 s", unsignedSeconds, kUnsignedSecondSymbols) && unsignedSeconds.GetRaw() == 25);
+  CPPUNIT_ASSERT(units::parse("4294967296 s", unsignedSeconds, kUnsignedSecondSymbols).m_error == ParseError::kOutOfRange);
+  CPPUNIT_ASSERT(units::parse("-0.5e1 s", unsignedSeconds, kUnsignedSecondSymbols).m_error == ParseError::kOutOfRange);
+
+  // columns, in one pass
+  std::vector<Length> lengths(8);
+  const units::ColumnParseResult lines = units::parse_column("1 m\n2 km\r\n 3.5m \n", lengths, kLengthSymbols);
+  CPPUNIT_ASSERT(lines && lines.m_count == 3);
+  CPPUNIT_ASSERT(lengths[0] == 1_m && lengths[1] == 2000_m && lengths[2] == 3.5_m);
+  const units::ColumnParseResult fields = units::parse_column("4m,5 km,6", lengths, kLengthSymbols, ',');
+  CPPUNIT_ASSERT(fields.m_error == ParseError::kMissingUnit && fields.m_count == 2 && lengths[1] == 5000_m);
+  const units::ColumnParseResult trailing = units::parse_column("4 m x\n", lengths, kLengthSymbols);
+  CPPUNIT_ASSERT(trailing.m_error == ParseError::kTrailingCharacters && trailing.m_count == 1);
+  std::vector<Length> two(2);
+  const std::string_view kThree = "1 m\n2 m\n3 m";
+  const units::ColumnParseResult full = units::parse_column(kThree, two, kLengthSymbols);
+  CPPUNIT_ASSERT(full && full.m_count == 2 && full.m_end == kThree.data() + 8); // resumable where it stopped
+}
+
+void UnitTest::TestFormatting()
+{
+  constexpr auto kLengthSymbols = units::MakeSymbolSet<Length>(units::Symbol<Length>("m"), units::Symbol<Kilometers>("km"), units::Symbol<Millimeters>("mm"));
+  constexpr auto kKilometerSymbols = units::MakeSymbolSet<Kilometers>(units::Symbol<Length>("m"), units::Symbol<Kilometers>("km"));
+  constexpr auto kNanosecondSymbols = units::MakeSymbolSet<Nanoseconds>(units::Symbol<Nanoseconds>("ns"), units::Symbol<Microseconds>("us"), units::Symbol<Seconds64>("s"));
+  constexpr auto kFixedSymbols = units::MakeSymbolSet<FixedLength>(units::Symbol<FixedLength>("m"));
+  typedef units::Scaling Scaling;
+
+  char buffer[64];
+  const auto text = [&](const auto value, const auto &symbols, const Scaling scaling)
+  {
+    const std::to_chars_result result = units::to_chars(buffer, buffer + sizeof(buffer), value, symbols, scaling);
+    CPPUNIT_ASSERT(result.ec == std::errc());
+    return std::string(buffer, result.ptr);
+  };
+
+  // shortest round trip, in the value's own unit
+  CPPUNIT_ASSERT(text(1.5_m, kLengthSymbols, Scaling::kNone) == "1.5 m");
+  CPPUNIT_ASSERT(text(0.1_m, kLengthSymbols, Scaling::kNone) == "0.1 m");
+  CPPUNIT_ASSERT(text(2500_m, kLengthSymbols, Scaling::kNone) == "2500 m");
+  CPPUNIT_ASSERT(text(Kilometers(2500_m), kKilometerSymbols, Scaling::kNone) == "2.5 km");
+  CPPUNIT_ASSERT(text(Nanoseconds::From(2500), kNanosecondSymbols, Scaling::kNone) == "2500 ns");
+  CPPUNIT_ASSERT(text(FixedLength(1.25_fm), kFixedSymbols, Scaling::kNone) == "1.25 m");
+
+  // picked scales
+  CPPUNIT_ASSERT(text(2500_m, kLengthSymbols, Scaling::kAuto) == "2.5 km");
+  CPPUNIT_ASSERT(text(0.25_m, kLengthSymbols, Scaling::kAuto) == "250 mm");
+  CPPUNIT_ASSERT(text(-12_m, kLengthSymbols, Scaling::kAuto) == "-12 m");
+  CPPUNIT_ASSERT(text(0_m, kLengthSymbols, Scaling::kAuto) == "0 m");
+  CPPUNIT_ASSERT(text(Nanoseconds::From(3000000000), kNanosecondSymbols, Scaling::kAuto) == "3 s");
+  CPPUNIT_ASSERT(text(Nanoseconds::From(2000), kNanosecondSymbols, Scaling::kAuto) == "2 us");
+  CPPUNIT_ASSERT(text(Nanoseconds::From(2500), kNanosecondSymbols, Scaling::kAuto) == "2500 ns"); // integers stay whole
+
+  // reads back to the same value
+  const float kValues[] = { 0.1f, 1.0f / 3.0f, 123456.789f, -7.25e-5f, 3.0e30f };
+  for (const float value : kValues)
+  {
+    Length parsed;
+    CPPUNIT_ASSERT(units::parse(text(Length::From(value), kLengthSymbols, Scaling::kNone), parsed, kLengthSymbols));
+    CPPUNIT_ASSERT(parsed.GetRaw() == value);
+  }
+
+  // never past the end of the buffer
+  char small[4];
+  CPPUNIT_ASSERT(units::to_chars(small, small + sizeof(small), 1.5_m, kLengthSymbols).ec == std::errc::value_too_large);
+  CPPUNIT_ASSERT(units::to_chars(small, small + sizeof(small), 12_m, kLengthSymbols).ec == std::errc()); // "12 m" fits exactly
+
+#if defined(__cpp_lib_format)
+  CPPUNIT_ASSERT(std::format("{}", units::formatted(2500_m, kLengthSymbols, Scaling::kAuto)) == "2.5 km");
+  CPPUNIT_ASSERT(std::format("{:.2f}", units::formatted(1.5_m, kLengthSymbols)) == "1.50 m");
+  CPPUNIT_ASSERT(std::format("{:>6}", units::formatted(Nanoseconds::From(2500), kNanosecondSymbols)) == "  2500 ns");
+#endif
+}
+
+void UnitTest::TestColumnFiles()
+{
+  typedef units::ColumnFileError ColumnFileError;
+  const char *kPath = "unit-test-columns.units";
+
+  std::vector<Length> lengths;
+  std::vector<Nanoseconds> times;
+  for (int i = 0; i < 1000; ++i)
+  {
+    lengths.push_back(Length::From(0.5f * i));
+    times.push_back(Nanoseconds::From(1000000000ll * i + 7));
+  }
+  const Voltage16 kVoltages[] = { 1.5_v16, -3_v16 };
+
+  units::ColumnFileWriter writer;
+  CPPUNIT_ASSERT(writer.AddColumn("length", lengths) == ColumnFileError::kNone);
+  CPPUNIT_ASSERT(writer.AddColumn("time", times) == ColumnFileError::kNone);
+  CPPUNIT_ASSERT(writer.AddColumn("voltage", kVoltages) == ColumnFileError::kNone);
+  CPPUNIT_ASSERT(writer.AddColumn("length", lengths) == ColumnFileError::kInvalidName);
+  CPPUNIT_ASSERT(writer.AddColumn("", lengths) == ColumnFileError::kInvalidName);
+  CPPUNIT_ASSERT(writer.Write(kPath) == ColumnFileError::kNone);
+
+  {
+    units::ColumnFile file;
+    CPPUNIT_ASSERT(file.Open(kPath) == ColumnFileError::kNone);
+    CPPUNIT_ASSERT(file.GetNumColumns() == 3 && file.Find("time") == 1 && file.Find("mass") == -1);
+
+    // zero-copy, aligned views
+    std::span<const Length> mappedLengths;
+    std::span<const Nanoseconds> mappedTimes;
+    std::span<const Voltage16> mappedVoltages;
+    CPPUNIT_ASSERT(file.GetColumn("length", mappedLengths) == ColumnFileError::kNone);
+    CPPUNIT_ASSERT(file.GetColumn("time", mappedTimes) == ColumnFileError::kNone);
+    CPPUNIT_ASSERT(file.GetColumn("voltage", mappedVoltages) == ColumnFileError::kNone);
+    CPPUNIT_ASSERT(std::equal(mappedLengths.begin(), mappedLengths.end(), lengths.begin(), lengths.end()));
+    CPPUNIT_ASSERT(std::equal(mappedTimes.begin(), mappedTimes.end(), times.begin(), times.end()));
+    CPPUNIT_ASSERT(mappedVoltages.size() == 2 && mappedVoltages[0] == 1.5_v16 && mappedVoltages[1] == -3_v16);
+    CPPUNIT_ASSERT(reinterpret_cast<std::uintptr_t>(mappedTimes.data()) % 64 == 0);
+
+    // the header check rejects any other unit type
+    std::span<const Time> wrongDimension;
+    std::span<const Kilometers> wrongScale;
+    std::span<const Seconds64> wrongScaleOfTime;
+    std::span<const Voltage> wrongStorage;
+    CPPUNIT_ASSERT(file.GetColumn("length", wrongDimension) == ColumnFileError::kDimensionMismatch);
+    CPPUNIT_ASSERT(file.GetColumn("length", wrongScale) == ColumnFileError::kScaleMismatch);
+    CPPUNIT_ASSERT(file.GetColumn("time", wrongScaleOfTime) == ColumnFileError::kScaleMismatch);
+    CPPUNIT_ASSERT(file.GetColumn("voltage", wrongStorage) == ColumnFileError::kStorageMismatch);
+    CPPUNIT_ASSERT(file.GetColumn("mass", mappedLengths) == ColumnFileError::kColumnNotFound && mappedLengths.size() == 1000);
+  }
+
+  // truncated or foreign files are rejected before any column is viewed
+  std::ifstream in(kPath, std::ios::binary);
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  std::ofstream(kPath, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 1));
+
+  units::ColumnFile file;
+  CPPUNIT_ASSERT(file.Open(kPath) == ColumnFileError::kCorrupt && file.GetNumColumns() == 0);
+  std::ofstream(kPath, std::ios::binary) << "x,y\n1,2\n";
+  CPPUNIT_ASSERT(file.Open(kPath) == ColumnFileError::kNotAColumnFile);
+  CPPUNIT_ASSERT(file.Open("missing.units") == ColumnFileError::kOpenFailed);
+  std::remove(kPath);
+}
+
+void UnitTest::TestIngest()
+{
+  typedef units::IngestError IngestError;
+  constexpr auto kTimeSymbols = units::MakeSymbolSet<Time>(units::Symbol<Time>("s"), units::Symbol<Milliseconds>("ms"));
+  constexpr auto kLengthSymbols = units::MakeSymbolSet<Length>(units::Symbol<Length>("m"), units::Symbol<Kilometers>("km"));
+  constexpr auto kCurrentSymbols = units::MakeSymbolSet<Current>(units::Symbol<Current>("A"));
+
+  // time in bare milliseconds, an ignored field, altitude with symbols, current
+  std::string csv = "time_ms,sensor,altitude,current\n";
+  const int kNumRows = 1000;
+  char line[128];
+  for (int i = 0; i < kNumRows; ++i)
+  {
+    const int length = std::snprintf(line, sizeof(line), "%d,probe-%d, %d.5 %s ,%d A%s", 250 * i, i % 7, i, (i % 3) ? "m" : "km", -i, (i % 2) ? "\r\n" : "\n");
+    csv.append(line, std::size_t(length));
+    if (i % 100 == 0)
+      csv += "\n"; // blank lines are skipped
+  }
+
+  units::IngestOptions options;
+  options.m_numThreads = 4;
+  options.m_minChunkBytes = 256; // many chunks, boundaries all over the place
+
+  std::vector<Time> times;
+  std::vector<Length> altitudes;
+  std::vector<Current> currents;
+  const units::IngestResult result = units::ingest_csv(csv, options, units::csv_column(0, kTimeSymbols, times, "ms"), units::csv_column(2, kLengthSymbols, altitudes), units::csv_column(3, kCurrentSymbols, currents));
+  CPPUNIT_ASSERT(result && result.m_rows == std::size_t(kNumRows));
+  CPPUNIT_ASSERT(times.size() == std::size_t(kNumRows) && altitudes.size() == std::size_t(kNumRows) && currents.size() == std::size_t(kNumRows));
+  bool inOrder = true;
+  for (int i = 0; i < kNumRows; ++i)
+  {
+    const float altitude = (float(i) + 0.5f) * ((i % 3) ? 1.0f : 1000.0f);
+    inOrder = inOrder && times[i] == Time::From(0.25f * float(i)) && altitudes[i] == Length::From(altitude) && currents[i] == Current::From(-float(i));
+  }
+  CPPUNIT_ASSERT(inOrder);
+
+  // single-threaded ingest gives the same columns
+  std::vector<Length> serial;
+  options.m_numThreads = 1;
+  CPPUNIT_ASSERT(units::ingest_csv(csv, options, units::csv_column(2, kLengthSymbols, serial)) && serial == altitudes);
+
+  // the first error by line wins, whichever chunk finds it; rows before it are kept
+  options.m_numThreads = 4;
+  const std::string kBad = "t,x\n1 s,2 m\n2 s,3 m\n3 s,4 furlongs\n4 s\n5 s,x\n";
+  const units::IngestResult unknown = units::ingest_csv(kBad, options, units::csv_column(0, kTimeSymbols, times), units::csv_column(1, kLengthSymbols, altitudes));
+  CPPUNIT_ASSERT(unknown.m_error == IngestError::kParseFailed && unknown.m_parseError == units::ParseError::kUnknownUnit);
+  CPPUNIT_ASSERT(unknown.m_line == 4 && unknown.m_field == 1 && unknown.m_rows == 2 && times.size() == 2 && altitudes[1] == 3_m);
+  const units::IngestResult missing = units::ingest_csv("1 s\n", units::IngestOptions{ ',', false }, units::csv_column(0, kTimeSymbols, times), units::csv_column(1, kLengthSymbols, altitudes));
+  CPPUNIT_ASSERT(missing.m_error == IngestError::kMissingField && missing.m_line == 1 && missing.m_field == 1 && missing.m_rows == 0);
+  const units::IngestResult bare = units::ingest_csv("5\n", units::IngestOptions{ ',', false }, units::csv_column(0, kTimeSymbols, times));
+  CPPUNIT_ASSERT(bare.m_parseError == units::ParseError::kMissingUnit); // no bare unit declared
+
+  // straight from a mapped file
+  const char *kPath = "unit-test-ingest.csv";
+  std::ofstream(kPath, std::ios::binary) << csv;
+  std::vector<Length> mapped;
+  CPPUNIT_ASSERT(units::ingest_csv_file(kPath, options, units::csv_column(2, kLengthSymbols, mapped)) && mapped == serial);
+  std::remove(kPath);
+  CPPUNIT_ASSERT(units::ingest_csv_file("missing.csv", options, units::csv_column(2, kLengthSymbols, mapped)).m_error == IngestError::kOpenFailed);
+}
+
+void UnitTest::TestAtomic()
+{
+  static_assert(units::atomic<Length>::is_always_lock_free && units::atomic<Nanoseconds>::is_always_lock_free, "lock-free wherever the storage is");
+
+  units::atomic<Length> distance(1_m);
+  CPPUNIT_ASSERT(distance.load() == 1_m);
+  distance.store(2_m);
+  CPPUNIT_ASSERT(distance.exchange(3_m) == 2_m && distance == 3_m);
+
+  Length expected = 2_m;
+  CPPUNIT_ASSERT(!distance.compare_exchange_strong(expected, 4_m) && expected == 3_m); // updated to the current value
+  CPPUNIT_ASSERT(distance.compare_exchange_strong(expected, 4_m) && distance.load() == 4_m);
+  CPPUNIT_ASSERT(distance.fetch_add(1.5_m) == 4_m && distance.fetch_sub(0.5_m) == 5.5_m && distance.load() == 5_m);
+  CPPUNIT_ASSERT((distance += 1_m) == 6_m && (distance -= 2_m) == 4_m);
+  CPPUNIT_ASSERT(distance.fetch_max(3_m) == 4_m && distance.load() == 4_m);
+  CPPUNIT_ASSERT(distance.fetch_max(7_m) == 4_m && distance.load() == 7_m);
+  CPPUNIT_ASSERT(distance.fetch_min(-1_m) == 7_m && distance.load() == -1_m);
+  CPPUNIT_ASSERT(distance.fetch_min(Length::From(NAN)) == -1_m && distance.load() == -1_m);
+
+  // shared between threads, no lost updates
+  const int kNumThreads = 4;
+  const int kNumAdds = 10000;
+  units::atomic<Nanoseconds> total;
+  units::atomic<Length> totalDistance;
+  units::atomic<Length> highest(Length::NegInfinity());
+  units::atomic<Length> lowest(Length::PosInfinity());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (int i = 0; i < kNumAdds; ++i)
+      {
+        total.fetch_add(Nanoseconds::From(3), std::memory_order_relaxed);
+        totalDistance.fetch_add(1_m, std::memory_order_relaxed); // exact in float up to 2^24
+        highest.fetch_max(Length::From(float(t * kNumAdds + i)), std::memory_order_relaxed);
+        lowest.fetch_min(Length::From(float(t * kNumAdds + i)), std::memory_order_relaxed);
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  CPPUNIT_ASSERT(total.load().GetRaw() == 3ll * kNumThreads * kNumAdds);
+  CPPUNIT_ASSERT(totalDistance.load() == Length::From(float(kNumThreads * kNumAdds)));
+  CPPUNIT_ASSERT(highest.load() == Length::From(float(kNumThreads * kNumAdds - 1)) && lowest.load() == 0_m);
+}
+
+void UnitTest::TestReductions()
+{
+  // awkward size: many blocks and a ragged tail
+  const std::size_t kNumValues = 1000003;
+  std::vector<Length> lengths(kNumValues);
+  std::vector<Nanoseconds> durations(kNumValues);
+  unsigned state = 12345;
+  for (std::size_t i = 0; i < kNumValues; ++i)
+  {
+    state = state * 1664525u + 1013904223u;
+    lengths[i] = Length::From(float(state >> 8) * (1.0f / 16777216.0f) - 0.25f);
+    durations[i] = Nanoseconds::From(static_cast<long long>(state % 1000));
+  }
+  lengths[777] = Length::From(NAN); // skipped by min & max
+
+  // bit-identical for any thread count
+  std::vector<Length> clean(lengths);
+  clean[777] = 0_m;
+  double reference = 0.0;
+  for (const Length length : clean)
+    reference += double(length.GetRaw());
+  const Length sum = units::reduce_sum(clean, 1);
+  for (const int numThreads : { 2, 3, 7, 0 })
+    CPPUNIT_ASSERT(std::bit_cast<std::uint32_t>(units::reduce_sum(clean, numThreads).GetRaw()) == std::bit_cast<std::uint32_t>(sum.GetRaw()));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(reference, double(sum.GetRaw()), 1e-2); // pairwise: far closer than a running float sum
+
+  // results keep the unit of the elements
+  long long exact = 0;
+  for (const Nanoseconds duration : durations)
+    exact += duration.GetRaw();
+  static_assert(std::is_same<decltype(units::mean(lengths)), Length>::value && std::is_same<decltype(units::reduce_sum(durations)), Nanoseconds>::value, "reduction units");
+  CPPUNIT_ASSERT(units::reduce_sum(durations, 3).GetRaw() == exact);
+  CPPUNIT_ASSERT(units::mean(durations).GetRaw() == exact / static_cast<long long>(kNumValues));
+  CPPUNIT_ASSERT(units::mean(clean) == Length::From(double(sum.GetRaw()) / double(kNumValues)));
+
+  // 32-bit storage accumulates in 64 bits, so partial sums far beyond INT_MAX are fine as long as the result fits
+  typedef units::Quantity<int, Seconds64::kDimension> Seconds32;
+  std::vector<Seconds32> counts(kNumValues, Seconds32::From(100000));
+  CPPUNIT_ASSERT(units::mean(counts, 3) == Seconds32::From(100000));
+  for (std::size_t i = kNumValues / 2; i < kNumValues - 1; ++i)
+    counts[i] = Seconds32::From(-100000);
+  CPPUNIT_ASSERT(units::reduce_sum(counts, 2) == Seconds32::From(100000)); // one more positive value than negative ones
+
+  float low = INFINITY;
+  float high = -INFINITY;
+  for (const Length length : clean)
+  {
+    low = std::min(low, length.GetRaw());
+    high = std::max(high, length.GetRaw());
+  }
+  const auto range = units::reduce_minmax(lengths, 5);
+  CPPUNIT_ASSERT(units::reduce_min(lengths, 2) == Length::From(low) && units::reduce_max(lengths, 3) == Length::From(high));
+  CPPUNIT_ASSERT(range.first == Length::From(low) && range.second == Length::From(high));
+
+  // empty ranges and infinities
+  const std::vector<Length> kEmpty;
+  const Length kInfinite[] = { 1_m, Length::From(INFINITY) };
+  CPPUNIT_ASSERT(units::reduce_sum(kEmpty) == 0_m && units::mean(kEmpty) == 0_m);
+  CPPUNIT_ASSERT(units::reduce_min(kEmpty) == Length::From(INFINITY) && units::reduce_max(kEmpty) == Length::From(-INFINITY));
+  CPPUNIT_ASSERT(units::reduce_max(kInfinite) == Length::From(INFINITY) && units::reduce_min(kInfinite) == 1_m);
+}
+
+void UnitTest::TestAccumulators()
+{
+  static_assert(sizeof(units::NeumaierAccumulator<Length>) == 2 * sizeof(float), "float-sized state");
+
+  // a million small steps: a plain float total drifts, compensated ones stay within float rounding of the exact total
+  const int kNumSteps = 1000000;
+  const Length kStep = 0.001_m;
+  Length naive = 0_m;
+  units::KahanAccumulator<Length> kahan;
+  units::NeumaierAccumulator<Length> neumaier;
+  double exact = 0.0;
+  for (int i = 0; i < kNumSteps; ++i)
+  {
+    naive += kStep;
+    kahan += kStep;
+    neumaier += kStep;
+    exact += double(kStep.GetRaw());
+  }
+  CPPUNIT_ASSERT(std::abs(double(naive.GetRaw()) - exact) > 1e-3 * exact);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exact, double(kahan.GetSum().GetRaw()), 1e-6 * exact);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exact, double(neumaier.GetSum().GetRaw()), 1e-6 * exact);
+
+  // increments larger than the total: only Neumaier keeps the small terms
+  units::KahanAccumulator<Length> cancelingKahan;
+  units::NeumaierAccumulator<Length> canceling;
+  for (const Length value : { 1_m, 1e8_m, 1_m, -1e8_m })
+  {
+    cancelingKahan += value;
+    canceling += value;
+  }
+  CPPUNIT_ASSERT(canceling.GetSum() == 2_m && cancelingKahan.GetSum() != 2_m);
+  units::NeumaierAccumulator<Length> merged(3_m);
+  merged += canceling;
+  merged -= 1_m;
+  CPPUNIT_ASSERT(merged.GetSum() == 4_m);
+
+  // per-entity totals, updated in batches
+  std::vector<units::NeumaierAccumulator<Length>> odometers(5);
+  std::vector<Length> steps = { 0.001_m, 0.01_m, 0.1_m, -0.001_m, 1_m };
+  for (int frame = 0; frame < 100000; ++frame)
+    units::accumulate(odometers, steps);
+  for (std::size_t i = 0; i < steps.size(); ++i)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(100000.0 * double(steps[i].GetRaw()), double(odometers[i].GetSum().GetRaw()), 1e-6 * 100000.0 * std::abs(double(steps[i].GetRaw())));
+
+  // whole ranges
+  std::vector<Length> values(kNumSteps + 3, kStep);
+  values[17] = 1e5_m; // big terms that cancel in the end
+  values[18] = -1e5_m;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exact + double(kStep.GetRaw()), double(units::compensated_sum(values).GetRaw()), 1e-6 * exact);
+}
+
+void UnitTest::TestHistograms()
+{
+  // 1 ms to 10 s, evenly spread: the p-th percentile is p * 10 s
+  units::Histogram<Time> latencies(1_ms, 60_s);
+  for (int i = 1; i <= 10000; ++i)
+    latencies.Record(Time::From(0.001f * float(i)));
+  CPPUNIT_ASSERT(latencies.GetCount() == 10000 && latencies.GetMin() == 0.001_s && latencies.GetMax() == 10_s);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0005, double(latencies.GetMean().GetRaw()), 1e-3);
+  const double kFractions[] = { 0.01, 0.5, 0.9, 0.99, 0.999 };
+  for (const double fraction : kFractions)
+  {
+    const double expected = 10.0 * fraction;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, double(latencies.GetPercentile(fraction).GetRaw()), 0.004 * expected);
+  }
+  CPPUNIT_ASSERT(latencies.GetPercentile(0.0) == 0.001_s && latencies.GetPercentile(1.0) == 10_s); // clamped to the exact min & max
+
+  // out-of-range values count at the ends; merges add up
+  units::Histogram<Time> outliers(1_ms, 60_s);
+  outliers.Record(0_s);
+  outliers.Record(3600_s, 9);
+  latencies.Merge(outliers);
+  CPPUNIT_ASSERT(latencies.GetCount() == 10010 && latencies.GetMin() == 0_s && latencies.GetMax() == 3600_s);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(60.0, double(latencies.GetPercentile(0.9995).GetRaw()), 0.004 * 60.0);
+
+  // integer storage
+  units::Histogram<Nanoseconds> nanoseconds(Nanoseconds::From(1), Nanoseconds::From(1000000000));
+  for (long long i = 1; i <= 1000; ++i)
+    nanoseconds.Record(Nanoseconds::From(i * 1000));
+  CPPUNIT_ASSERT(std::llabs(nanoseconds.GetPercentile(0.5).GetRaw() - 500000) <= 2000);
+
+  // many threads, no locks on the record path
+  units::ShardedHistogram<Time> shared(1_ms, 60_s);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&shared, t]()
+    {
+      units::ShardedHistogram<Time>::Recorder recorder = shared.GetRecorder();
+      for (int i = 1; i <= 2500; ++i)
+        recorder.Record(Time::From(0.001f * float(4 * (i - 1) + t + 1)));
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  const units::Histogram<Time> snapshot = shared.Snapshot();
+  CPPUNIT_ASSERT(snapshot.GetCount() == 10000 && snapshot.GetMin() == 0.001_s && snapshot.GetMax() == 10_s);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(9.9, double(snapshot.GetPercentile(0.99).GetRaw()), 0.004 * 9.9);
+
+  // quantile sketches: any range, negative values, exact merges
+  units::QuantileSketch<Length> low;
+  units::QuantileSketch<Length> high;
+  units::QuantileSketch<Length> all;
+  for (int i = -1000; i <= 100000; ++i)
+  {
+    const Length value = Length::From(0.5f * float(i));
+    ((i < 50000) ? low : high).Record(value);
+    all.Record(value);
+  }
+  low.Merge(high);
+  CPPUNIT_ASSERT(low.GetCount() == all.GetCount() && low.GetMin() == -500_m && low.GetMax() == 50000_m);
+  for (const double fraction : kFractions)
+  {
+    const double expected = 0.5 * (-1000.0 + fraction * 101000.0);
+    CPPUNIT_ASSERT(low.GetPercentile(fraction) == all.GetPercentile(fraction));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, double(all.GetPercentile(fraction).GetRaw()), 0.01 * std::abs(expected) + 0.5);
+  }
+
+  // bounded memory: the smallest magnitudes collapse, the high percentiles keep their accuracy
+  units::QuantileSketch<Length> bounded(0.01, 64);
+  for (int i = 1; i <= 100000; ++i)
+    bounded.Record(Length::From(float(i)));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(99000.0, double(bounded.GetPercentile(0.99).GetRaw()), 0.01 * 99000.0);
+}
+
+
+void UnitTest::TestDynamicQuantities()
+{
+  // fingerprints are linear in the exponents
+  static_assert(units::DimensionFingerprint(Velocity::kDimension) == units::DimensionFingerprint(Length::kDimension) - units::DimensionFingerprint(Time::kDimension), "quotients subtract");
+  static_assert(units::DimensionFingerprint(Area::kDimension) == 2 * units::DimensionFingerprint(Length::kDimension), "powers multiply");
+  static_assert(units::DimensionFingerprint(Kilometers::kDimension) == units::DimensionFingerprint(Length::kDimension), "scale is kept apart");
+  static_assert(units::DimensionFingerprint(Length::kDimension) != units::DimensionFingerprint(Time::kDimension), "distinct base dimensions");
+
+  // values from a config: 90 km in 1.5 h
+  const units::DynamicQuantity distance(90.0, Kilometers::kDimension);
+  const units::DynamicQuantity duration(1.5, Hours::kDimension);
+  const units::DynamicQuantity speed = distance / duration;
+  CPPUNIT_ASSERT(speed.IsValid() && speed.Is<Velocity>() && speed.Is<KilometersPerHour>() && !speed.Is<Length>());
+
+  Velocity velocity = 0_m_s;
+  CPPUNIT_ASSERT(speed.Get(velocity));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(60.0f / 3.6f, velocity.GetRaw(), 1e-5f);
+  KilometersPerHour kilometersPerHour = 0_km_h;
+  CPPUNIT_ASSERT(speed.Get(kilometersPerHour) && kilometersPerHour.GetRaw() == 60.0f); // same scale, no conversion
+
+  Length length = 7_m;
+  CPPUNIT_ASSERT(!speed.Get(length) && length == 7_m); // one check at the boundary, the value untouched on mismatch
+
+  // static units in, scales kept until converted
+  units::DynamicQuantity total = Kilometers::From(1.0f);
+  total += 250_m;
+  CPPUNIT_ASSERT(total.Get(length) && length == 1250_m);
+  CPPUNIT_ASSERT(total.GetScaleNumerator() == 1000 && total.GetScaleDenominator() == 1);
+  CPPUNIT_ASSERT(total > units::DynamicQuantity(1000_m) && total == units::DynamicQuantity(1.25, Kilometers::kDimension));
+
+  // integer storage rounds to nearest
+  Nanoseconds nanoseconds = Nanoseconds::From(0);
+  CPPUNIT_ASSERT(units::DynamicQuantity(0.3, Microseconds::kDimension).Get(nanoseconds) && nanoseconds.GetRaw() == 300);
+
+  // mismatched arithmetic stays invalid through the rest of an expression
+  const units::DynamicQuantity bad = (distance + duration) * speed + distance;
+  CPPUNIT_ASSERT(!bad.IsValid() && !bad.Get(length) && !bad.Is<Length>() && !(bad == bad));
+  CPPUNIT_ASSERT(!(distance < duration) && !(distance == duration) && distance != duration);
+
+  // dimensionless results convert to plain numbers, scale applied
+  double ratio = 0.0;
+  CPPUNIT_ASSERT((distance / units::DynamicQuantity(1000_m)).Get(ratio));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(90.0, ratio, 1e-12);
+  CPPUNIT_ASSERT(!distance.Get(ratio));
+
+  // products of products
+  const units::DynamicQuantity area = distance * distance;
+  const units::DynamicQuantity acceleration = speed / duration;
+  Area squareMeters = 0_m2;
+  Acceleration metersPerSecondSquared = 0_m_ss;
+  CPPUNIT_ASSERT(area.Get(squareMeters) && acceleration.Get(metersPerSecondSquared));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(8.1e9f, squareMeters.GetRaw(), 1e3f);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(60.0 / 3.6 / 5400.0, double(metersPerSecondSquared.GetRaw()), 1e-9);
+  CPPUNIT_ASSERT((1.0 / duration * distance).Is<Velocity>() && (2.0 * distance).Is<Length>());
+}
+
+
+void UnitTest::TestUnitRegistry()
+{
+  // populated by the unit macros, under their literal suffixes
+  const units::UnitRegistry &registry = units::UnitRegistry::Instance();
+  const units::UnitDescriptor *meters = registry.Find("m");
+  CPPUNIT_ASSERT(meters && meters->m_name == "Length" && meters->m_symbol == "m");
+  CPPUNIT_ASSERT(units::HasSameBaseDimensions(meters->m_dimension, Length::kDimension) && units::IsUnscaled(meters->m_dimension));
+  CPPUNIT_ASSERT(meters->m_storageKind == units::StorageKind::kFloat && meters->m_storageSize == sizeof(float));
+
+  const units::UnitDescriptor *kilometers = registry.Find("km");
+  CPPUNIT_ASSERT(kilometers && kilometers->m_name == "Kilometers" && kilometers->m_dimension.m_scaleNumerator == 1000);
+  CPPUNIT_ASSERT(kilometers->m_fingerprint == meters->m_fingerprint);
+
+  const units::UnitDescriptor *fixedMeters = registry.Find("fm");
+  const units::UnitDescriptor *nanoseconds = registry.Find("ns");
+  const units::UnitDescriptor *halfVolts = registry.Find("v16");
+  CPPUNIT_ASSERT(fixedMeters && fixedMeters->m_storageKind == units::StorageKind::kFixed && fixedMeters->m_storageParameter == 16);
+  CPPUNIT_ASSERT(nanoseconds && nanoseconds->m_storageKind == units::StorageKind::kSigned && nanoseconds->m_storageSize == sizeof(long long));
+  CPPUNIT_ASSERT(halfVolts && halfVolts->m_storageKind == units::StorageKind::kHalf);
+
+  // aliases, and labeled values resolved to static types through dynamic quantities
+  const units::UnitDescriptor *metersPerSecond = registry.Find("m/s");
+  CPPUNIT_ASSERT(metersPerSecond && metersPerSecond->m_name == "Velocity" && registry.Find("m_s")->m_fingerprint == metersPerSecond->m_fingerprint);
+  CPPUNIT_ASSERT(registry.Find("W") && registry.Find("W")->m_name == "Power");
+  Velocity velocity = 0_m_s;
+  CPPUNIT_ASSERT(registry.Find("km/h")->MakeQuantity(36.0).Get(velocity));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0f, velocity.GetRaw(), 1e-5f);
+  CPPUNIT_ASSERT(!registry.Find("W")->MakeQuantity(1.0).Get(velocity));
+
+  CPPUNIT_ASSERT(!registry.Find("furlong") && !registry.Find("") && !registry.Find("M") && !registry.Find("m/"));
+  CPPUNIT_ASSERT(registry.Find("km", units::internal::HashSymbol("km", registry.GetSeed())) == kilometers);
+
+  // enumeration for tooling
+  int numLengths = 0;
+  for (const units::UnitDescriptor &unit : registry.GetUnits())
+  {
+    CPPUNIT_ASSERT(registry.Find(unit.m_symbol) == &unit);
+    numLengths += (unit.m_fingerprint == meters->m_fingerprint) ? 1 : 0;
+  }
+  CPPUNIT_ASSERT(numLengths == 4); // m, fm, km & mm
+
+  // symbols are unique per unit
+  units::UnitRegistry local;
+  CPPUNIT_ASSERT(local.Find("m") == nullptr);
+  CPPUNIT_ASSERT(local.Register(units::DescribeUnit<Length>("Length", "m")));
+  CPPUNIT_ASSERT(local.Register(units::DescribeUnit<Length>("Length", "m")));
+  CPPUNIT_ASSERT(!local.Register(units::DescribeUnit<Time>("Time", "m")));
+  CPPUNIT_ASSERT(!local.Register(units::DescribeUnit<Time>("Time", "")));
+  CPPUNIT_ASSERT(local.GetUnits().size() == 1 && local.Find("m")->m_name == "Length");
+
+  // large catalogs still hash perfectly
+  const int kNumSymbols = 3000;
+  std::vector<std::string> symbols;
+  symbols.reserve(kNumSymbols);
+  for (int i = 0; i < kNumSymbols; ++i)
+    symbols.push_back("u" + std::to_string(i * 7919));
+  units::UnitRegistry large;
+  for (const std::string &symbol : symbols)
+    CPPUNIT_ASSERT(large.Register(units::DescribeUnit<Time>("Time", symbol)));
+  for (const std::string &symbol : symbols)
+    CPPUNIT_ASSERT(large.Find(symbol) && large.Find(symbol)->m_symbol == symbol);
+  CPPUNIT_ASSERT(!large.Find("u1") && large.GetUnits().size() == std::size_t(kNumSymbols));
+}
@@ -16,11 +16,59 @@ class UnitTest : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE(UnitTest);
     CPPUNIT_TEST(TestBasicUnits);
     CPPUNIT_TEST(TestDerivedUnits);
+    CPPUNIT_TEST(TestDimensions);
+    CPPUNIT_TEST(TestConstexpr);
+    CPPUNIT_TEST(TestLayout);
+    CPPUNIT_TEST(TestStructureOfArrays);
+    CPPUNIT_TEST(TestBatch);
+    CPPUNIT_TEST(TestPacks);
+    CPPUNIT_TEST(TestExpressions);
+    CPPUNIT_TEST(TestFixedPoint);
+    CPPUNIT_TEST(TestHalfPrecision);
+    CPPUNIT_TEST(TestScaledUnits);
+    CPPUNIT_TEST(TestVectors);
+    CPPUNIT_TEST(TestMatrices);
+    CPPUNIT_TEST(TestMath);
+    CPPUNIT_TEST(TestPrecision);
+    CPPUNIT_TEST(TestParsing);
+    CPPUNIT_TEST(TestFormatting);
+    CPPUNIT_TEST(TestColumnFiles);
+    CPPUNIT_TEST(TestIngest);
+    CPPUNIT_TEST(TestAtomic);
+    CPPUNIT_TEST(TestReductions);
+    CPPUNIT_TEST(TestAccumulators);
+    CPPUNIT_TEST(TestHistograms);
+    CPPUNIT_TEST(TestDynamicQuantities);
+    CPPUNIT_TEST(TestUnitRegistry);
     CPPUNIT_TEST_SUITE_END();
 
   public:
     void TestBasicUnits();
     void TestDerivedUnits();
+    void TestDimensions();
+    void TestConstexpr();
+    void TestLayout();
+    void TestStructureOfArrays();
+    void TestBatch();
+    void TestPacks();
+    void TestExpressions();
+    void TestFixedPoint();
+    void TestHalfPrecision();
+    void TestScaledUnits();
+    void TestVectors();
+    void TestMatrices();
+    void TestMath();
+    void TestPrecision();
+    void TestParsing();
+    void TestFormatting();
+    void TestColumnFiles();
+    void TestIngest();
+    void TestAtomic();
+    void TestReductions();
+    void TestAccumulators();
+    void TestHistograms();
+    void TestDynamicQuantities();
+    void TestUnitRegistry();
 };
 
 
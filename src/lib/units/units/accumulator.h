@@ -0,0 +1,165 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_ACCUMULATOR_H
+#define UNITS_ACCUMULATOR_H
+
+
+#include <cmath>
+
+#include "units/batch.h"
+
+
+// compensated accumulators
+// ------------------------------------------------------------------------------------------------------------------------------
+
+// long-running totals of small increments (e.g. distance traveled per frame) kept in the unit's own float storage,
+// with a second float of the same unit carrying the rounding error each addition dropped, for close to double accuracy at float size
+// the error terms only survive strict floating-point semantics: do not build these with -ffast-math or /fp:fast
+
+namespace units
+{
+  namespace internal
+  {
+    // sum += x with the exact rounding error of the addition (whichever operand is bigger) added to the compensation,
+    // then folded back so the compensation stays within half an ulp of the sum instead of drifting as a float total of its own;
+    // selects rather than branches, so loops of these vectorize
+    template <typename Storage>
+    inline void NeumaierStep(Storage &sum, Storage &compensation, const Storage x) noexcept
+    {
+      const Storage t = sum + x;
+      const bool sumIsBigger = (std::abs(sum) >= std::abs(x));
+      const Storage error = ((sumIsBigger ? sum : x) - t) + (sumIsBigger ? x : sum) + compensation;
+      sum = t + error;
+      compensation = error - (sum - t);
+    }
+  }
+
+  // Kahan summation: the error is fed back into the next increment; exact enough when increments are smaller than the total
+  template <typename UnitType>
+  class KahanAccumulator
+  {
+    static_assert(IsQuantity<UnitType>::value && std::is_floating_point<typename UnitType::Storage>::value, "compensated accumulators need floating-point unit types");
+
+    public:
+      typedef UnitType Unit;
+      typedef typename Unit::Storage Storage;
+
+      constexpr KahanAccumulator() noexcept : m_sum(), m_compensation() { }
+      constexpr explicit KahanAccumulator(const Unit initial) noexcept : m_sum(initial.GetRaw()), m_compensation() { }
+
+      KahanAccumulator &Add(const Unit value) noexcept
+      {
+        const Storage y = value.GetRaw() - m_compensation;
+        const Storage t = m_sum + y;
+        m_compensation = (t - m_sum) - y;
+        m_sum = t;
+        return *this;
+      }
+
+      KahanAccumulator &operator+=(const Unit value) noexcept { return Add(value); }
+      KahanAccumulator &operator-=(const Unit value) noexcept { return Add(-value); }
+
+      Unit GetSum() const noexcept { return Unit::From(m_sum - m_compensation); }
+      Unit GetCompensation() const noexcept { return Unit::From(m_compensation); }
+
+    private:
+      Storage m_sum;
+      Storage m_compensation; // what the last additions lost, with the sign flipped
+  };
+
+  // Neumaier's variant: also exact when an increment is larger than the total (e.g. sums that cancel), and mergeable
+  template <typename UnitType>
+  class NeumaierAccumulator
+  {
+    static_assert(IsQuantity<UnitType>::value && std::is_floating_point<typename UnitType::Storage>::value, "compensated accumulators need floating-point unit types");
+
+    public:
+      typedef UnitType Unit;
+      typedef typename Unit::Storage Storage;
+
+      constexpr NeumaierAccumulator() noexcept : m_sum(), m_compensation() { }
+      constexpr explicit NeumaierAccumulator(const Unit initial) noexcept : m_sum(initial.GetRaw()), m_compensation() { }
+
+      NeumaierAccumulator &Add(const Unit value) noexcept
+      {
+        internal::NeumaierStep(m_sum, m_compensation, value.GetRaw());
+        return *this;
+      }
+
+      // combines partial totals, e.g. per thread
+      NeumaierAccumulator &Add(const NeumaierAccumulator &other) noexcept
+      {
+        internal::NeumaierStep(m_sum, m_compensation, other.m_sum);
+        internal::NeumaierStep(m_sum, m_compensation, other.m_compensation);
+        return *this;
+      }
+
+      NeumaierAccumulator &operator+=(const Unit value) noexcept { return Add(value); }
+      NeumaierAccumulator &operator-=(const Unit value) noexcept { return Add(-value); }
+      NeumaierAccumulator &operator+=(const NeumaierAccumulator &other) noexcept { return Add(other); }
+
+      Unit GetSum() const noexcept { return Unit::From(m_sum + m_compensation); }
+      Unit GetCompensation() const noexcept { return Unit::From(m_compensation); }
+
+    private:
+      Storage m_sum;
+      Storage m_compensation; // what the additions lost so far, below half an ulp of the sum
+  };
+
+  // accumulators[i] += increments[i], e.g. per-entity totals updated every frame
+  template <typename Accumulators, typename Increments>
+  inline void accumulate(Accumulators &&accumulators, const Increments &increments)
+  {
+    const auto totals = std::span(accumulators);
+    const auto values = std::span(increments);
+    typedef typename std::remove_cv<typename decltype(values)::element_type>::type Unit;
+    static_assert(std::is_same<typename decltype(totals)::element_type, NeumaierAccumulator<Unit>>::value, "accumulate adds units into Neumaier accumulators of the same unit");
+    assert(totals.size() == values.size() && "batch operands must have the same size");
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+      totals[i].Add(values[i]);
+  }
+
+  // sum of a whole range with Neumaier compensation in kCompensatedLanes independent lanes per block (so it pipelines & vectorizes),
+  // lanes merged at the end; close to the correctly rounded sum, single-threaded (see units/reduce.h for multi-threaded sums)
+  template <typename Range>
+  inline internal::RangeValue<Range> compensated_sum(const Range &range)
+  {
+    typedef internal::RangeValue<Range> Unit;
+    typedef internal::RangeStorage<Range> Storage;
+    static_assert(IsQuantity<Unit>::value && std::is_floating_point<Storage>::value, "compensated sums need floating-point unit types");
+    const int kCompensatedLanes = 8;
+
+    const auto values = raw_span(std::span(range));
+    Storage sums[kCompensatedLanes] = { };
+    Storage compensations[kCompensatedLanes] = { };
+    const std::size_t numWhole = values.size() - values.size() % kCompensatedLanes;
+    for (std::size_t i = 0; i < numWhole; i += kCompensatedLanes)
+    {
+      for (int j = 0; j < kCompensatedLanes; ++j)
+        internal::NeumaierStep(sums[j], compensations[j], values[i + j]);
+    }
+
+    NeumaierAccumulator<Unit> total;
+    for (std::size_t i = numWhole; i < values.size(); ++i)
+      total.Add(Unit::From(values[i]));
+    for (int j = 0; j < kCompensatedLanes; ++j)
+    {
+      total.Add(Unit::From(sums[j]));
+      total.Add(Unit::From(compensations[j]));
+    }
+    return total.GetSum();
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: compensated accumulators
+
+
+#endif
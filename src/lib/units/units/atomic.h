@@ -0,0 +1,118 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_ATOMIC_H
+#define UNITS_ATOMIC_H
+
+
+#include <atomic>
+
+#include "units/units.h"
+
+
+// atomic units
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // a unit value shared between threads, e.g. a process-wide accumulator
+  //   units::atomic<Energy> s_totalEnergy;
+  //   s_totalEnergy.fetch_add(used, std::memory_order_relaxed);
+  // mirrors std::atomic on the raw storage (integer or floating-point), so it is lock-free wherever std::atomic of the storage is;
+  // fetch_add & fetch_sub use the native instructions (a single locked add for integers, a compare-exchange loop the compiler emits for floats),
+  // fetch_max & fetch_min are compare-exchange loops that leave the value untouched (no write, no cache line stolen) when it already wins
+  template <typename UnitType>
+  class atomic
+  {
+    static_assert(IsQuantity<UnitType>::value, "units::atomic holds unit types");
+    static_assert(std::is_arithmetic<typename UnitType::Storage>::value, "units::atomic needs integer or floating-point storage");
+
+    public:
+      typedef UnitType Unit;
+      typedef typename Unit::Storage Storage;
+      static constexpr bool is_always_lock_free = std::atomic<Storage>::is_always_lock_free;
+
+      constexpr atomic() noexcept : m_data(Storage()) { }
+      constexpr atomic(const Unit desired) noexcept : m_data(desired.GetRaw()) { }
+      atomic(const atomic &) = delete;
+      atomic &operator=(const atomic &) = delete;
+
+      bool is_lock_free() const noexcept { return m_data.is_lock_free(); }
+
+      Unit load(const std::memory_order order = std::memory_order_seq_cst) const noexcept { return Unit::From(m_data.load(order)); }
+      void store(const Unit desired, const std::memory_order order = std::memory_order_seq_cst) noexcept { m_data.store(desired.GetRaw(), order); }
+      Unit exchange(const Unit desired, const std::memory_order order = std::memory_order_seq_cst) noexcept { return Unit::From(m_data.exchange(desired.GetRaw(), order)); }
+
+      operator Unit() const noexcept { return load(); }
+      Unit operator=(const Unit desired) noexcept { store(desired); return desired; }
+
+      // on failure, expected is updated to the current value
+      bool compare_exchange_weak(Unit &expected, const Unit desired, const std::memory_order order = std::memory_order_seq_cst) noexcept
+      {
+        return CompareExchange<true>(expected, desired, order, FailureOrder(order));
+      }
+      bool compare_exchange_weak(Unit &expected, const Unit desired, const std::memory_order success, const std::memory_order failure) noexcept
+      {
+        return CompareExchange<true>(expected, desired, success, failure);
+      }
+      bool compare_exchange_strong(Unit &expected, const Unit desired, const std::memory_order order = std::memory_order_seq_cst) noexcept
+      {
+        return CompareExchange<false>(expected, desired, order, FailureOrder(order));
+      }
+      bool compare_exchange_strong(Unit &expected, const Unit desired, const std::memory_order success, const std::memory_order failure) noexcept
+      {
+        return CompareExchange<false>(expected, desired, success, failure);
+      }
+
+      // previous value
+      Unit fetch_add(const Unit arg, const std::memory_order order = std::memory_order_seq_cst) noexcept { return Unit::From(m_data.fetch_add(arg.GetRaw(), order)); }
+      Unit fetch_sub(const Unit arg, const std::memory_order order = std::memory_order_seq_cst) noexcept { return Unit::From(m_data.fetch_sub(arg.GetRaw(), order)); }
+
+      // previous value; NaNs never replace the value and are never replaced
+      // when the value already wins nothing is written, so the read that saw it takes the load part of order (e.g. acquire for acq_rel)
+      Unit fetch_max(const Unit arg, const std::memory_order order = std::memory_order_seq_cst) noexcept
+      {
+        Storage current = m_data.load(FailureOrder(order));
+        while (current < arg.GetRaw() && !m_data.compare_exchange_weak(current, arg.GetRaw(), order, FailureOrder(order))) { }
+        return Unit::From(current);
+      }
+      Unit fetch_min(const Unit arg, const std::memory_order order = std::memory_order_seq_cst) noexcept
+      {
+        Storage current = m_data.load(FailureOrder(order));
+        while (arg.GetRaw() < current && !m_data.compare_exchange_weak(current, arg.GetRaw(), order, FailureOrder(order))) { }
+        return Unit::From(current);
+      }
+
+      // new value
+      Unit operator+=(const Unit arg) noexcept { return fetch_add(arg) + arg; }
+      Unit operator-=(const Unit arg) noexcept { return fetch_sub(arg) - arg; }
+
+    private:
+      static constexpr std::memory_order FailureOrder(const std::memory_order order) noexcept
+      {
+        return (order == std::memory_order_acq_rel) ? std::memory_order_acquire : ((order == std::memory_order_release) ? std::memory_order_relaxed : order);
+      }
+
+      template <bool kWeak>
+      bool CompareExchange(Unit &expected, const Unit desired, const std::memory_order success, const std::memory_order failure) noexcept
+      {
+        Storage raw = expected.GetRaw();
+        const bool exchanged = kWeak ? m_data.compare_exchange_weak(raw, desired.GetRaw(), success, failure) : m_data.compare_exchange_strong(raw, desired.GetRaw(), success, failure);
+        expected = Unit::From(raw);
+        return exchanged;
+      }
+
+      std::atomic<Storage> m_data;
+  };
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: atomic units
+
+
+#endif
@@ -0,0 +1,536 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_BATCH_H
+#define UNITS_BATCH_H
+
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include "units/simd.h"
+#include "units/span.h"
+
+
+// vector ops
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    enum class BinaryOp { kAdd, kSubtract, kMultiply, kDivide, kMin, kMax };
+    enum class UnaryOp { kSqrt, kAbs };
+
+    // min & max follow the SSE convention: the second operand wins ties and NaNs
+    template <BinaryOp kOp, typename Scalar>
+    UNITS_FORCE_INLINE Scalar ApplyScalar(const Scalar lhs, const Scalar rhs)
+    {
+      if constexpr (kOp == BinaryOp::kAdd) return lhs + rhs;
+      else if constexpr (kOp == BinaryOp::kSubtract) return lhs - rhs;
+      else if constexpr (kOp == BinaryOp::kMultiply) return lhs * rhs;
+      else if constexpr (kOp == BinaryOp::kDivide) return lhs / rhs;
+      else if constexpr (kOp == BinaryOp::kMin) return (lhs < rhs) ? lhs : rhs;
+      else return (lhs > rhs) ? lhs : rhs;
+    }
+
+    template <UnaryOp kOp, typename Scalar>
+    UNITS_FORCE_INLINE Scalar ApplyScalar(const Scalar value)
+    {
+      if constexpr (kOp == UnaryOp::kSqrt) return std::sqrt(value);
+      else return std::abs(value);
+    }
+
+#if UNITS_SIMD_X64
+
+    // one struct per (instruction set, scalar type), all with the same interface
+    // e.g. Prefix = _mm256_ and Type = ps map Add to _mm256_add_ps
+    #define UNITS_VECTOR_OP(Prefix, Op, Type) UNITS_MACRO_CONCAT(Prefix, UNITS_MACRO_CONCAT(Op, Type))
+    // GCC 12 flags the undefined pass-through operand of some unmasked AVX-512 intrinsics as uninitialized, so those go through
+    // the zero-masked forms with every lane selected
+    #define UNITS_VECTOR_UNMASKED(Prefix, Op, Type, Width, ...) UNITS_VECTOR_OP(Prefix, Op, Type)(__VA_ARGS__)
+    #define UNITS_VECTOR_MASKED(Prefix, Op, Type, Width, ...) UNITS_VECTOR_OP(Prefix, UNITS_MACRO_CONCAT(maskz_, Op), Type)(static_cast<__mmask16>((1u << Width) - 1), __VA_ARGS__)
+    #define UNITS_VECTOR_OPS(OpsName, Target, ScalarType, VectorType, Width, Prefix, Type, MulAdd, Lanewise)                           \
+      struct OpsName                                                                                                                   \
+      {                                                                                                                                \
+        typedef ScalarType Scalar;                                                                                                     \
+        typedef VectorType Vector;                                                                                                     \
+        static const int kWidth = Width;                                                                                               \
+        static Target UNITS_FORCE_INLINE Vector Load(const Scalar *p) { return UNITS_VECTOR_OP(Prefix, loadu_, Type)(p); }             \
+        static Target UNITS_FORCE_INLINE void Store(Scalar *p, const Vector v) { UNITS_VECTOR_OP(Prefix, storeu_, Type)(p, v); }       \
+        static Target UNITS_FORCE_INLINE Vector Broadcast(const Scalar s) { return UNITS_VECTOR_OP(Prefix, set1_, Type)(s); }          \
+        static Target UNITS_FORCE_INLINE Vector Add(const Vector a, const Vector b) { return UNITS_VECTOR_OP(Prefix, add_, Type)(a, b); } \
+        static Target UNITS_FORCE_INLINE Vector Subtract(const Vector a, const Vector b) { return UNITS_VECTOR_OP(Prefix, sub_, Type)(a, b); } \
+        static Target UNITS_FORCE_INLINE Vector Multiply(const Vector a, const Vector b) { return UNITS_VECTOR_OP(Prefix, mul_, Type)(a, b); } \
+        static Target UNITS_FORCE_INLINE Vector Divide(const Vector a, const Vector b) { return UNITS_VECTOR_OP(Prefix, div_, Type)(a, b); } \
+        static Target UNITS_FORCE_INLINE Vector MultiplyAdd(const Vector a, const Vector b, const Vector c) { return MulAdd; }         \
+        static Target UNITS_FORCE_INLINE Vector Min(const Vector a, const Vector b) { return Lanewise(Prefix, min_, Type, Width, a, b); }    \
+        static Target UNITS_FORCE_INLINE Vector Max(const Vector a, const Vector b) { return Lanewise(Prefix, max_, Type, Width, a, b); }    \
+        static Target UNITS_FORCE_INLINE Vector Sqrt(const Vector a) { return Lanewise(Prefix, sqrt_, Type, Width, a); }                  \
+        static Target UNITS_FORCE_INLINE Vector Abs(const Vector a) { return UNITS_VECTOR_OP(Prefix, andnot_, Type)(Broadcast(Scalar(-0.0)), a); } \
+      }
+
+    UNITS_VECTOR_OPS(Sse2Float, UNITS_TARGET_SSE2, float, __m128, 4, _mm_, ps, Add(Multiply(a, b), c), UNITS_VECTOR_UNMASKED);
+    UNITS_VECTOR_OPS(Sse2Double, UNITS_TARGET_SSE2, double, __m128d, 2, _mm_, pd, Add(Multiply(a, b), c), UNITS_VECTOR_UNMASKED);
+    UNITS_VECTOR_OPS(Avx2Float, UNITS_TARGET_AVX2, float, __m256, 8, _mm256_, ps, _mm256_fmadd_ps(a, b, c), UNITS_VECTOR_UNMASKED);
+    UNITS_VECTOR_OPS(Avx2Double, UNITS_TARGET_AVX2, double, __m256d, 4, _mm256_, pd, _mm256_fmadd_pd(a, b, c), UNITS_VECTOR_UNMASKED);
+    UNITS_VECTOR_OPS(Avx512Float, UNITS_TARGET_AVX512, float, __m512, 16, _mm512_, ps, _mm512_fmadd_ps(a, b, c), UNITS_VECTOR_MASKED);
+    UNITS_VECTOR_OPS(Avx512Double, UNITS_TARGET_AVX512, double, __m512d, 8, _mm512_, pd, _mm512_fmadd_pd(a, b, c), UNITS_VECTOR_MASKED);
+
+    #undef UNITS_VECTOR_OPS
+    #undef UNITS_VECTOR_MASKED
+    #undef UNITS_VECTOR_UNMASKED
+    #undef UNITS_VECTOR_OP
+
+    template <typename Scalar> struct Sse2Ops;
+    template <> struct Sse2Ops<float> { typedef Sse2Float Type; };
+    template <> struct Sse2Ops<double> { typedef Sse2Double Type; };
+    template <typename Scalar> struct Avx2Ops;
+    template <> struct Avx2Ops<float> { typedef Avx2Float Type; };
+    template <> struct Avx2Ops<double> { typedef Avx2Double Type; };
+    template <typename Scalar> struct Avx512Ops;
+    template <> struct Avx512Ops<float> { typedef Avx512Float Type; };
+    template <> struct Avx512Ops<double> { typedef Avx512Double Type; };
+
+#endif
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: vector ops
+
+
+// batch kernels
+// ------------------------------------------------------------------------------------------------------------------------------
+
+// raw kernels over storage arrays, stamped out once per instruction set so each copy is compiled for its target
+// outputs may alias inputs element for element (in-place updates), but must not partially overlap them
+#define UNITS_BATCH_KERNELS(Target)                                                                                                    \
+  template <units::internal::BinaryOp kOp, typename Ops>                                                                               \
+  Target void Binary(const typename Ops::Scalar *lhs, const typename Ops::Scalar *rhs, typename Ops::Scalar *out, const std::size_t n) \
+  {                                                                                                                                    \
+    std::size_t i = 0;                                                                                                                 \
+    for (; i + Ops::kWidth <= n; i += Ops::kWidth)                                                                                     \
+    {                                                                                                                                  \
+      const typename Ops::Vector a = Ops::Load(lhs + i);                                                                               \
+      const typename Ops::Vector b = Ops::Load(rhs + i);                                                                               \
+      if constexpr (kOp == units::internal::BinaryOp::kAdd) Ops::Store(out + i, Ops::Add(a, b));                                       \
+      else if constexpr (kOp == units::internal::BinaryOp::kSubtract) Ops::Store(out + i, Ops::Subtract(a, b));                        \
+      else if constexpr (kOp == units::internal::BinaryOp::kMultiply) Ops::Store(out + i, Ops::Multiply(a, b));                        \
+      else if constexpr (kOp == units::internal::BinaryOp::kDivide) Ops::Store(out + i, Ops::Divide(a, b));                            \
+      else if constexpr (kOp == units::internal::BinaryOp::kMin) Ops::Store(out + i, Ops::Min(a, b));                                  \
+      else Ops::Store(out + i, Ops::Max(a, b));                                                                                        \
+    }                                                                                                                                  \
+    for (; i < n; ++i)                                                                                                                 \
+      out[i] = units::internal::ApplyScalar<kOp>(lhs[i], rhs[i]);                                                                      \
+  }                                                                                                                                    \
+                                                                                                                                       \
+  template <units::internal::UnaryOp kOp, typename Ops>                                                                                \
+  Target void Unary(const typename Ops::Scalar *in, typename Ops::Scalar *out, const std::size_t n)                                    \
+  {                                                                                                                                    \
+    std::size_t i = 0;                                                                                                                 \
+    for (; i + Ops::kWidth <= n; i += Ops::kWidth)                                                                                     \
+    {                                                                                                                                  \
+      if constexpr (kOp == units::internal::UnaryOp::kSqrt) Ops::Store(out + i, Ops::Sqrt(Ops::Load(in + i)));                         \
+      else Ops::Store(out + i, Ops::Abs(Ops::Load(in + i)));                                                                           \
+    }                                                                                                                                  \
+    for (; i < n; ++i)                                                                                                                 \
+      out[i] = units::internal::ApplyScalar<kOp>(in[i]);                                                                               \
+  }                                                                                                                                    \
+                                                                                                                                       \
+  template <typename Ops>                                                                                                              \
+  Target void Clamp(const typename Ops::Scalar *in, const typename Ops::Scalar lo, const typename Ops::Scalar hi, typename Ops::Scalar *out, const std::size_t n) \
+  {                                                                                                                                    \
+    const typename Ops::Vector l = Ops::Broadcast(lo);                                                                                 \
+    const typename Ops::Vector h = Ops::Broadcast(hi);                                                                                 \
+    std::size_t i = 0;                                                                                                                 \
+    for (; i + Ops::kWidth <= n; i += Ops::kWidth)                                                                                     \
+      Ops::Store(out + i, Ops::Max(Ops::Min(Ops::Load(in + i), h), l));                                                                \
+    for (; i < n; ++i)                                                                                                                 \
+      out[i] = units::internal::ApplyScalar<units::internal::BinaryOp::kMax>(units::internal::ApplyScalar<units::internal::BinaryOp::kMin>(in[i], hi), lo); \
+  }                                                                                                                                    \
+                                                                                                                                       \
+  template <typename Ops>                                                                                                              \
+  Target void Scale(const typename Ops::Scalar *in, const typename Ops::Scalar factor, typename Ops::Scalar *out, const std::size_t n) \
+  {                                                                                                                                    \
+    const typename Ops::Vector f = Ops::Broadcast(factor);                                                                             \
+    std::size_t i = 0;                                                                                                                 \
+    for (; i + Ops::kWidth <= n; i += Ops::kWidth)                                                                                     \
+      Ops::Store(out + i, Ops::Multiply(Ops::Load(in + i), f));                                                                        \
+    for (; i < n; ++i)                                                                                                                 \
+      out[i] = in[i] * factor;                                                                                                         \
+  }                                                                                                                                    \
+                                                                                                                                       \
+  template <bool kBroadcastB, typename Ops>                                                                                            \
+  Target void MultiplyAdd(const typename Ops::Scalar *a, const typename Ops::Scalar *b, const typename Ops::Scalar *c, typename Ops::Scalar *out, const std::size_t n) \
+  {                                                                                                                                    \
+    const typename Ops::Vector bb = Ops::Broadcast(kBroadcastB ? *b : typename Ops::Scalar(0));                                        \
+    std::size_t i = 0;                                                                                                                 \
+    for (; i + Ops::kWidth <= n; i += Ops::kWidth)                                                                                     \
+      Ops::Store(out + i, Ops::MultiplyAdd(Ops::Load(a + i), kBroadcastB ? bb : Ops::Load(b + i), Ops::Load(c + i)));                  \
+    for (; i < n; ++i)                                                                                                                 \
+      out[i] = a[i] * b[kBroadcastB ? 0 : i] + c[i];                                                                                   \
+  }                                                                                                                                    \
+
+namespace units
+{
+  namespace internal
+  {
+    // plain loops, for any storage type and for machines without SIMD; compilers may still auto-vectorize these
+    namespace scalar
+    {
+      template <BinaryOp kOp, typename Scalar>
+      void Binary(const Scalar *lhs, const Scalar *rhs, Scalar *out, const std::size_t n)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = ApplyScalar<kOp>(lhs[i], rhs[i]);
+      }
+
+      template <UnaryOp kOp, typename Scalar>
+      void Unary(const Scalar *in, Scalar *out, const std::size_t n)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = ApplyScalar<kOp>(in[i]);
+      }
+
+      template <typename Scalar>
+      void Clamp(const Scalar *in, const Scalar lo, const Scalar hi, Scalar *out, const std::size_t n)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = ApplyScalar<BinaryOp::kMax>(ApplyScalar<BinaryOp::kMin>(in[i], hi), lo);
+      }
+
+      template <typename Scalar>
+      void Scale(const Scalar *in, const Scalar factor, Scalar *out, const std::size_t n)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = in[i] * factor;
+      }
+
+      template <bool kBroadcastB, typename Scalar>
+      void MultiplyAdd(const Scalar *a, const Scalar *b, const Scalar *c, Scalar *out, const std::size_t n)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = a[i] * b[kBroadcastB ? 0 : i] + c[i];
+      }
+    }
+
+#if UNITS_SIMD_X64
+    namespace sse2 { UNITS_BATCH_KERNELS(UNITS_TARGET_SSE2) }
+    namespace avx2 { UNITS_BATCH_KERNELS(UNITS_TARGET_AVX2) }
+    namespace avx512 { UNITS_BATCH_KERNELS(UNITS_TARGET_AVX512) }
+#endif
+
+    template <typename Scalar>
+    constexpr bool kHasVectorKernels = std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value;
+
+    // the following pick the widest kernel the active instruction set allows
+
+    template <BinaryOp kOp, typename Scalar>
+    inline void BatchBinary(const Scalar *lhs, const Scalar *rhs, Scalar *out, const std::size_t n)
+    {
+#if UNITS_SIMD_X64
+      if constexpr (kHasVectorKernels<Scalar>)
+      {
+        switch (GetInstructionSet())
+        {
+          case InstructionSet::kAvx512: avx512::Binary<kOp, typename Avx512Ops<Scalar>::Type>(lhs, rhs, out, n); return;
+          case InstructionSet::kAvx2: avx2::Binary<kOp, typename Avx2Ops<Scalar>::Type>(lhs, rhs, out, n); return;
+          case InstructionSet::kSse2: sse2::Binary<kOp, typename Sse2Ops<Scalar>::Type>(lhs, rhs, out, n); return;
+          case InstructionSet::kScalar: break;
+        }
+      }
+#endif
+      scalar::Binary<kOp>(lhs, rhs, out, n);
+    }
+
+    template <UnaryOp kOp, typename Scalar>
+    inline void BatchUnary(const Scalar *in, Scalar *out, const std::size_t n)
+    {
+#if UNITS_SIMD_X64
+      if constexpr (kHasVectorKernels<Scalar>)
+      {
+        switch (GetInstructionSet())
+        {
+          case InstructionSet::kAvx512: avx512::Unary<kOp, typename Avx512Ops<Scalar>::Type>(in, out, n); return;
+          case InstructionSet::kAvx2: avx2::Unary<kOp, typename Avx2Ops<Scalar>::Type>(in, out, n); return;
+          case InstructionSet::kSse2: sse2::Unary<kOp, typename Sse2Ops<Scalar>::Type>(in, out, n); return;
+          case InstructionSet::kScalar: break;
+        }
+      }
+#endif
+      scalar::Unary<kOp>(in, out, n);
+    }
+
+    template <typename Scalar>
+    inline void BatchClamp(const Scalar *in, const Scalar lo, const Scalar hi, Scalar *out, const std::size_t n)
+    {
+#if UNITS_SIMD_X64
+      if constexpr (kHasVectorKernels<Scalar>)
+      {
+        switch (GetInstructionSet())
+        {
+          case InstructionSet::kAvx512: avx512::Clamp<typename Avx512Ops<Scalar>::Type>(in, lo, hi, out, n); return;
+          case InstructionSet::kAvx2: avx2::Clamp<typename Avx2Ops<Scalar>::Type>(in, lo, hi, out, n); return;
+          case InstructionSet::kSse2: sse2::Clamp<typename Sse2Ops<Scalar>::Type>(in, lo, hi, out, n); return;
+          case InstructionSet::kScalar: break;
+        }
+      }
+#endif
+      scalar::Clamp(in, lo, hi, out, n);
+    }
+
+    template <typename Scalar>
+    inline void BatchScale(const Scalar *in, const Scalar factor, Scalar *out, const std::size_t n)
+    {
+#if UNITS_SIMD_X64
+      if constexpr (kHasVectorKernels<Scalar>)
+      {
+        switch (GetInstructionSet())
+        {
+          case InstructionSet::kAvx512: avx512::Scale<typename Avx512Ops<Scalar>::Type>(in, factor, out, n); return;
+          case InstructionSet::kAvx2: avx2::Scale<typename Avx2Ops<Scalar>::Type>(in, factor, out, n); return;
+          case InstructionSet::kSse2: sse2::Scale<typename Sse2Ops<Scalar>::Type>(in, factor, out, n); return;
+          case InstructionSet::kScalar: break;
+        }
+      }
+#endif
+      scalar::Scale(in, factor, out, n);
+    }
+
+    template <bool kBroadcastB, typename Scalar>
+    inline void BatchMultiplyAdd(const Scalar *a, const Scalar *b, const Scalar *c, Scalar *out, const std::size_t n)
+    {
+#if UNITS_SIMD_X64
+      if constexpr (kHasVectorKernels<Scalar>)
+      {
+        switch (GetInstructionSet())
+        {
+          case InstructionSet::kAvx512: avx512::MultiplyAdd<kBroadcastB, typename Avx512Ops<Scalar>::Type>(a, b, c, out, n); return;
+          case InstructionSet::kAvx2: avx2::MultiplyAdd<kBroadcastB, typename Avx2Ops<Scalar>::Type>(a, b, c, out, n); return;
+          case InstructionSet::kSse2: sse2::MultiplyAdd<kBroadcastB, typename Sse2Ops<Scalar>::Type>(a, b, c, out, n); return;
+          case InstructionSet::kScalar: break;
+        }
+      }
+#endif
+      scalar::MultiplyAdd<kBroadcastB>(a, b, c, out, n);
+    }
+  }
+}
+
+#undef UNITS_BATCH_KERNELS
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: batch kernels
+
+
+// batch operations
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // element type of any contiguous range (std::span, std::vector, std::array, C array, UnitSoA column...)
+    template <typename Range>
+    using RangeElement = typename decltype(std::span(std::declval<Range &>()))::element_type;
+
+    template <typename Range>
+    using RangeValue = typename std::remove_cv<RangeElement<Range>>::type;
+
+    template <typename Range>
+    using RangeStorage = typename StorageOf<RangeValue<Range>>::Type;
+
+    template <typename T>
+    struct IsBroadcastable : std::integral_constant<bool, IsQuantity<T>::value || std::is_arithmetic<T>::value> { };
+
+    // element value of a range operand, or the operand itself if it is a single value
+    template <typename T, bool = IsBroadcastable<T>::value>
+    struct OperandValue { typedef T Type; };
+    template <typename T>
+    struct OperandValue<T, false> { typedef RangeValue<T> Type; };
+
+    // dimension of a unit, dimensionless for raw values
+    template <typename Unit, typename = void> struct DimensionOf { static constexpr Dimension value = Dimension{ }; };
+    template <typename Unit> struct DimensionOf<Unit, typename std::enable_if<IsQuantity<Unit>::value>::type> { static constexpr Dimension value = Unit::kDimension; };
+
+    // applies the scale a dimensionless product or quotient collapses away (e.g. kilometers / meters), like the scalar operators do
+    template <typename Result, Dimension kResult, typename Storage>
+    inline void RescaleCollapsed(Storage *out, const std::size_t size)
+    {
+      if constexpr (!IsQuantity<Result>::value && kResult.m_scaleNumerator != kResult.m_scaleDenominator)
+      {
+        for (std::size_t i = 0; i < size; ++i)
+          out[i] = Rescale<kResult.m_scaleNumerator, kResult.m_scaleDenominator>(out[i]);
+      }
+      else
+      {
+        (void) out;
+        (void) size;
+      }
+    }
+
+    template <typename Out>
+    inline auto OutputSpan(Out &out, const std::size_t size)
+    {
+      static_assert(!std::is_const<RangeElement<Out>>::value, "batch output must be writable");
+      const auto result = raw_span(std::span(out));
+      assert(result.size() == size && "batch operands must have the same size");
+      (void) size;
+      return result;
+    }
+
+    template <typename T>
+    inline typename StorageOf<T>::Type RawValue(const T value)
+    {
+      if constexpr (IsQuantity<T>::value)
+        return value.GetRaw();
+      else
+        return value;
+    }
+  }
+
+  // out[i] = lhs[i] + rhs[i]
+  template <typename Lhs, typename Rhs, typename Out>
+  inline void add(const Lhs &lhs, const Rhs &rhs, Out &&out)
+  {
+    typedef internal::RangeValue<Lhs> Unit;
+    static_assert(std::is_same<Unit, internal::RangeValue<Rhs>>::value && std::is_same<Unit, internal::RangeValue<Out>>::value, "add requires identical units");
+
+    const auto a = raw_span(std::span(lhs));
+    const auto b = raw_span(std::span(rhs));
+    assert(a.size() == b.size() && "batch operands must have the same size");
+    internal::BatchBinary<internal::BinaryOp::kAdd>(a.data(), b.data(), internal::OutputSpan(out, a.size()).data(), a.size());
+  }
+
+  // out[i] = lhs[i] - rhs[i]
+  template <typename Lhs, typename Rhs, typename Out>
+  inline void subtract(const Lhs &lhs, const Rhs &rhs, Out &&out)
+  {
+    typedef internal::RangeValue<Lhs> Unit;
+    static_assert(std::is_same<Unit, internal::RangeValue<Rhs>>::value && std::is_same<Unit, internal::RangeValue<Out>>::value, "subtract requires identical units");
+
+    const auto a = raw_span(std::span(lhs));
+    const auto b = raw_span(std::span(rhs));
+    assert(a.size() == b.size() && "batch operands must have the same size");
+    internal::BatchBinary<internal::BinaryOp::kSubtract>(a.data(), b.data(), internal::OutputSpan(out, a.size()).data(), a.size());
+  }
+
+  // out[i] = lhs[i] * rhs[i], e.g. current * voltage -> power
+  template <typename Lhs, typename Rhs, typename Out>
+  inline void multiply(const Lhs &lhs, const Rhs &rhs, Out &&out)
+  {
+    typedef decltype(internal::RangeValue<Lhs>() * internal::RangeValue<Rhs>()) Product;
+    static_assert(std::is_same<Product, internal::RangeValue<Out>>::value, "multiply output unit must be the product of the input units");
+    static_assert(std::is_same<internal::RangeStorage<Lhs>, internal::RangeStorage<Rhs>>::value, "batch operands must share a storage type");
+
+    const auto a = raw_span(std::span(lhs));
+    const auto b = raw_span(std::span(rhs));
+    assert(a.size() == b.size() && "batch operands must have the same size");
+    const auto o = internal::OutputSpan(out, a.size());
+    internal::BatchBinary<internal::BinaryOp::kMultiply>(a.data(), b.data(), o.data(), a.size());
+    internal::RescaleCollapsed<Product, MultiplyDimensions(internal::DimensionOf<internal::RangeValue<Lhs>>::value, internal::DimensionOf<internal::RangeValue<Rhs>>::value)>(o.data(), o.size());
+  }
+
+  // out[i] = lhs[i] / rhs[i], e.g. length / time -> velocity
+  template <typename Lhs, typename Rhs, typename Out>
+  inline void divide(const Lhs &lhs, const Rhs &rhs, Out &&out)
+  {
+    typedef decltype(internal::RangeValue<Lhs>() / internal::RangeValue<Rhs>()) Quotient;
+    static_assert(std::is_same<Quotient, internal::RangeValue<Out>>::value, "divide output unit must be the quotient of the input units");
+    static_assert(std::is_same<internal::RangeStorage<Lhs>, internal::RangeStorage<Rhs>>::value, "batch operands must share a storage type");
+
+    const auto a = raw_span(std::span(lhs));
+    const auto b = raw_span(std::span(rhs));
+    assert(a.size() == b.size() && "batch operands must have the same size");
+    const auto o = internal::OutputSpan(out, a.size());
+    constexpr Dimension kQuotient = DivideDimensions(internal::DimensionOf<internal::RangeValue<Lhs>>::value, internal::DimensionOf<internal::RangeValue<Rhs>>::value);
+    if constexpr (!IsQuantity<Quotient>::value && std::is_integral<Quotient>::value && kQuotient.m_scaleNumerator != kQuotient.m_scaleDenominator)
+    {
+      // integer quotients take the scale before the truncating divide, like the scalar operator
+      for (std::size_t i = 0; i < a.size(); ++i)
+        o[i] = internal::Rescale<kQuotient.m_scaleNumerator, 1>(a[i]) / internal::Rescale<kQuotient.m_scaleDenominator, 1>(b[i]);
+    }
+    else
+    {
+      internal::BatchBinary<internal::BinaryOp::kDivide>(a.data(), b.data(), o.data(), a.size());
+      internal::RescaleCollapsed<Quotient, kQuotient>(o.data(), o.size());
+    }
+  }
+
+  // out[i] = in[i] * factor, where the factor is a scalar or a single unit value (e.g. velocities * dt -> lengths)
+  template <typename In, typename Factor, typename Out>
+  inline void scale(const In &in, const Factor factor, Out &&out)
+  {
+    static_assert(internal::IsBroadcastable<Factor>::value, "scale factor must be a single value");
+    typedef decltype(internal::RangeValue<In>() * Factor()) Product;
+    static_assert(std::is_same<Product, internal::RangeValue<Out>>::value, "scale output unit must be the product of the input unit and the factor");
+
+    typedef internal::RangeStorage<In> Storage;
+    const auto a = raw_span(std::span(in));
+    const auto o = internal::OutputSpan(out, a.size());
+    internal::BatchScale(a.data(), static_cast<Storage>(internal::RawValue(factor)), o.data(), a.size());
+    internal::RescaleCollapsed<Product, MultiplyDimensions(internal::DimensionOf<internal::RangeValue<In>>::value, internal::DimensionOf<Factor>::value)>(o.data(), o.size());
+  }
+
+  // out[i] = a[i] * b[i] + c[i], or a[i] * b + c[i] when b is a single value (e.g. positions = velocities * dt + positions)
+  // fused (single rounding) where the instruction set has FMA
+  template <typename A, typename B, typename C, typename Out>
+  inline void fma(const A &a, const B &b, const C &c, Out &&out)
+  {
+    constexpr bool kBroadcastB = internal::IsBroadcastable<B>::value;
+    typedef typename internal::OperandValue<B>::Type BValue;
+    typedef decltype(internal::RangeValue<A>() * BValue()) Product;
+    static_assert(std::is_same<Product, internal::RangeValue<C>>::value && std::is_same<Product, internal::RangeValue<Out>>::value, "fma addend and output units must be the product of the multiplied units");
+    static_assert(std::is_same<internal::RangeStorage<A>, typename StorageOf<BValue>::Type>::value, "batch operands must share a storage type");
+
+    typedef internal::RangeStorage<A> Storage;
+    const auto as = raw_span(std::span(a));
+    const auto cs = raw_span(std::span(c));
+    assert(as.size() == cs.size() && "batch operands must have the same size");
+    const auto os = internal::OutputSpan(out, as.size());
+    constexpr Dimension kProduct = MultiplyDimensions(internal::DimensionOf<internal::RangeValue<A>>::value, internal::DimensionOf<BValue>::value);
+    if constexpr (!IsQuantity<Product>::value && kProduct.m_scaleNumerator != kProduct.m_scaleDenominator)
+    {
+      // a scaled dimensionless product (e.g. kilometers * per-meter values) is rescaled before the addend, so it isn't fused
+      Storage bValue = Storage();
+      const Storage *bs = &bValue;
+      std::size_t bStride = 0;
+      if constexpr (kBroadcastB)
+      {
+        bValue = static_cast<Storage>(internal::RawValue(b));
+      }
+      else
+      {
+        bs = raw_span(std::span(b)).data();
+        bStride = 1;
+        assert(as.size() == raw_span(std::span(b)).size() && "batch operands must have the same size");
+      }
+      for (std::size_t i = 0; i < as.size(); ++i)
+        os[i] = internal::Rescale<kProduct.m_scaleNumerator, kProduct.m_scaleDenominator>(static_cast<Storage>(as[i] * bs[i * bStride])) + cs[i];
+    }
+    else if constexpr (kBroadcastB)
+    {
+      const Storage bValue = static_cast<Storage>(internal::RawValue(b));
+      internal::BatchMultiplyAdd<true>(as.data(), &bValue, cs.data(), os.data(), as.size());
+    }
+    else
+    {
+      const auto bs = raw_span(std::span(b));
+      assert(as.size() == bs.size() && "batch operands must have the same size");
+      internal::BatchMultiplyAdd<false>(as.data(), bs.data(), cs.data(), os.data(), as.size());
+    }
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: batch operations
+
+
+#endif
@@ -0,0 +1,252 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_DYNAMIC_H
+#define UNITS_DYNAMIC_H
+
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "units/units.h"
+
+
+// dynamic quantities
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // splitmix64 finalizer: spreads the FNV IDs of base dimensions over all 64 bits
+    constexpr std::uint64_t MixDimensionId(std::uint64_t id) noexcept
+    {
+      id = (id ^ (id >> 30)) * 0xbf58476d1ce4e5b9ull;
+      id = (id ^ (id >> 27)) * 0x94d049bb133111ebull;
+      return id ^ (id >> 31);
+    }
+
+    // numerator / denominator *= multiplier / divisor, reduced; false (and untouched) on overflow
+    constexpr bool MultiplyScale(long long &numerator, long long &denominator, const long long multiplier, const long long divisor) noexcept
+    {
+      const long long a = GreatestCommonDivisor(numerator, divisor);
+      const long long b = GreatestCommonDivisor(multiplier, denominator);
+      const long long lhsNumerator = numerator / a;
+      const long long rhsNumerator = multiplier / b;
+      const long long lhsDenominator = denominator / b;
+      const long long rhsDenominator = divisor / a;
+      if (lhsNumerator > std::numeric_limits<long long>::max() / rhsNumerator || lhsDenominator > std::numeric_limits<long long>::max() / rhsDenominator)
+        return false;
+
+      numerator = lhsNumerator * rhsNumerator;
+      denominator = lhsDenominator * rhsDenominator;
+      return true;
+    }
+  }
+
+  // the exponents of a dimension packed into one word: the sum of exponent * mix(base dimension ID), wrapping
+  // base dimensions are open-ended hashes rather than a fixed list, so exponents are packed along hashed directions instead of in fixed bit fields;
+  // the packing is linear, so multiplying dimensions adds fingerprints, dividing subtracts, and dimensionless is zero
+  // distinct dimensions collide only if a small integer combination of 64-bit hashes wraps to zero, which is as unlikely as a 64-bit hash collision
+  constexpr std::uint64_t DimensionFingerprint(const Dimension &dimension) noexcept
+  {
+    std::uint64_t fingerprint = 0;
+    for (int i = 0; i < kMaxBaseDimensions && dimension.m_ids[i]; ++i)
+      fingerprint += static_cast<std::uint64_t>(static_cast<long long>(dimension.m_exponents[i])) * internal::MixDimensionId(dimension.m_ids[i]);
+    return fingerprint;
+  }
+
+  // a double tagged with a dimension fingerprint & scale at runtime, for the untyped edges of a program (config files, scripts, plugin APIs)
+  //   units::DynamicQuantity speed = units::DynamicQuantity(config.distance, Kilometers::kDimension) / units::DynamicQuantity(config.time, Hours::kDimension);
+  //   Velocity velocity;
+  //   if (!speed.Get(velocity))
+  //     ...; // not a velocity
+  // dimension checks are one integer compare; arithmetic on mismatched dimensions yields an invalid quantity that stays invalid,
+  // so a whole expression is checked once where it is converted back to a static unit type
+  class DynamicQuantity
+  {
+    public:
+      // dimensionless zero
+      constexpr DynamicQuantity() noexcept : m_value(0.0), m_fingerprint(0), m_scaleNumerator(1), m_scaleDenominator(1) { }
+
+      // dimensionless number
+      constexpr explicit DynamicQuantity(const double value) noexcept : m_value(value), m_fingerprint(0), m_scaleNumerator(1), m_scaleDenominator(1) { }
+
+      // value in units of the given dimension & scale, e.g. DynamicQuantity(2.5, Kilometers::kDimension)
+      constexpr DynamicQuantity(const double value, const Dimension &dimension) noexcept
+        : m_value(value)
+        , m_fingerprint(DimensionFingerprint(dimension))
+        , m_scaleNumerator(dimension.m_scaleNumerator)
+        , m_scaleDenominator(dimension.m_scaleDenominator)
+      { }
+
+      constexpr DynamicQuantity(const double value, const std::uint64_t fingerprint, const long long scaleNumerator, const long long scaleDenominator) noexcept
+        : m_value(value)
+        , m_fingerprint(fingerprint)
+        , m_scaleNumerator(scaleNumerator)
+        , m_scaleDenominator(scaleDenominator)
+      { }
+
+      // from a static unit, keeping its scale
+      template <typename Storage, Dimension kDim>
+      constexpr DynamicQuantity(const Quantity<Storage, kDim> quantity) noexcept
+        : m_value(static_cast<double>(quantity.GetRaw()))
+        , m_fingerprint(std::integral_constant<std::uint64_t, DimensionFingerprint(kDim)>::value)
+        , m_scaleNumerator(kDim.m_scaleNumerator)
+        , m_scaleDenominator(kDim.m_scaleDenominator)
+      { }
+
+      // the result of mismatched arithmetic
+      static constexpr DynamicQuantity Invalid() noexcept { return DynamicQuantity(std::numeric_limits<double>::quiet_NaN(), 0, 1, 0); }
+
+      constexpr bool IsValid() const noexcept { return m_scaleDenominator != 0; }
+      constexpr bool IsDimensionless() const noexcept { return IsValid() && m_fingerprint == 0; }
+
+      // value in units of this quantity's scale
+      constexpr double GetValue() const noexcept { return m_value; }
+      constexpr std::uint64_t GetFingerprint() const noexcept { return m_fingerprint; }
+      constexpr long long GetScaleNumerator() const noexcept { return m_scaleNumerator; }
+      constexpr long long GetScaleDenominator() const noexcept { return m_scaleDenominator; }
+
+      // value in unscaled units (e.g. meters for a quantity in kilometers)
+      constexpr double GetUnscaledValue() const noexcept { return m_value * ScaleFactor(m_scaleNumerator, m_scaleDenominator, 1, 1); }
+
+      // same base dimensions, regardless of scale; never true for invalid quantities
+      constexpr bool HasSameDimension(const DynamicQuantity &other) const noexcept { return m_fingerprint == other.m_fingerprint && IsValid() && other.IsValid(); }
+
+      template <typename Unit>
+      constexpr bool Is() const noexcept
+      {
+        return m_fingerprint == UnitFingerprint<Unit>() && IsValid();
+      }
+
+      // the one check at the boundary: false, with the value untouched, unless the dimensions match
+      // the scale is converted (e.g. kilometers to Length in meters), rounding to nearest for integer storage
+      template <typename Unit>
+      bool Get(Unit &value) const noexcept
+      {
+        if (!Is<Unit>())
+          return false;
+
+        const double converted = m_value * ScaleFactor(m_scaleNumerator, m_scaleDenominator, UnitScale<Unit>().m_scaleNumerator, UnitScale<Unit>().m_scaleDenominator);
+        typedef typename StorageOf<Unit>::Type Storage;
+        const Storage raw = std::is_integral<Storage>::value ? static_cast<Storage>(std::llround(converted)) : static_cast<Storage>(converted);
+        if constexpr (IsQuantity<Unit>::value)
+          value = Unit::From(raw);
+        else
+          value = raw;
+        return true;
+      }
+
+      // mismatched dimensions -> invalid; the result keeps the left-hand scale
+      DynamicQuantity operator+(const DynamicQuantity &rhs) const noexcept
+      {
+        return HasSameDimension(rhs) ? WithValue(m_value + rhs.ValueIn(m_scaleNumerator, m_scaleDenominator)) : Invalid();
+      }
+      DynamicQuantity operator-(const DynamicQuantity &rhs) const noexcept
+      {
+        return HasSameDimension(rhs) ? WithValue(m_value - rhs.ValueIn(m_scaleNumerator, m_scaleDenominator)) : Invalid();
+      }
+      DynamicQuantity operator+() const noexcept { return *this; }
+      DynamicQuantity operator-() const noexcept { return WithValue(-m_value); }
+      DynamicQuantity &operator+=(const DynamicQuantity &rhs) noexcept { return *this = *this + rhs; }
+      DynamicQuantity &operator-=(const DynamicQuantity &rhs) noexcept { return *this = *this - rhs; }
+
+      // fingerprints add & subtract; scales multiply, folded into the value if they would overflow
+      DynamicQuantity operator*(const DynamicQuantity &rhs) const noexcept { return Combine(rhs, m_value * rhs.m_value, rhs.m_fingerprint, rhs.m_scaleNumerator, rhs.m_scaleDenominator); }
+      DynamicQuantity operator/(const DynamicQuantity &rhs) const noexcept { return Combine(rhs, m_value / rhs.m_value, 0 - rhs.m_fingerprint, rhs.m_scaleDenominator, rhs.m_scaleNumerator); }
+      DynamicQuantity &operator*=(const DynamicQuantity &rhs) noexcept { return *this = *this * rhs; }
+      DynamicQuantity &operator/=(const DynamicQuantity &rhs) noexcept { return *this = *this / rhs; }
+
+      DynamicQuantity operator*(const double rhs) const noexcept { return WithValue(m_value * rhs); }
+      DynamicQuantity operator/(const double rhs) const noexcept { return WithValue(m_value / rhs); }
+      DynamicQuantity &operator*=(const double rhs) noexcept { m_value *= rhs; return *this; }
+      DynamicQuantity &operator/=(const double rhs) noexcept { m_value /= rhs; return *this; }
+
+      // false for mismatched dimensions or invalid quantities (except !=, which is their negation)
+      bool operator==(const DynamicQuantity &rhs) const noexcept { return HasSameDimension(rhs) && m_value == rhs.ValueIn(m_scaleNumerator, m_scaleDenominator); }
+      bool operator!=(const DynamicQuantity &rhs) const noexcept { return !(*this == rhs); }
+      bool operator<(const DynamicQuantity &rhs) const noexcept { return HasSameDimension(rhs) && m_value < rhs.ValueIn(m_scaleNumerator, m_scaleDenominator); }
+      bool operator<=(const DynamicQuantity &rhs) const noexcept { return HasSameDimension(rhs) && m_value <= rhs.ValueIn(m_scaleNumerator, m_scaleDenominator); }
+      bool operator>(const DynamicQuantity &rhs) const noexcept { return HasSameDimension(rhs) && m_value > rhs.ValueIn(m_scaleNumerator, m_scaleDenominator); }
+      bool operator>=(const DynamicQuantity &rhs) const noexcept { return HasSameDimension(rhs) && m_value >= rhs.ValueIn(m_scaleNumerator, m_scaleDenominator); }
+
+    private:
+      // plain numbers convert from and to dimensionless quantities
+      template <typename Unit, typename = void> struct StorageOf { typedef Unit Type; };
+      template <typename Unit> struct StorageOf<Unit, typename std::enable_if<IsQuantity<Unit>::value>::type> { typedef typename Unit::Storage Type; };
+
+      template <typename Unit>
+      static constexpr std::uint64_t UnitFingerprint() noexcept
+      {
+        static_assert(IsQuantity<Unit>::value || std::is_arithmetic<Unit>::value, "dynamic quantities convert to unit types or plain numbers");
+        if constexpr (IsQuantity<Unit>::value)
+          return std::integral_constant<std::uint64_t, DimensionFingerprint(Unit::kDimension)>::value;
+        else
+          return 0;
+      }
+
+      template <typename Unit>
+      static constexpr Dimension UnitScale() noexcept
+      {
+        if constexpr (IsQuantity<Unit>::value)
+          return Unit::kDimension;
+        else
+          return Dimension{ };
+      }
+
+      // (fromNumerator / fromDenominator) / (toNumerator / toDenominator), exactly one for equal scales
+      static constexpr double ScaleFactor(const long long fromNumerator, const long long fromDenominator, const long long toNumerator, const long long toDenominator) noexcept
+      {
+        if (fromNumerator == toNumerator && fromDenominator == toDenominator)
+          return 1.0;
+        return static_cast<double>((static_cast<long double>(fromNumerator) * static_cast<long double>(toDenominator)) / (static_cast<long double>(fromDenominator) * static_cast<long double>(toNumerator)));
+      }
+
+      constexpr double ValueIn(const long long scaleNumerator, const long long scaleDenominator) const noexcept
+      {
+        return m_value * ScaleFactor(m_scaleNumerator, m_scaleDenominator, scaleNumerator, scaleDenominator);
+      }
+
+      constexpr DynamicQuantity WithValue(const double value) const noexcept
+      {
+        return DynamicQuantity(value, m_fingerprint, m_scaleNumerator, m_scaleDenominator);
+      }
+
+      DynamicQuantity Combine(const DynamicQuantity &rhs, double value, const std::uint64_t rhsFingerprint, const long long rhsScaleNumerator, const long long rhsScaleDenominator) const noexcept
+      {
+        if (!IsValid() || !rhs.IsValid())
+          return Invalid();
+
+        long long scaleNumerator = m_scaleNumerator;
+        long long scaleDenominator = m_scaleDenominator;
+        if (!internal::MultiplyScale(scaleNumerator, scaleDenominator, rhsScaleNumerator, rhsScaleDenominator))
+        {
+          value *= ScaleFactor(m_scaleNumerator, m_scaleDenominator, 1, 1) * ScaleFactor(rhsScaleNumerator, rhsScaleDenominator, 1, 1);
+          scaleNumerator = 1;
+          scaleDenominator = 1;
+        }
+        return DynamicQuantity(value, m_fingerprint + rhsFingerprint, scaleNumerator, scaleDenominator);
+      }
+
+      double m_value;
+      std::uint64_t m_fingerprint;
+      long long m_scaleNumerator;
+      long long m_scaleDenominator; // zero for invalid quantities
+  };
+
+  inline DynamicQuantity operator*(const double lhs, const DynamicQuantity &rhs) noexcept { return rhs * lhs; }
+  inline DynamicQuantity operator/(const double lhs, const DynamicQuantity &rhs) noexcept { return DynamicQuantity(lhs) / rhs; }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: dynamic quantities
+
+
+#endif
@@ -0,0 +1,254 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_EXPR_H
+#define UNITS_EXPR_H
+
+
+#include "units/batch.h"
+#include "units/pack.h"
+
+
+// expression nodes
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // every node exposes the unit of its elements, the raw storage they are computed in,
+    // a single element (for tails) and a pack of consecutive elements (for the vectorized body)
+
+    template <typename UnitType, bool kWritable>
+    struct TerminalNode
+    {
+      typedef UnitType Unit;
+      typedef typename StorageOf<Unit>::Type Storage;
+      typedef typename std::conditional<kWritable, Storage, const Storage>::type Element;
+
+      Element *m_data;
+      std::size_t m_size;
+
+      Storage Lane(const std::size_t i) const { return m_data[i]; }
+      template <int kLanes> Pack<Storage, kLanes> Lanes(const std::size_t i) const { return Pack<Storage, kLanes>::Load(m_data + i); }
+      bool Matches(const std::size_t size) const { return m_size == size; }
+    };
+
+    // single value broadcast to every element (scalar factor, or a unit like a time step)
+    template <typename UnitType, typename StorageType>
+    struct ConstantNode
+    {
+      typedef UnitType Unit;
+      typedef StorageType Storage;
+
+      Storage m_value;
+
+      Storage Lane(const std::size_t) const { return m_value; }
+      template <int kLanes> Pack<Storage, kLanes> Lanes(const std::size_t) const { return Pack<Storage, kLanes>(m_value); }
+      bool Matches(const std::size_t) const { return true; }
+    };
+
+    template <BinaryOp kOp, typename LhsUnit, typename RhsUnit>
+    struct BinaryResult;
+    template <typename LhsUnit, typename RhsUnit> struct BinaryResult<BinaryOp::kAdd, LhsUnit, RhsUnit> { typedef decltype(LhsUnit() + RhsUnit()) Unit; };
+    template <typename LhsUnit, typename RhsUnit> struct BinaryResult<BinaryOp::kSubtract, LhsUnit, RhsUnit> { typedef decltype(LhsUnit() - RhsUnit()) Unit; };
+    template <typename LhsUnit, typename RhsUnit> struct BinaryResult<BinaryOp::kMultiply, LhsUnit, RhsUnit> { typedef decltype(LhsUnit() * RhsUnit()) Unit; };
+    template <typename LhsUnit, typename RhsUnit> struct BinaryResult<BinaryOp::kDivide, LhsUnit, RhsUnit> { typedef decltype(LhsUnit() / RhsUnit()) Unit; };
+
+    template <BinaryOp kOp, typename LhsNode, typename RhsNode>
+    struct BinaryNode
+    {
+      static_assert(std::is_same<typename LhsNode::Storage, typename RhsNode::Storage>::value, "expression operands must share a storage type");
+
+      // fails to compile on dimension mismatch, e.g. length + time
+      typedef typename BinaryResult<kOp, typename LhsNode::Unit, typename RhsNode::Unit>::Unit Unit;
+      typedef typename LhsNode::Storage Storage;
+
+      // sums bring the rhs into the lhs scale (e.g. kilometers + meters), like the converting constructor does;
+      // products & quotients keep the combined scale in the result unit, unless it collapses to a dimensionless raw value
+      static constexpr bool kIsSum = kOp == BinaryOp::kAdd || kOp == BinaryOp::kSubtract;
+      static constexpr Dimension kRhsScale = kIsSum ? DivideDimensions(DimensionOf<typename RhsNode::Unit>::value, DimensionOf<typename LhsNode::Unit>::value) : Dimension{ };
+      static constexpr Dimension kResultScale =
+        (kIsSum || IsQuantity<Unit>::value) ? Dimension{ }
+        : (kOp == BinaryOp::kMultiply) ? MultiplyDimensions(DimensionOf<typename LhsNode::Unit>::value, DimensionOf<typename RhsNode::Unit>::value)
+        : DivideDimensions(DimensionOf<typename LhsNode::Unit>::value, DimensionOf<typename RhsNode::Unit>::value);
+
+      LhsNode m_lhs;
+      RhsNode m_rhs;
+
+      Storage Lane(const std::size_t i) const { return Apply(m_lhs.Lane(i), m_rhs.Lane(i)); }
+      template <int kLanes> Pack<Storage, kLanes> Lanes(const std::size_t i) const { return Apply(m_lhs.template Lanes<kLanes>(i), m_rhs.template Lanes<kLanes>(i)); }
+      bool Matches(const std::size_t size) const { return m_lhs.Matches(size) && m_rhs.Matches(size); }
+
+      // unit scales are whole factors or folded at compile time, and vanish entirely when they are one
+      template <typename V>
+      static V Apply(const V lhs, const V rhs)
+      {
+        if constexpr (kOp == BinaryOp::kDivide && std::is_integral<Storage>::value)
+          return ApplyScalar<kOp>(Rescale<kResultScale.m_scaleNumerator, 1>(lhs), Rescale<kResultScale.m_scaleDenominator, 1>(rhs)); // scaled before the truncating divide
+        else
+          return Rescale<kResultScale.m_scaleNumerator, kResultScale.m_scaleDenominator>(ApplyScalar<kOp>(lhs, Rescale<kRhsScale.m_scaleNumerator, kRhsScale.m_scaleDenominator>(rhs)));
+      }
+    };
+
+    template <typename Node>
+    struct NegateNode
+    {
+      typedef typename Node::Unit Unit;
+      typedef typename Node::Storage Storage;
+
+      Node m_node;
+
+      Storage Lane(const std::size_t i) const { return -m_node.Lane(i); }
+      template <int kLanes> Pack<Storage, kLanes> Lanes(const std::size_t i) const { return -m_node.template Lanes<kLanes>(i); }
+      bool Matches(const std::size_t size) const { return m_node.Matches(size); }
+    };
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: expression nodes
+
+
+// array expressions
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // lazily evaluated, dimension-checked expression over unit arrays; nothing is computed until it is assigned to a writable array,
+  // which then evaluates the whole tree in one pass, a register of elements at a time, without temporaries, e.g.
+  //   units::lazy(positions) = units::lazy(positions) + units::lazy(velocities) * dt + 0.5f * units::lazy(accelerations) * dt * dt;
+  template <typename Node>
+  class ArrayExpr
+  {
+    public:
+      typedef typename Node::Unit Unit;
+      typedef typename Node::Storage Storage;
+
+      // elements per vectorized step: one AVX register's worth
+      static const int kLanes = (sizeof(Storage) < 32) ? int(32 / sizeof(Storage)) : 1;
+
+      explicit ArrayExpr(const Node &node) : m_node(node) { }
+      ArrayExpr(const ArrayExpr &rhs) = default;
+
+      const Node &GetNode() const { return m_node; }
+
+      // evaluation on assignment, only for writable arrays
+      template <typename RhsNode>
+      ArrayExpr &operator=(const ArrayExpr<RhsNode> &rhs)
+      {
+        Evaluate(rhs.GetNode());
+        return *this;
+      }
+
+      ArrayExpr &operator=(const ArrayExpr &rhs)
+      {
+        Evaluate(rhs.GetNode());
+        return *this;
+      }
+
+    private:
+      template <typename RhsNode>
+      void Evaluate(const RhsNode &rhs)
+      {
+        static_assert(std::is_same<Node, internal::TerminalNode<Unit, true>>::value, "only writable arrays can be assigned to");
+        static_assert(std::is_same<Unit, typename RhsNode::Unit>::value, "expression unit does not match the assigned array's unit");
+        static_assert(std::is_same<Storage, typename RhsNode::Storage>::value, "expression storage does not match the assigned array's storage");
+        assert(rhs.Matches(m_node.m_size) && "expression operands must have the same size");
+
+        Storage *out = m_node.m_data;
+        const std::size_t n = m_node.m_size;
+        std::size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes)
+          rhs.template Lanes<kLanes>(i).Store(out + i);
+        for (; i < n; ++i)
+          out[i] = rhs.Lane(i);
+      }
+
+      Node m_node;
+  };
+
+  template <typename T> struct IsArrayExpr : std::false_type { };
+  template <typename Node> struct IsArrayExpr<ArrayExpr<Node>> : std::true_type { };
+
+  // wraps any contiguous range of units (or raw values) as an expression operand; writable if the range is
+  template <typename Range>
+  inline auto lazy(Range &&range)
+  {
+    const auto raw = raw_span(std::span(range));
+    typedef internal::RangeValue<Range> Unit;
+    typedef typename StorageOf<Unit>::Type Storage;
+    static_assert(std::is_arithmetic<Storage>::value, "array expressions require scalar storage");
+
+    typedef internal::TerminalNode<Unit, !std::is_const<internal::RangeElement<Range>>::value> Node;
+    return ArrayExpr<Node>(Node{ raw.data(), raw.size() });
+  }
+
+  namespace internal
+  {
+    // node for an expression operand, or a broadcast constant for a single value in the other operand's storage
+    template <typename T, typename Storage>
+    inline auto ToNode(const T &operand)
+    {
+      if constexpr (IsArrayExpr<T>::value)
+        return operand.GetNode();
+      else if constexpr (IsQuantity<T>::value)
+        return ConstantNode<T, Storage>{ static_cast<Storage>(operand.GetRaw()) };
+      else
+        return ConstantNode<Storage, Storage>{ static_cast<Storage>(operand) };
+    }
+
+    template <typename T, typename = void> struct ExprStorage { typedef void Type; };
+    template <typename Node> struct ExprStorage<ArrayExpr<Node>> { typedef typename Node::Storage Type; };
+
+    template <BinaryOp kOp, typename Lhs, typename Rhs>
+    inline auto MakeBinaryExpr(const Lhs &lhs, const Rhs &rhs)
+    {
+      typedef typename std::conditional<IsArrayExpr<Lhs>::value, typename ExprStorage<Lhs>::Type, typename ExprStorage<Rhs>::Type>::type Storage;
+      typedef decltype(ToNode<Lhs, Storage>(lhs)) LhsNode;
+      typedef decltype(ToNode<Rhs, Storage>(rhs)) RhsNode;
+      typedef BinaryNode<kOp, LhsNode, RhsNode> Node;
+      return ArrayExpr<Node>(Node{ ToNode<Lhs, Storage>(lhs), ToNode<Rhs, Storage>(rhs) });
+    }
+
+    // at least one side must be an array expression, the other may be a single unit or scalar value
+    template <typename Lhs, typename Rhs>
+    struct IsExprOperands
+      : std::integral_constant
+        <
+          bool,
+          (IsArrayExpr<Lhs>::value && (IsArrayExpr<Rhs>::value || IsBroadcastable<Rhs>::value))
+          || (IsBroadcastable<Lhs>::value && IsArrayExpr<Rhs>::value)
+        >
+    { };
+  }
+
+  template <typename Lhs, typename Rhs, typename = typename std::enable_if<internal::IsExprOperands<Lhs, Rhs>::value>::type>
+  inline auto operator+(const Lhs &lhs, const Rhs &rhs) { return internal::MakeBinaryExpr<internal::BinaryOp::kAdd>(lhs, rhs); }
+
+  template <typename Lhs, typename Rhs, typename = typename std::enable_if<internal::IsExprOperands<Lhs, Rhs>::value>::type>
+  inline auto operator-(const Lhs &lhs, const Rhs &rhs) { return internal::MakeBinaryExpr<internal::BinaryOp::kSubtract>(lhs, rhs); }
+
+  template <typename Lhs, typename Rhs, typename = typename std::enable_if<internal::IsExprOperands<Lhs, Rhs>::value>::type>
+  inline auto operator*(const Lhs &lhs, const Rhs &rhs) { return internal::MakeBinaryExpr<internal::BinaryOp::kMultiply>(lhs, rhs); }
+
+  template <typename Lhs, typename Rhs, typename = typename std::enable_if<internal::IsExprOperands<Lhs, Rhs>::value>::type>
+  inline auto operator/(const Lhs &lhs, const Rhs &rhs) { return internal::MakeBinaryExpr<internal::BinaryOp::kDivide>(lhs, rhs); }
+
+  template <typename Node>
+  inline auto operator-(const ArrayExpr<Node> &expr)
+  {
+    return ArrayExpr<internal::NegateNode<Node>>(internal::NegateNode<Node>{ expr.GetNode() });
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: array expressions
+
+
+#endif
@@ -0,0 +1,394 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_FIXED_H
+#define UNITS_FIXED_H
+
+
+#include <cstdint>
+#include <limits>
+
+#include "units/units.h"
+
+
+// wide integer arithmetic
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // 128-bit two's complement intermediate for 64-bit fixed-point products and quotients
+    // multiplication & division use __int128 where the compiler has it, portable limb arithmetic otherwise (e.g. MSVC)
+    struct Wide128
+    {
+      std::uint64_t m_lo;
+      std::uint64_t m_hi;
+    };
+
+    constexpr Wide128 WideFromInt64(const std::int64_t value)
+    {
+      return Wide128{ static_cast<std::uint64_t>(value), value < 0 ? ~std::uint64_t(0) : 0 };
+    }
+
+    constexpr bool WideIsNegative(const Wide128 value) { return (value.m_hi >> 63) != 0; }
+
+    constexpr Wide128 WideNegate(const Wide128 value)
+    {
+      const std::uint64_t lo = ~value.m_lo + 1;
+      return Wide128{ lo, ~value.m_hi + (lo == 0 ? 1 : 0) };
+    }
+
+    constexpr Wide128 WideAdd(const Wide128 lhs, const Wide128 rhs)
+    {
+      const std::uint64_t lo = lhs.m_lo + rhs.m_lo;
+      return Wide128{ lo, lhs.m_hi + rhs.m_hi + (lo < lhs.m_lo ? 1 : 0) };
+    }
+
+    constexpr Wide128 WideMultiplyUnsigned(const std::uint64_t lhs, const std::uint64_t rhs)
+    {
+      const std::uint64_t a = lhs & 0xffffffffu, b = lhs >> 32;
+      const std::uint64_t c = rhs & 0xffffffffu, d = rhs >> 32;
+      const std::uint64_t ac = a * c, ad = a * d, bc = b * c, bd = b * d;
+      const std::uint64_t mid = (ac >> 32) + (ad & 0xffffffffu) + (bc & 0xffffffffu);
+      return Wide128{ (mid << 32) | (ac & 0xffffffffu), bd + (ad >> 32) + (bc >> 32) + (mid >> 32) };
+    }
+
+    constexpr Wide128 WideMultiply(const std::int64_t lhs, const std::int64_t rhs)
+    {
+#if defined(__SIZEOF_INT128__)
+      const __int128 product = static_cast<__int128>(lhs) * rhs;
+      return Wide128{ static_cast<std::uint64_t>(product), static_cast<std::uint64_t>(product >> 64) };
+#else
+      const bool negative = (lhs < 0) != (rhs < 0);
+      const std::uint64_t a = lhs < 0 ? ~static_cast<std::uint64_t>(lhs) + 1 : static_cast<std::uint64_t>(lhs);
+      const std::uint64_t b = rhs < 0 ? ~static_cast<std::uint64_t>(rhs) + 1 : static_cast<std::uint64_t>(rhs);
+      const Wide128 product = WideMultiplyUnsigned(a, b);
+      return negative ? WideNegate(product) : product;
+#endif
+    }
+
+    // arithmetic shifts, 0 < shift < 64
+    constexpr Wide128 WideShiftRight(const Wide128 value, const int shift)
+    {
+      return Wide128{ (value.m_lo >> shift) | (value.m_hi << (64 - shift)), static_cast<std::uint64_t>(static_cast<std::int64_t>(value.m_hi) >> shift) };
+    }
+
+    constexpr Wide128 WideShiftLeft(const Wide128 value, const int shift)
+    {
+      return Wide128{ value.m_lo << shift, (value.m_hi << shift) | (value.m_lo >> (64 - shift)) };
+    }
+
+    // truncating signed division, divisor != 0
+    constexpr Wide128 WideDivide(const Wide128 lhs, const std::int64_t rhs)
+    {
+#if defined(__SIZEOF_INT128__)
+      const __int128 quotient = static_cast<__int128>((static_cast<unsigned __int128>(lhs.m_hi) << 64) | lhs.m_lo) / rhs;
+      return Wide128{ static_cast<std::uint64_t>(quotient), static_cast<std::uint64_t>(quotient >> 64) };
+#else
+      const bool negative = WideIsNegative(lhs) != (rhs < 0);
+      const Wide128 n = WideIsNegative(lhs) ? WideNegate(lhs) : lhs;
+      const std::uint64_t d = rhs < 0 ? ~static_cast<std::uint64_t>(rhs) + 1 : static_cast<std::uint64_t>(rhs);
+
+      // restoring long division, one quotient bit per step
+      Wide128 quotient = { 0, 0 };
+      std::uint64_t remainder = 0;
+      for (int bit = 127; bit >= 0; --bit)
+      {
+        const bool carry = (remainder >> 63) != 0;
+        const std::uint64_t word = bit >= 64 ? n.m_hi : n.m_lo;
+        remainder = (remainder << 1) | ((word >> (bit & 63)) & 1);
+        if (carry || remainder >= d)
+        {
+          remainder -= d;
+          if (bit >= 64)
+            quotient.m_hi |= std::uint64_t(1) << (bit - 64);
+          else
+            quotient.m_lo |= std::uint64_t(1) << bit;
+        }
+      }
+      return negative ? WideNegate(quotient) : quotient;
+#endif
+    }
+
+    constexpr bool WideFitsInt64(const Wide128 value)
+    {
+      return value.m_hi == (static_cast<std::int64_t>(value.m_lo) < 0 ? ~std::uint64_t(0) : 0);
+    }
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: wide integer arithmetic
+
+
+// fixed-point numbers
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // what happens when a result does not fit the raw integer
+  enum class Overflow
+  {
+    kWrap,     // two's complement wrap-around, like unsigned integer arithmetic
+    kSaturate, // clamp to the largest / lowest representable value
+  };
+
+  // signed fixed-point number with kFractionBits fractional bits, usable as a unit storage type, e.g.
+  //   MAKE_UNIT_VARIANT(FixedLength, units::Q16_16, _fm, Length);
+  // all arithmetic is integer-only and bit-identical across machines; float conversions (literals, From, To)
+  // round to nearest and saturate under both overflow policies, and division by zero saturates by the dividend's sign
+  template <int kFractionBits, typename RawType = std::int32_t, Overflow kOverflow = Overflow::kWrap>
+  class Fixed
+  {
+    static_assert(std::is_integral<RawType>::value && std::is_signed<RawType>::value && sizeof(RawType) <= 8, "fixed-point raw type must be a signed integer of up to 64 bits");
+    static_assert(kFractionBits > 0 && kFractionBits < int(8 * sizeof(RawType)) - 1, "fixed-point needs at least one fractional and one integer bit");
+
+    public:
+      typedef RawType Raw;
+      static const int kNumFractionBits = kFractionBits;
+      static const Overflow kOverflowPolicy = kOverflow;
+
+      static constexpr Raw kRawMax = std::numeric_limits<Raw>::max();
+      static constexpr Raw kRawMin = std::numeric_limits<Raw>::min();
+      static constexpr Raw kRawOne = Raw(1) << kFractionBits;
+
+      Fixed() = default;
+
+      static constexpr Fixed FromRaw(const Raw raw) noexcept { Fixed result; result.m_raw = raw; return result; }
+      constexpr Raw GetRaw() const noexcept { return m_raw; }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      constexpr explicit Fixed(const V value) noexcept : m_raw(Convert(value)) { }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      constexpr explicit operator V() const noexcept
+      {
+        if constexpr (std::is_floating_point<V>::value)
+          return static_cast<V>(m_raw) / static_cast<V>(kRawOne);
+        else
+          return static_cast<V>(m_raw / kRawOne); // truncate toward zero, like float to int casts
+      }
+
+      constexpr Fixed operator+() const noexcept { return *this; }
+      constexpr Fixed operator-() const noexcept { return FromRaw(Negate(m_raw)); }
+
+      friend constexpr Fixed operator+(const Fixed lhs, const Fixed rhs) noexcept { return FromRaw(Add(lhs.m_raw, rhs.m_raw)); }
+      friend constexpr Fixed operator-(const Fixed lhs, const Fixed rhs) noexcept { return FromRaw(Add(lhs.m_raw, Negate(rhs.m_raw))); }
+      friend constexpr Fixed operator*(const Fixed lhs, const Fixed rhs) noexcept { return FromRaw(MultiplyShift(lhs.m_raw, rhs.m_raw, kFractionBits)); }
+      friend constexpr Fixed operator/(const Fixed lhs, const Fixed rhs) noexcept { return FromRaw(ShiftDivide(lhs.m_raw, rhs.m_raw, kFractionBits)); }
+
+      // integral factors scale the raw value exactly; floating factors are converted to fixed point first
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Fixed operator*(const Fixed lhs, const V rhs) noexcept
+      {
+        if constexpr (std::is_integral<V>::value)
+          return FromRaw(MultiplyShift(lhs.m_raw, FactorToRaw(rhs), 0));
+        else
+          return lhs * Fixed(rhs);
+      }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Fixed operator*(const V lhs, const Fixed rhs) noexcept { return rhs * lhs; }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Fixed operator/(const Fixed lhs, const V rhs) noexcept
+      {
+        if constexpr (std::is_integral<V>::value)
+          return FromRaw(ShiftDivide(lhs.m_raw, ClampToRaw(rhs), 0));
+        else
+          return lhs / Fixed(rhs);
+      }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Fixed operator/(const V lhs, const Fixed rhs) noexcept { return Fixed(lhs) / rhs; }
+
+      constexpr Fixed &operator+=(const Fixed rhs) noexcept { return *this = *this + rhs; }
+      constexpr Fixed &operator-=(const Fixed rhs) noexcept { return *this = *this - rhs; }
+      constexpr Fixed &operator*=(const Fixed rhs) noexcept { return *this = *this * rhs; }
+      constexpr Fixed &operator/=(const Fixed rhs) noexcept { return *this = *this / rhs; }
+
+      friend constexpr bool operator==(const Fixed lhs, const Fixed rhs) noexcept { return lhs.m_raw == rhs.m_raw; }
+      friend constexpr bool operator!=(const Fixed lhs, const Fixed rhs) noexcept { return lhs.m_raw != rhs.m_raw; }
+      friend constexpr bool operator<(const Fixed lhs, const Fixed rhs) noexcept { return lhs.m_raw < rhs.m_raw; }
+      friend constexpr bool operator<=(const Fixed lhs, const Fixed rhs) noexcept { return lhs.m_raw <= rhs.m_raw; }
+      friend constexpr bool operator>(const Fixed lhs, const Fixed rhs) noexcept { return lhs.m_raw > rhs.m_raw; }
+      friend constexpr bool operator>=(const Fixed lhs, const Fixed rhs) noexcept { return lhs.m_raw >= rhs.m_raw; }
+
+    private:
+      typedef typename std::make_unsigned<Raw>::type Unsigned;
+
+      static constexpr Raw Wrap(const Unsigned value) noexcept { return static_cast<Raw>(value); } // modular since C++20
+
+      static constexpr Raw Add(const Raw lhs, const Raw rhs) noexcept
+      {
+        const Raw result = Wrap(static_cast<Unsigned>(lhs) + static_cast<Unsigned>(rhs));
+        if constexpr (kOverflow == Overflow::kSaturate)
+        {
+          if (((lhs ^ result) & (rhs ^ result)) < 0) // both operands' signs differ from the result's
+            return lhs < 0 ? kRawMin : kRawMax;
+        }
+        return result;
+      }
+
+      static constexpr Raw Negate(const Raw value) noexcept
+      {
+        if constexpr (kOverflow == Overflow::kSaturate)
+        {
+          if (value == kRawMin)
+            return kRawMax;
+        }
+        return Wrap(Unsigned(0) - static_cast<Unsigned>(value));
+      }
+
+      template <typename V>
+      static constexpr Raw ClampToRaw(const V value) noexcept
+      {
+        if constexpr (sizeof(V) > sizeof(Raw) || (std::is_unsigned<V>::value && sizeof(V) == sizeof(Raw)))
+        {
+          if (value > V(kRawMax))
+            return kRawMax;
+          if constexpr (std::is_signed<V>::value)
+          {
+            if (value < V(kRawMin))
+              return kRawMin;
+          }
+        }
+        return static_cast<Raw>(value);
+      }
+
+      // integral factor of a product: wrapping keeps the product exact modulo 2^N, saturating saturates the product as well
+      template <typename V>
+      static constexpr Raw FactorToRaw(const V value) noexcept
+      {
+        if constexpr (kOverflow == Overflow::kWrap)
+          return static_cast<Raw>(value); // modular since C++20
+        else
+          return ClampToRaw(value);
+      }
+
+      template <typename V>
+      static constexpr Raw Convert(const V value) noexcept
+      {
+        if constexpr (std::is_floating_point<V>::value)
+        {
+          // every step is exact in the value's own type (scaling by a power of two, truncation, and the fraction left over),
+          // so rounding is bit-identical whatever precision long double or the FPU has
+          const V scaled = value * static_cast<V>(kRawOne);
+          if (!(scaled == scaled)) return 0; // NaN
+          if (scaled >= static_cast<V>(kRawMax)) return kRawMax;
+          if (scaled <= static_cast<V>(kRawMin)) return kRawMin;
+          const Raw whole = static_cast<Raw>(scaled);
+          const V fraction = scaled - static_cast<V>(whole);
+          return static_cast<Raw>(whole + (fraction >= V(0.5)) - (fraction <= V(-0.5))); // round half away from zero
+        }
+        else
+        {
+          return MultiplyShift(ClampToRaw(value), kRawOne, 0);
+        }
+      }
+
+      // (lhs * rhs) >> shift with rounding to nearest, and (lhs << shift) / rhs, through a double-width intermediate
+      static constexpr Raw MultiplyShift(const Raw lhs, const Raw rhs, const int shift) noexcept
+      {
+        if constexpr (sizeof(Raw) <= 4)
+        {
+          std::int64_t product = std::int64_t(lhs) * std::int64_t(rhs);
+          if (shift)
+            product = (product + (std::int64_t(1) << (shift - 1))) >> shift;
+          return Narrow(product > std::int64_t(kRawMax), product < std::int64_t(kRawMin), static_cast<std::uint64_t>(product));
+        }
+        else
+        {
+          internal::Wide128 product = internal::WideMultiply(lhs, rhs);
+          if (shift)
+            product = internal::WideShiftRight(internal::WideAdd(product, internal::WideFromInt64(std::int64_t(1) << (shift - 1))), shift);
+          const bool fits = internal::WideFitsInt64(product);
+          return Narrow(!fits && !internal::WideIsNegative(product), !fits && internal::WideIsNegative(product), product.m_lo);
+        }
+      }
+
+      static constexpr Raw ShiftDivide(const Raw lhs, const Raw rhs, const int shift) noexcept
+      {
+        if (rhs == 0)
+          return lhs > 0 ? kRawMax : (lhs < 0 ? kRawMin : 0);
+
+        if constexpr (sizeof(Raw) <= 4)
+        {
+          const std::int64_t quotient = (std::int64_t(lhs) << shift) / std::int64_t(rhs);
+          return Narrow(quotient > std::int64_t(kRawMax), quotient < std::int64_t(kRawMin), static_cast<std::uint64_t>(quotient));
+        }
+        else
+        {
+          internal::Wide128 numerator = internal::WideFromInt64(lhs);
+          if (shift)
+            numerator = internal::WideShiftLeft(numerator, shift);
+          const internal::Wide128 quotient = internal::WideDivide(numerator, rhs);
+          const bool fits = internal::WideFitsInt64(quotient);
+          return Narrow(!fits && !internal::WideIsNegative(quotient), !fits && internal::WideIsNegative(quotient), quotient.m_lo);
+        }
+      }
+
+      static constexpr Raw Narrow(const bool above, const bool below, const std::uint64_t bits) noexcept
+      {
+        if constexpr (kOverflow == Overflow::kSaturate)
+        {
+          if (above) return kRawMax;
+          if (below) return kRawMin;
+        }
+        return Wrap(static_cast<Unsigned>(bits));
+      }
+
+      Raw m_raw;
+  };
+
+  typedef Fixed<16, std::int32_t> Q16_16;
+  typedef Fixed<32, std::int64_t> Q32_32;
+  typedef Fixed<16, std::int32_t, Overflow::kSaturate> Q16_16Saturated;
+  typedef Fixed<32, std::int64_t, Overflow::kSaturate> Q32_32Saturated;
+}
+
+namespace std
+{
+  // lets Quantity::PosInfinity & NegInfinity map to the raw integer extremes
+  template <int kFractionBits, typename RawType, units::Overflow kOverflow>
+  class numeric_limits<units::Fixed<kFractionBits, RawType, kOverflow>>
+  {
+    public:
+      typedef units::Fixed<kFractionBits, RawType, kOverflow> Type;
+      static constexpr bool is_specialized = true;
+      static constexpr bool is_signed = true;
+      static constexpr bool is_integer = false;
+      static constexpr bool is_exact = true;
+      static constexpr int digits = numeric_limits<RawType>::digits;
+      static constexpr Type max() noexcept { return Type::FromRaw(numeric_limits<RawType>::max()); }
+      static constexpr Type lowest() noexcept { return Type::FromRaw(numeric_limits<RawType>::min()); }
+      static constexpr Type min() noexcept { return Type::FromRaw(1); }
+      static constexpr Type epsilon() noexcept { return Type::FromRaw(1); }
+  };
+}
+
+namespace units
+{
+  namespace internal
+  {
+    template <int kFractionBits, typename RawType, Overflow kOverflow>
+    struct StorageLimits<Fixed<kFractionBits, RawType, kOverflow>>
+    {
+      typedef Fixed<kFractionBits, RawType, kOverflow> Type;
+      static constexpr Type Max() noexcept { return std::numeric_limits<Type>::max(); }
+      static constexpr Type Lowest() noexcept { return std::numeric_limits<Type>::lowest(); }
+    };
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: fixed-point numbers
+
+
+#endif
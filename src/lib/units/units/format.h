@@ -0,0 +1,198 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_FORMAT_H
+#define UNITS_FORMAT_H
+
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <system_error>
+#if defined(__has_include)
+  #if __has_include(<version>)
+    #include <version>
+  #endif
+#endif
+#if defined(__cpp_lib_format)
+  #include <algorithm>
+  #include <format>
+#endif
+
+#include "units/symbol.h"
+
+
+// formatting
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  enum class Scaling
+  {
+    kNone, // the symbol of the value's own unit (or the first symbol, converted, if the set has none)
+    kAuto, // the largest symbol the value is at least one of (e.g. 2500 m -> 2.5 km, 0.2 m -> 200 mm), else the smallest
+  };
+
+  namespace internal
+  {
+    // the type a unit value is printed as: floats keep their own precision so the shortest round trip stays short,
+    // number classes (fixed-point, 16-bit floats) print as double
+    template <typename Storage>
+    using PrintedOf = typename std::conditional<std::is_arithmetic<Storage>::value, Storage, double>::type;
+
+    // whether a symbol's value is a whole number, for integer storage
+    template <typename Storage, typename Entry>
+    inline bool ConvertsExactly(const Storage raw, const Entry &entry) noexcept
+    {
+      if constexpr (std::is_integral<Storage>::value)
+      {
+        const long long value = static_cast<long long>(raw);
+        return value <= std::numeric_limits<long long>::max() / entry.m_denominator
+            && value >= std::numeric_limits<long long>::lowest() / entry.m_denominator
+            && (value * entry.m_denominator) % entry.m_numerator == 0;
+      }
+      else
+      {
+        return true;
+      }
+    }
+
+    // integer storage only scales to symbols its value is a whole number of (e.g. 2000 ns -> 2 us, but 2500 ns stays)
+    template <typename Unit, int kNumSymbols>
+    inline int ChooseSymbol(const Unit value, const SymbolSet<Unit, kNumSymbols> &symbols, const Scaling scaling) noexcept
+    {
+      int own = -1;
+      for (int i = 0; i < kNumSymbols && own < 0; ++i)
+        own = (symbols[i].m_numerator == symbols[i].m_denominator) ? i : own;
+
+      const double magnitude = std::abs(static_cast<double>(static_cast<PrintedOf<typename Unit::Storage>>(value.GetRaw())));
+      if (scaling == Scaling::kNone || magnitude == 0.0 || !(magnitude <= std::numeric_limits<double>::max()))
+        return (own < 0) ? 0 : own;
+
+      int largest = -1;
+      int smallest = -1;
+      double largestScale = 0.0;
+      double smallestScale = std::numeric_limits<double>::max();
+      for (int i = 0; i < kNumSymbols; ++i)
+      {
+        if (!ConvertsExactly(value.GetRaw(), symbols[i]))
+          continue;
+
+        const double scale = static_cast<double>(symbols[i].m_numerator) / static_cast<double>(symbols[i].m_denominator);
+        if (magnitude >= scale && scale > largestScale)
+        {
+          largest = i;
+          largestScale = scale;
+        }
+        if (scale < smallestScale)
+        {
+          smallest = i;
+          smallestScale = scale;
+        }
+      }
+      if (largest >= 0)
+        return largest;
+      if (smallest >= 0)
+        return smallest;
+      return (own < 0) ? 0 : own;
+    }
+
+    // value in the unit of a symbol; integers stay integers when the conversion is exact, and print as double otherwise
+    template <typename Storage, typename Entry, typename Function>
+    inline auto VisitConverted(const Storage raw, const Entry &entry, const Function &function)
+    {
+      typedef PrintedOf<Storage> Printed;
+      if (entry.m_numerator == entry.m_denominator)
+        return function(static_cast<Printed>(raw));
+
+      if constexpr (std::is_integral<Storage>::value)
+      {
+        const long long value = static_cast<long long>(raw);
+        if (ConvertsExactly(raw, entry))
+          return function(static_cast<Printed>(value * entry.m_denominator / entry.m_numerator));
+        return function(static_cast<double>(value) * static_cast<double>(entry.m_denominator) / static_cast<double>(entry.m_numerator));
+      }
+      else
+      {
+        const double value = static_cast<double>(raw) * static_cast<double>(entry.m_denominator) / static_cast<double>(entry.m_numerator);
+        return function(static_cast<Printed>(value));
+      }
+    }
+  }
+
+  // value, a space, and a unit symbol into a caller buffer, without allocating, e.g.
+  //   char buffer[64];
+  //   const auto result = units::to_chars(buffer, buffer + sizeof(buffer), 2500_m, kLengthSymbols, units::Scaling::kAuto); // "2.5 km"
+  // floats are written in the shortest form that reads back to the same value; std::errc::value_too_large if the buffer is too small
+  template <typename Unit, int kNumSymbols>
+  inline std::to_chars_result to_chars(char *first, char *last, const Unit value, const SymbolSet<Unit, kNumSymbols> &symbols, const Scaling scaling = Scaling::kNone) noexcept
+  {
+    const auto &entry = symbols[internal::ChooseSymbol(value, symbols, scaling)];
+    const std::to_chars_result number = internal::VisitConverted(value.GetRaw(), entry, [&](const auto printed) { return std::to_chars(first, last, printed); });
+    if (number.ec != std::errc())
+      return number;
+
+    char *out = number.ptr;
+    if (static_cast<std::size_t>(last - out) < 1 + entry.m_text.size())
+      return std::to_chars_result{ last, std::errc::value_too_large };
+
+    *out++ = ' ';
+    for (const char c : entry.m_text)
+      *out++ = c;
+    return std::to_chars_result{ out, std::errc() };
+  }
+
+  // a unit value paired with the symbols to print it with, for std::format, e.g.
+  //   std::format("{:.1f}", units::formatted(speed, kVelocitySymbols)); // "3.5 m/s"
+  // the format spec applies to the number only
+  template <typename UnitType, int kNumSymbols>
+  struct FormattedUnit
+  {
+    typedef UnitType Unit;
+    Unit m_value;
+    const SymbolSet<Unit, kNumSymbols> *m_symbols;
+    Scaling m_scaling;
+  };
+
+  template <typename Unit, int kNumSymbols>
+  constexpr FormattedUnit<Unit, kNumSymbols> formatted(const Unit value, const SymbolSet<Unit, kNumSymbols> &symbols, const Scaling scaling = Scaling::kNone) noexcept
+  {
+    return FormattedUnit<Unit, kNumSymbols>{ value, &symbols, scaling };
+  }
+}
+
+// std::format support, where the standard library has it
+#if defined(__cpp_lib_format)
+template <typename Unit, int kNumSymbols>
+struct std::formatter<units::FormattedUnit<Unit, kNumSymbols>, char> : std::formatter<units::internal::PrintedOf<typename Unit::Storage>, char>
+{
+  typedef units::internal::PrintedOf<typename Unit::Storage> Printed;
+
+  template <typename FormatContext>
+  auto format(const units::FormattedUnit<Unit, kNumSymbols> &formatted, FormatContext &context) const
+  {
+    const auto &entry = (*formatted.m_symbols)[units::internal::ChooseSymbol(formatted.m_value, *formatted.m_symbols, formatted.m_scaling)];
+    auto out = units::internal::VisitConverted(formatted.m_value.GetRaw(), entry, [&](const auto printed)
+    {
+      // the spec was parsed for the printed type; an integer with no whole-number symbol prints its double value plainly
+      if constexpr (std::is_same<typename std::remove_const<decltype(printed)>::type, Printed>::value)
+        return std::formatter<Printed, char>::format(printed, context);
+      else
+        return std::format_to(context.out(), "{}", printed);
+    });
+    *out++ = ' ';
+    return std::copy(entry.m_text.begin(), entry.m_text.end(), out);
+  }
+};
+#endif
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: formatting
+
+
+#endif
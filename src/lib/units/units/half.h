@@ -0,0 +1,427 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_HALF_H
+#define UNITS_HALF_H
+
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+#include "units/batch.h"
+
+
+// 16-bit floats
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  enum class Float16Format
+  {
+    kHalf,     // IEEE 754 binary16: 5 exponent bits, 10 mantissa bits
+    kBFloat16, // float's 8 exponent bits, 7 mantissa bits
+  };
+
+  namespace internal
+  {
+    // round to nearest even, overflow to infinity, gradual underflow
+    constexpr std::uint16_t FloatToHalfBits(const float value)
+    {
+      const std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+      const std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+      const std::uint32_t abs = bits & 0x7fffffff;
+
+      if (abs > 0x7f800000) // NaN, kept quiet
+        return sign | 0x7e00 | static_cast<std::uint16_t>((abs >> 13) & 0x3ff);
+      if (abs >= 0x477ff000) // rounds to 65520 or beyond
+        return sign | 0x7c00;
+
+      std::uint32_t result = 0;
+      int shift = 0;
+      if (abs >= 0x38800000) // normal half, rebias the exponent
+      {
+        result = abs - 0x38000000;
+        shift = 13;
+      }
+      else // subnormal half, in units of 2^-24
+      {
+        const int exponent = static_cast<int>(abs >> 23);
+        shift = 126 - exponent;
+        if (shift > 24)
+          return sign;
+        result = (abs & 0x7fffff) | 0x800000;
+      }
+
+      const std::uint32_t halfway = std::uint32_t(1) << (shift - 1);
+      const std::uint32_t remainder = result & ((halfway << 1) - 1);
+      result >>= shift;
+      if (remainder > halfway || (remainder == halfway && (result & 1)))
+        ++result; // may carry into the exponent, which is still the right encoding
+      return sign | static_cast<std::uint16_t>(result);
+    }
+
+    constexpr float HalfBitsToFloat(const std::uint16_t half)
+    {
+      const std::uint32_t sign = std::uint32_t(half & 0x8000) << 16;
+      const std::uint32_t exponent = (half >> 10) & 0x1f;
+      const std::uint32_t mantissa = half & 0x3ff;
+
+      if (exponent == 0x1f)
+        return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+      if (exponent == 0)
+      {
+        const float subnormal = static_cast<float>(mantissa) * (1.0f / 16777216.0f); // exact
+        return sign ? -subnormal : subnormal;
+      }
+      return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+
+    // round to nearest even
+    constexpr std::uint16_t FloatToBFloat16Bits(const float value)
+    {
+      const std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+      if ((bits & 0x7fffffff) > 0x7f800000)
+        return static_cast<std::uint16_t>((bits >> 16) | 0x40); // NaN, kept quiet
+      return static_cast<std::uint16_t>((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+    }
+
+    constexpr float BFloat16BitsToFloat(const std::uint16_t bfloat)
+    {
+      return std::bit_cast<float>(std::uint32_t(bfloat) << 16);
+    }
+  }
+
+  // 16-bit float usable as a unit storage type, e.g.
+  //   MAKE_UNIT_VARIANT(Voltage16, units::Half, _v16, Voltage);
+  // only storage is 16-bit: every operation widens to float, computes, and rounds back to nearest even,
+  // so results match float arithmetic rounded to 16 bits; use units::convert to widen or narrow whole arrays at once
+  template <Float16Format kFormat>
+  class Float16
+  {
+    public:
+      static const Float16Format kFloatFormat = kFormat;
+
+      Float16() = default;
+
+      static constexpr Float16 FromBits(const std::uint16_t bits) noexcept { Float16 result; result.m_bits = bits; return result; }
+      constexpr std::uint16_t GetBits() const noexcept { return m_bits; }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      constexpr explicit Float16(const V value) noexcept : m_bits(ToBits(static_cast<float>(value))) { }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      constexpr explicit operator V() const noexcept { return static_cast<V>(ToFloat(m_bits)); }
+
+      constexpr Float16 operator+() const noexcept { return *this; }
+      constexpr Float16 operator-() const noexcept { return FromBits(m_bits ^ 0x8000); }
+
+      friend constexpr Float16 operator+(const Float16 lhs, const Float16 rhs) noexcept { return Float16(float(lhs) + float(rhs)); }
+      friend constexpr Float16 operator-(const Float16 lhs, const Float16 rhs) noexcept { return Float16(float(lhs) - float(rhs)); }
+      friend constexpr Float16 operator*(const Float16 lhs, const Float16 rhs) noexcept { return Float16(float(lhs) * float(rhs)); }
+      friend constexpr Float16 operator/(const Float16 lhs, const Float16 rhs) noexcept { return Float16(float(lhs) / float(rhs)); }
+
+      // scalar factors & divisors, computed in float (or wider, if the scalar is)
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Float16 operator*(const Float16 lhs, const V rhs) noexcept { return Float16(float(lhs) * rhs); }
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Float16 operator*(const V lhs, const Float16 rhs) noexcept { return Float16(lhs * float(rhs)); }
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Float16 operator/(const Float16 lhs, const V rhs) noexcept { return Float16(float(lhs) / rhs); }
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      friend constexpr Float16 operator/(const V lhs, const Float16 rhs) noexcept { return Float16(lhs / float(rhs)); }
+
+      constexpr Float16 &operator+=(const Float16 rhs) noexcept { return *this = *this + rhs; }
+      constexpr Float16 &operator-=(const Float16 rhs) noexcept { return *this = *this - rhs; }
+      constexpr Float16 &operator*=(const Float16 rhs) noexcept { return *this = *this * rhs; }
+      constexpr Float16 &operator/=(const Float16 rhs) noexcept { return *this = *this / rhs; }
+
+      // float semantics: NaN compares unequal, -0 == +0
+      friend constexpr bool operator==(const Float16 lhs, const Float16 rhs) noexcept { return float(lhs) == float(rhs); }
+      friend constexpr bool operator!=(const Float16 lhs, const Float16 rhs) noexcept { return float(lhs) != float(rhs); }
+      friend constexpr bool operator<(const Float16 lhs, const Float16 rhs) noexcept { return float(lhs) < float(rhs); }
+      friend constexpr bool operator<=(const Float16 lhs, const Float16 rhs) noexcept { return float(lhs) <= float(rhs); }
+      friend constexpr bool operator>(const Float16 lhs, const Float16 rhs) noexcept { return float(lhs) > float(rhs); }
+      friend constexpr bool operator>=(const Float16 lhs, const Float16 rhs) noexcept { return float(lhs) >= float(rhs); }
+
+    private:
+      static constexpr std::uint16_t ToBits(const float value) noexcept
+      {
+        if constexpr (kFormat == Float16Format::kHalf)
+          return internal::FloatToHalfBits(value);
+        else
+          return internal::FloatToBFloat16Bits(value);
+      }
+
+      static constexpr float ToFloat(const std::uint16_t bits) noexcept
+      {
+        if constexpr (kFormat == Float16Format::kHalf)
+          return internal::HalfBitsToFloat(bits);
+        else
+          return internal::BFloat16BitsToFloat(bits);
+      }
+
+      std::uint16_t m_bits;
+  };
+
+  typedef Float16<Float16Format::kHalf> Half;
+  typedef Float16<Float16Format::kBFloat16> BFloat16;
+
+  template <typename T> struct IsFloat16 : std::false_type { };
+  template <Float16Format kFormat> struct IsFloat16<Float16<kFormat>> : std::true_type { };
+}
+
+namespace std
+{
+  // lets Quantity::PosInfinity & NegInfinity map to the largest finite 16-bit values, like they do for float
+  template <units::Float16Format kFormat>
+  class numeric_limits<units::Float16<kFormat>>
+  {
+    static constexpr bool kHalf = (kFormat == units::Float16Format::kHalf);
+
+    public:
+      typedef units::Float16<kFormat> Type;
+      static constexpr bool is_specialized = true;
+      static constexpr bool is_signed = true;
+      static constexpr bool is_integer = false;
+      static constexpr bool is_exact = false;
+      static constexpr bool has_infinity = true;
+      static constexpr bool has_quiet_NaN = true;
+      static constexpr int digits = kHalf ? 11 : 8;
+      static constexpr Type max() noexcept { return Type::FromBits(kHalf ? 0x7bff : 0x7f7f); }
+      static constexpr Type lowest() noexcept { return Type::FromBits(kHalf ? 0xfbff : 0xff7f); }
+      static constexpr Type min() noexcept { return Type::FromBits(kHalf ? 0x0400 : 0x0080); }
+      static constexpr Type epsilon() noexcept { return Type::FromBits(kHalf ? 0x1400 : 0x3c00); }
+      static constexpr Type infinity() noexcept { return Type::FromBits(kHalf ? 0x7c00 : 0x7f80); }
+      static constexpr Type quiet_NaN() noexcept { return Type::FromBits(kHalf ? 0x7e00 : 0x7fc0); }
+  };
+}
+
+namespace units
+{
+  namespace internal
+  {
+    template <Float16Format kFormat>
+    struct StorageLimits<Float16<kFormat>>
+    {
+      static constexpr Float16<kFormat> Max() noexcept { return std::numeric_limits<Float16<kFormat>>::max(); }
+      static constexpr Float16<kFormat> Lowest() noexcept { return std::numeric_limits<Float16<kFormat>>::lowest(); }
+    };
+
+    template <Float16Format kFormat>
+    struct IsFloatingStorage<Float16<kFormat>> : std::true_type { };
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: 16-bit floats
+
+
+// 16-bit float kernels
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // widen: 16-bit floats -> float, narrow: float -> 16-bit floats (round to nearest even)
+    namespace scalar
+    {
+      template <Float16Format kFormat>
+      void Widen(const std::uint16_t *in, float *out, const std::size_t n)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = (kFormat == Float16Format::kHalf) ? HalfBitsToFloat(in[i]) : BFloat16BitsToFloat(in[i]);
+      }
+
+      template <Float16Format kFormat>
+      void Narrow(const float *in, std::uint16_t *out, const std::size_t n)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+          out[i] = (kFormat == Float16Format::kHalf) ? FloatToHalfBits(in[i]) : FloatToBFloat16Bits(in[i]);
+      }
+    }
+
+#if UNITS_SIMD_X64
+
+    // half uses the F16C / AVX-512 conversion instructions, bfloat16 is bit shuffling on the integer units
+    namespace avx2
+    {
+      template <Float16Format kFormat>
+      UNITS_TARGET_AVX2 void Widen(const std::uint16_t *in, float *out, const std::size_t n)
+      {
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+          const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+          if constexpr (kFormat == Float16Format::kHalf)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(packed));
+          else
+            _mm256_storeu_ps(out + i, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(packed), 16)));
+        }
+        scalar::Widen<kFormat>(in + i, out + i, n - i);
+      }
+
+      template <Float16Format kFormat>
+      UNITS_TARGET_AVX2 void Narrow(const float *in, std::uint16_t *out, const std::size_t n)
+      {
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+          const __m256 wide = _mm256_loadu_ps(in + i);
+          __m128i packed;
+          if constexpr (kFormat == Float16Format::kHalf)
+          {
+            packed = _mm256_cvtps_ph(wide, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+          }
+          else
+          {
+            const __m256i bits = _mm256_castps_si256(wide);
+            const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+            const __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7fff))), 16);
+            const __m256i quiet = _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x40));
+            const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(wide, wide, _CMP_UNORD_Q));
+            const __m256i result = _mm256_blendv_epi8(rounded, quiet, nan);
+            // packus works per 128-bit half, so gather the two low quadwords back together
+            packed = _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(result, result), 0x08));
+          }
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+        }
+        scalar::Narrow<kFormat>(in + i, out + i, n - i);
+      }
+    }
+
+    // zero-masked forms with a full mask, as the unmasked ones trip -Wmaybe-uninitialized in some GCC versions
+    namespace avx512
+    {
+      static const __mmask16 kAllLanes = 0xffff;
+
+      template <Float16Format kFormat>
+      UNITS_TARGET_AVX512 void Widen(const std::uint16_t *in, float *out, const std::size_t n)
+      {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+          const __m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+          if constexpr (kFormat == Float16Format::kHalf)
+            _mm512_storeu_ps(out + i, _mm512_maskz_cvtph_ps(kAllLanes, packed));
+          else
+            _mm512_storeu_ps(out + i, _mm512_castsi512_ps(_mm512_maskz_slli_epi32(kAllLanes, _mm512_maskz_cvtepu16_epi32(kAllLanes, packed), 16)));
+        }
+        avx2::Widen<kFormat>(in + i, out + i, n - i);
+      }
+
+      template <Float16Format kFormat>
+      UNITS_TARGET_AVX512 void Narrow(const float *in, std::uint16_t *out, const std::size_t n)
+      {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+          const __m512 wide = _mm512_loadu_ps(in + i);
+          __m256i packed;
+          if constexpr (kFormat == Float16Format::kHalf)
+          {
+            packed = _mm512_maskz_cvtps_ph(kAllLanes, wide, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+          }
+          else
+          {
+            const __m512i bits = _mm512_castps_si512(wide);
+            const __m512i odd = _mm512_and_si512(_mm512_maskz_srli_epi32(kAllLanes, bits, 16), _mm512_set1_epi32(1));
+            const __m512i rounded = _mm512_maskz_srli_epi32(kAllLanes, _mm512_add_epi32(bits, _mm512_add_epi32(odd, _mm512_set1_epi32(0x7fff))), 16);
+            const __m512i quiet = _mm512_or_si512(_mm512_maskz_srli_epi32(kAllLanes, bits, 16), _mm512_set1_epi32(0x40));
+            const __mmask16 nan = _mm512_cmp_ps_mask(wide, wide, _CMP_UNORD_Q);
+            packed = _mm512_maskz_cvtepi32_epi16(kAllLanes, _mm512_mask_blend_epi32(nan, rounded, quiet));
+          }
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+        }
+        avx2::Narrow<kFormat>(in + i, out + i, n - i);
+      }
+    }
+
+#endif
+
+    template <Float16Format kFormat>
+    inline void BatchWiden(const std::uint16_t *in, float *out, const std::size_t n)
+    {
+#if UNITS_SIMD_X64
+      switch (GetInstructionSet())
+      {
+        case InstructionSet::kAvx512: avx512::Widen<kFormat>(in, out, n); return;
+        case InstructionSet::kAvx2: avx2::Widen<kFormat>(in, out, n); return;
+        case InstructionSet::kSse2: break;
+        case InstructionSet::kScalar: break;
+      }
+#endif
+      scalar::Widen<kFormat>(in, out, n);
+    }
+
+    template <Float16Format kFormat>
+    inline void BatchNarrow(const float *in, std::uint16_t *out, const std::size_t n)
+    {
+#if UNITS_SIMD_X64
+      switch (GetInstructionSet())
+      {
+        case InstructionSet::kAvx512: avx512::Narrow<kFormat>(in, out, n); return;
+        case InstructionSet::kAvx2: avx2::Narrow<kFormat>(in, out, n); return;
+        case InstructionSet::kSse2: break;
+        case InstructionSet::kScalar: break;
+      }
+#endif
+      scalar::Narrow<kFormat>(in, out, n);
+    }
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: 16-bit float kernels
+
+
+// storage conversion
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    template <typename T, bool = IsQuantity<T>::value>
+    struct DimensionTag { typedef void Type; };
+    template <typename T>
+    struct DimensionTag<T, true> { typedef Quantity<char, T::kDimension> Type; };
+  }
+
+  // out[i] = in[i] in another storage type, same unit, e.g. 16-bit telemetry to float for aggregation and back;
+  // half & bfloat16 <-> float use the widest conversion kernel the active instruction set allows
+  template <typename In, typename Out>
+  inline void convert(const In &in, Out &&out)
+  {
+    typedef internal::RangeValue<In> InUnit;
+    typedef internal::RangeValue<Out> OutUnit;
+    static_assert(std::is_same<typename internal::DimensionTag<InUnit>::Type, typename internal::DimensionTag<OutUnit>::Type>::value, "convert requires units of the same dimension and scale");
+
+    typedef internal::RangeStorage<In> InStorage;
+    typedef internal::RangeStorage<Out> OutStorage;
+    const auto source = raw_span(std::span(in));
+    const auto destination = internal::OutputSpan(out, source.size());
+
+    if constexpr (IsFloat16<InStorage>::value && std::is_same<OutStorage, float>::value)
+      internal::BatchWiden<InStorage::kFloatFormat>(reinterpret_cast<const std::uint16_t *>(source.data()), destination.data(), source.size());
+    else if constexpr (std::is_same<InStorage, float>::value && IsFloat16<OutStorage>::value)
+      internal::BatchNarrow<OutStorage::kFloatFormat>(source.data(), reinterpret_cast<std::uint16_t *>(destination.data()), source.size());
+    else
+    {
+      for (std::size_t i = 0; i < source.size(); ++i)
+        destination[i] = static_cast<OutStorage>(source[i]);
+    }
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: storage conversion
+
+
+#endif
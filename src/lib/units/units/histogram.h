@@ -0,0 +1,457 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_HISTOGRAM_H
+#define UNITS_HISTOGRAM_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "units/units.h"
+
+
+// histograms
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // log-linear buckets straight from the float bit pattern: the exponent picks the octave and the top kSubBucketBits of the mantissa
+    // the linear step within it, so every bucket spans at most 2^-kSubBucketBits of its values and an index is a shift and a subtract
+    // float storage buckets as float, everything else (integers, e.g. nanosecond counts) as double
+    template <typename Storage, int kSubBucketBits>
+    class HistogramLayout
+    {
+      public:
+        typedef typename std::conditional<std::is_same<Storage, float>::value, float, double>::type Real;
+        typedef typename std::conditional<std::is_same<Real, float>::value, std::uint32_t, std::uint64_t>::type Bits;
+        static const int kShift = std::numeric_limits<Real>::digits - 1 - kSubBucketBits;
+
+        static_assert(std::is_arithmetic<Storage>::value, "histograms need integer or floating-point storage");
+        static_assert(kSubBucketBits >= 1 && kShift >= 0, "sub-bucket bits must fit the mantissa");
+
+        HistogramLayout(const Real lowest, const Real highest) noexcept
+          : m_lowest(lowest), m_highest(highest), m_base(std::bit_cast<Bits>(lowest) >> kShift), m_numBuckets(static_cast<std::size_t>((std::bit_cast<Bits>(highest) >> kShift) - m_base + 1))
+        {
+          assert(lowest > Real(0) && highest >= lowest && highest <= std::numeric_limits<Real>::max() && "histogram range must be positive & finite");
+        }
+
+        // values outside the range (and NaNs) land in the first or last bucket
+        std::size_t Index(const Real value) const noexcept
+        {
+          const Real clamped = (value > m_lowest) ? ((value < m_highest) ? value : m_highest) : m_lowest;
+          return static_cast<std::size_t>((std::bit_cast<Bits>(clamped) >> kShift) - m_base);
+        }
+
+        // middle of a bucket, within half a bucket (2^-(kSubBucketBits + 1) relative) of any value in it
+        Real Middle(const std::size_t index) const noexcept
+        {
+          const Real lower = std::bit_cast<Real>(static_cast<Bits>((m_base + index) << kShift));
+          const Real upper = std::bit_cast<Real>(static_cast<Bits>((m_base + index + 1) << kShift));
+          return lower + (upper - lower) / Real(2);
+        }
+
+        std::size_t GetNumBuckets() const noexcept { return m_numBuckets; }
+        bool operator==(const HistogramLayout &rhs) const noexcept { return m_base == rhs.m_base && m_numBuckets == rhs.m_numBuckets; }
+
+      private:
+        Real m_lowest;
+        Real m_highest;
+        Bits m_base;
+        std::size_t m_numBuckets;
+    };
+  }
+
+  template <typename UnitType, int kSubBucketBits>
+  class ShardedHistogram;
+
+  // HDR-style log-linear histogram of unit values, e.g. request latencies
+  //   units::Histogram<Time> latencies(1_us, 60_s);
+  //   latencies.Record(elapsed);
+  //   const Time p99 = latencies.GetPercentile(0.99);
+  // with the default 7 sub-bucket bits, percentiles are within 0.4% of a recorded value; recording is a clamp, a shift & an increment
+  // single-threaded; see ShardedHistogram for recording from many threads
+  template <typename UnitType, int kSubBucketBits = 7>
+  class Histogram
+  {
+    static_assert(IsQuantity<UnitType>::value, "histograms hold unit types");
+
+    public:
+      typedef UnitType Unit;
+      typedef typename Unit::Storage Storage;
+      typedef internal::HistogramLayout<Storage, kSubBucketBits> Layout;
+      typedef typename Layout::Real Real;
+
+      // values below lowest or above highest are counted as lowest & highest (min & max stay exact)
+      Histogram(const Unit lowest, const Unit highest)
+        : m_layout(static_cast<Real>(lowest.GetRaw()), static_cast<Real>(highest.GetRaw())), m_counts(m_layout.GetNumBuckets(), 0)
+      {
+        Reset();
+      }
+
+      void Record(const Unit value) noexcept
+      {
+        const Real raw = static_cast<Real>(value.GetRaw());
+        ++m_counts[m_layout.Index(raw)];
+        ++m_count;
+        m_sum += static_cast<double>(raw);
+        m_min = (raw < m_min) ? raw : m_min;
+        m_max = (raw > m_max) ? raw : m_max;
+      }
+
+      void Record(const Unit value, const std::uint64_t count) noexcept
+      {
+        const Real raw = static_cast<Real>(value.GetRaw());
+        m_counts[m_layout.Index(raw)] += count;
+        m_count += count;
+        m_sum += static_cast<double>(raw) * static_cast<double>(count);
+        m_min = (count && raw < m_min) ? raw : m_min;
+        m_max = (count && raw > m_max) ? raw : m_max;
+      }
+
+      // bucket-wise sum; both histograms must have the same range
+      void Merge(const Histogram &other) noexcept
+      {
+        assert(m_layout == other.m_layout && "merged histograms must have the same range");
+        for (std::size_t i = 0; i < m_counts.size(); ++i)
+          m_counts[i] += other.m_counts[i];
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = (other.m_min < m_min) ? other.m_min : m_min;
+        m_max = (other.m_max > m_max) ? other.m_max : m_max;
+      }
+
+      void Reset() noexcept
+      {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_count = 0;
+        m_sum = 0.0;
+        m_min = std::numeric_limits<Real>::infinity();
+        m_max = -std::numeric_limits<Real>::infinity();
+      }
+
+      // fraction in [0, 1], e.g. 0.99 for the 99th percentile; the smallest recorded value at or above that fraction of all values,
+      // to within half a bucket, never outside the recorded min & max, and exact at both ends; zero if nothing was recorded
+      Unit GetPercentile(const double fraction) const noexcept
+      {
+        if (m_count == 0)
+          return Unit::From(Storage());
+
+        const double clamped = (fraction > 0.0) ? ((fraction < 1.0) ? fraction : 1.0) : 0.0;
+        const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(clamped * static_cast<double>(m_count))));
+        if (rank == 1 || rank == m_count)
+          return Unit::From((rank == 1) ? m_min : m_max); // known exactly
+        std::uint64_t seen = 0;
+        std::size_t i = 0;
+        for (; i + 1 < m_counts.size(); ++i)
+        {
+          seen += m_counts[i];
+          if (seen >= rank)
+            break;
+        }
+        const Real value = m_layout.Middle(i);
+        return Unit::From((value < m_min) ? m_min : (value > m_max) ? m_max : value);
+      }
+
+      std::uint64_t GetCount() const noexcept { return m_count; }
+      Unit GetMin() const noexcept { return Unit::From(m_count ? m_min : Real(0)); }
+      Unit GetMax() const noexcept { return Unit::From(m_count ? m_max : Real(0)); }
+      Unit GetMean() const noexcept { return Unit::From(m_count ? m_sum / static_cast<double>(m_count) : 0.0); }
+
+    private:
+      friend class ShardedHistogram<Unit, kSubBucketBits>;
+
+      Layout m_layout;
+      std::vector<std::uint64_t> m_counts;
+      std::uint64_t m_count;
+      double m_sum;
+      Real m_min;
+      Real m_max;
+  };
+
+  // a histogram recorded from many threads without locks or locked instructions on the record path, e.g.
+  //   units::ShardedHistogram<Time> s_latencies(1_us, 60_s);
+  //   thread_local units::ShardedHistogram<Time>::Recorder t_recorder = s_latencies.GetRecorder();
+  //   t_recorder.Record(elapsed);                          // any thread, a handful of nanoseconds
+  //   units::Histogram<Time> report = s_latencies.Snapshot(); // reporting thread
+  // each recorder owns a shard that only its thread writes (relaxed loads & stores), and snapshots merge the shards as they are
+  template <typename UnitType, int kSubBucketBits = 7>
+  class ShardedHistogram
+  {
+    public:
+      typedef UnitType Unit;
+      typedef Histogram<Unit, kSubBucketBits> Merged;
+      typedef typename Merged::Layout Layout;
+      typedef typename Merged::Real Real;
+
+    private:
+      struct Shard
+      {
+        explicit Shard(const std::size_t numBuckets) : m_counts(new std::atomic<std::uint64_t>[numBuckets]())
+        {
+          m_sum.store(0.0, std::memory_order_relaxed);
+          m_min.store(std::numeric_limits<Real>::infinity(), std::memory_order_relaxed);
+          m_max.store(-std::numeric_limits<Real>::infinity(), std::memory_order_relaxed);
+        }
+
+        std::unique_ptr<std::atomic<std::uint64_t>[]> m_counts;
+        std::atomic<double> m_sum;
+        std::atomic<Real> m_min;
+        std::atomic<Real> m_max;
+      };
+
+    public:
+      // records into one shard; use from one thread at a time
+      class Recorder
+      {
+        public:
+          Recorder() = default;
+
+          void Record(const Unit value) noexcept
+          {
+            // single writer per shard: plain relaxed read-modify-write, no locked instruction
+            const Real raw = static_cast<Real>(value.GetRaw());
+            std::atomic<std::uint64_t> &count = m_shard->m_counts[m_layout->Index(raw)];
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            m_shard->m_sum.store(m_shard->m_sum.load(std::memory_order_relaxed) + static_cast<double>(raw), std::memory_order_relaxed);
+            if (raw < m_shard->m_min.load(std::memory_order_relaxed))
+              m_shard->m_min.store(raw, std::memory_order_relaxed);
+            if (raw > m_shard->m_max.load(std::memory_order_relaxed))
+              m_shard->m_max.store(raw, std::memory_order_relaxed);
+          }
+
+        private:
+          friend class ShardedHistogram;
+          Recorder(Shard *shard, const Layout *layout) noexcept : m_shard(shard), m_layout(layout) { }
+
+          Shard *m_shard = nullptr;
+          const Layout *m_layout = nullptr;
+      };
+
+      ShardedHistogram(const Unit lowest, const Unit highest) : m_layout(static_cast<Real>(lowest.GetRaw()), static_cast<Real>(highest.GetRaw())), m_lowest(lowest), m_highest(highest) { }
+      ShardedHistogram(const ShardedHistogram &) = delete;
+      ShardedHistogram &operator=(const ShardedHistogram &) = delete;
+
+      // a new shard; locks once, so get one per thread up front rather than per record
+      Recorder GetRecorder()
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shards.push_back(std::make_unique<Shard>(m_layout.GetNumBuckets()));
+        return Recorder(m_shards.back().get(), &m_layout);
+      }
+
+      // all shards merged; records racing with the snapshot land in this one or the next
+      Merged Snapshot() const
+      {
+        Merged result(m_lowest, m_highest);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::unique_ptr<Shard> &shard : m_shards)
+        {
+          for (std::size_t i = 0; i < result.m_counts.size(); ++i)
+          {
+            const std::uint64_t count = shard->m_counts[i].load(std::memory_order_relaxed);
+            result.m_counts[i] += count;
+            result.m_count += count;
+          }
+          result.m_sum += shard->m_sum.load(std::memory_order_relaxed);
+          result.m_min = std::min(result.m_min, shard->m_min.load(std::memory_order_relaxed));
+          result.m_max = std::max(result.m_max, shard->m_max.load(std::memory_order_relaxed));
+        }
+        return result;
+      }
+
+    private:
+      Layout m_layout;
+      Unit m_lowest;
+      Unit m_highest;
+      mutable std::mutex m_mutex;
+      std::vector<std::unique_ptr<Shard>> m_shards; // stable addresses for the recorders
+  };
+
+  // mergeable quantile sketch with a relative-error guarantee over any range, for values whose range is not known up front
+  // (DDSketch: logarithmic buckets of ratio (1 + accuracy) / (1 - accuracy), grown on demand, so any quantile is within
+  // the relative accuracy of a recorded value); sketches with the same accuracy merge exactly, e.g. across hosts
+  // past maxBuckets per sign, the smallest magnitudes are collapsed into one bucket
+  template <typename UnitType>
+  class QuantileSketch
+  {
+    static_assert(IsQuantity<UnitType>::value && std::is_arithmetic<typename UnitType::Storage>::value, "quantile sketches hold unit types with integer or floating-point storage");
+
+    public:
+      typedef UnitType Unit;
+      typedef typename Unit::Storage Storage;
+
+      explicit QuantileSketch(const double relativeAccuracy = 0.01, const std::size_t maxBuckets = 2048)
+        : m_gamma((1.0 + relativeAccuracy) / (1.0 - relativeAccuracy)), m_inverseLogGamma(1.0 / std::log(m_gamma)), m_maxBuckets(maxBuckets),
+          m_zeroCount(0), m_count(0), m_min(std::numeric_limits<double>::infinity()), m_max(-std::numeric_limits<double>::infinity())
+      {
+        assert(relativeAccuracy > 0.0 && relativeAccuracy < 1.0 && maxBuckets > 0 && "relative accuracy must be in (0, 1)");
+      }
+
+      void Record(const Unit value, const std::uint64_t count = 1)
+      {
+        const double raw = static_cast<double>(value.GetRaw());
+        if (raw != raw || count == 0)
+          return;
+
+        if (raw > kMinIndexable)
+          m_positive.Add(Key(raw), count, m_maxBuckets);
+        else if (raw < -kMinIndexable)
+          m_negative.Add(Key(-raw), count, m_maxBuckets);
+        else
+          m_zeroCount += count;
+        m_count += count;
+        m_min = (raw < m_min) ? raw : m_min;
+        m_max = (raw > m_max) ? raw : m_max;
+      }
+
+      // both sketches must have the same relative accuracy
+      void Merge(const QuantileSketch &other)
+      {
+        assert(m_gamma == other.m_gamma && "merged sketches must have the same relative accuracy");
+        for (std::size_t i = 0; i < other.m_positive.m_counts.size(); ++i)
+        {
+          if (other.m_positive.m_counts[i])
+            m_positive.Add(other.m_positive.m_offset + static_cast<int>(i), other.m_positive.m_counts[i], m_maxBuckets);
+        }
+        for (std::size_t i = 0; i < other.m_negative.m_counts.size(); ++i)
+        {
+          if (other.m_negative.m_counts[i])
+            m_negative.Add(other.m_negative.m_offset + static_cast<int>(i), other.m_negative.m_counts[i], m_maxBuckets);
+        }
+        m_zeroCount += other.m_zeroCount;
+        m_count += other.m_count;
+        m_min = (other.m_min < m_min) ? other.m_min : m_min;
+        m_max = (other.m_max > m_max) ? other.m_max : m_max;
+      }
+
+      // fraction in [0, 1], e.g. 0.99 for the 99th percentile; zero if nothing was recorded
+      Unit GetPercentile(const double fraction) const noexcept
+      {
+        if (m_count == 0)
+          return Unit::From(Storage());
+
+        const double clamped = (fraction > 0.0) ? ((fraction < 1.0) ? fraction : 1.0) : 0.0;
+        const std::uint64_t rank = static_cast<std::uint64_t>(clamped * static_cast<double>(m_count - 1));
+        double value = 0.0;
+        std::uint64_t seen = 0;
+        bool found = false;
+
+        // most negative first: negative keys from the largest magnitude down
+        for (std::size_t i = m_negative.m_counts.size(); i-- > 0 && !found;)
+        {
+          seen += m_negative.m_counts[i];
+          found = (seen > rank);
+          value = -Value(m_negative.m_offset + static_cast<int>(i));
+        }
+        if (!found)
+        {
+          seen += m_zeroCount;
+          found = (seen > rank);
+          value = 0.0;
+        }
+        for (std::size_t i = 0; i < m_positive.m_counts.size() && !found; ++i)
+        {
+          seen += m_positive.m_counts[i];
+          found = (seen > rank);
+          value = Value(m_positive.m_offset + static_cast<int>(i));
+        }
+        return Unit::From((value < m_min) ? m_min : (value > m_max) ? m_max : value);
+      }
+
+      std::uint64_t GetCount() const noexcept { return m_count; }
+      Unit GetMin() const noexcept { return Unit::From(m_count ? m_min : 0.0); }
+      Unit GetMax() const noexcept { return Unit::From(m_count ? m_max : 0.0); }
+
+    private:
+      static constexpr double kMinIndexable = std::numeric_limits<double>::min() * 4.0;
+
+      // dense counts for a run of consecutive keys
+      struct Store
+      {
+        void Add(int key, const std::uint64_t count, const std::size_t maxBuckets)
+        {
+          if (m_counts.empty())
+          {
+            m_offset = key;
+            m_counts.assign(1, 0);
+          }
+
+          if (key < m_offset)
+          {
+            const std::size_t growth = static_cast<std::size_t>(m_offset - key);
+            if (m_counts.size() + growth > maxBuckets)
+            {
+              key = m_offset; // collapsed into the smallest kept bucket
+            }
+            else
+            {
+              m_counts.insert(m_counts.begin(), growth, 0);
+              m_offset = key;
+            }
+          }
+          else if (key - m_offset >= static_cast<int>(m_counts.size()))
+          {
+            m_counts.resize(static_cast<std::size_t>(key - m_offset) + 1, 0);
+            if (m_counts.size() > maxBuckets)
+            {
+              const std::size_t excess = m_counts.size() - maxBuckets;
+              std::uint64_t collapsed = 0;
+              for (std::size_t i = 0; i < excess; ++i)
+                collapsed += m_counts[i];
+              m_counts.erase(m_counts.begin(), m_counts.begin() + static_cast<std::ptrdiff_t>(excess));
+              m_counts[0] += collapsed;
+              m_offset += static_cast<int>(excess);
+            }
+          }
+          m_counts[static_cast<std::size_t>(key - m_offset)] += count;
+        }
+
+        std::vector<std::uint64_t> m_counts;
+        int m_offset = 0; // key of m_counts[0]
+      };
+
+      // bucket k holds magnitudes in (gamma^(k-1), gamma^k]
+      int Key(const double magnitude) const noexcept
+      {
+        return static_cast<int>(std::ceil(std::log(magnitude) * m_inverseLogGamma));
+      }
+
+      // the point of a bucket within the relative accuracy of both of its ends
+      double Value(const int key) const noexcept
+      {
+        return 2.0 * std::pow(m_gamma, key) / (m_gamma + 1.0);
+      }
+
+      double m_gamma;
+      double m_inverseLogGamma;
+      std::size_t m_maxBuckets;
+      Store m_positive;
+      Store m_negative; // by magnitude
+      std::uint64_t m_zeroCount;
+      std::uint64_t m_count;
+      double m_min;
+      double m_max;
+  };
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: histograms
+
+
+#endif
@@ -0,0 +1,274 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_INGEST_H
+#define UNITS_INGEST_H
+
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "units/mapped.h"
+#include "units/parse.h"
+
+
+// CSV ingest
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  enum class IngestError
+  {
+    kNone,
+    kOpenFailed,
+    kParseFailed,  // see the parse error
+    kMissingField, // a row with fewer fields than a declared column needs
+  };
+
+  // rows ingested, in file order, up to the first error (by line, regardless of which thread found it)
+  struct IngestResult
+  {
+    std::size_t m_rows;
+    std::size_t m_line;      // 1-based line of the error, counting the header
+    int m_field;             // 0-based field of the error
+    IngestError m_error;
+    ParseError m_parseError;
+
+    constexpr explicit operator bool() const noexcept { return m_error == IngestError::kNone; }
+  };
+
+  struct IngestOptions
+  {
+    char m_delimiter = ',';
+    bool m_hasHeader = true;
+    int m_numThreads = 0;                   // 0: one per hardware thread
+    std::size_t m_minChunkBytes = 1 << 16;  // smaller inputs use fewer threads
+  };
+
+  // a CSV field parsed into a unit column, e.g.
+  //   units::csv_column(2, kVoltageSymbols, voltages)       // cells like "3.3 V" or "850 mV"
+  //   units::csv_column(0, kTimeSymbols, times, "ms")      // bare numbers are milliseconds, other cells carry their own symbol
+  // the bare unit must be one of the symbols
+  template <typename UnitType, int kNumSymbols>
+  struct CsvColumn
+  {
+    typedef UnitType Unit;
+    typedef typename SymbolSet<Unit, kNumSymbols>::Entry Entry;
+
+    int m_field;
+    const SymbolSet<Unit, kNumSymbols> *m_symbols;
+    const Entry *m_bareEntry;
+    std::vector<Unit> *m_values;
+  };
+
+  template <typename Unit, int kNumSymbols>
+  inline CsvColumn<Unit, kNumSymbols> csv_column(const int field, const SymbolSet<Unit, kNumSymbols> &symbols, std::vector<Unit> &values, const std::string_view bareUnit = std::string_view())
+  {
+    return CsvColumn<Unit, kNumSymbols>{ field, &symbols, bareUnit.empty() ? nullptr : symbols.Find(bareUnit), &values };
+  }
+
+  namespace internal
+  {
+    struct ChunkResult
+    {
+      std::size_t m_rows;
+      std::size_t m_lines;
+      int m_field;
+      IngestError m_error;
+      ParseError m_parseError;
+    };
+
+    inline const char *FindLineEnd(const char *first, const char *last) noexcept
+    {
+      const void *newline = std::memchr(first, '\n', static_cast<std::size_t>(last - first));
+      return newline ? static_cast<const char *>(newline) : last;
+    }
+
+    // one row's declared fields, parsed straight from the mapped text into the chunk's column buffers
+    template <typename Columns, typename Buffers, std::size_t... kIndices>
+    inline bool ParseRow(const char *first, const char *last, const char delimiter, const Columns &columns, Buffers &buffers, ChunkResult &result, std::index_sequence<kIndices...>)
+    {
+      int field = 0;
+      std::size_t found = 0;
+      for (const char *p = first;; ++field)
+      {
+        const char *fieldEnd = nullptr;
+        ParseError error = ParseError::kNone;
+        const auto visit = [&](const auto &column, auto &buffer)
+        {
+          if (column.m_field != field || error != ParseError::kNone)
+            return;
+
+          buffer.emplace_back();
+          const ParseResult parsed = Parse(p, last, buffer.back(), *column.m_symbols, delimiter, column.m_bareEntry);
+          fieldEnd = SkipBlanks(parsed.m_end, last);
+          error = parsed.m_error;
+          if (!parsed)
+            fieldEnd = parsed.m_end;
+          else if (fieldEnd != last && *fieldEnd != delimiter)
+            error = ParseError::kTrailingCharacters;
+          ++found;
+        };
+        (visit(std::get<kIndices>(columns), std::get<kIndices>(buffers)), ...);
+
+        if (error != ParseError::kNone)
+        {
+          result.m_field = field;
+          result.m_error = IngestError::kParseFailed;
+          result.m_parseError = error;
+          return false;
+        }
+        if (!fieldEnd)
+        {
+          const void *next = std::memchr(p, delimiter, static_cast<std::size_t>(last - p));
+          fieldEnd = next ? static_cast<const char *>(next) : last;
+        }
+        if (fieldEnd == last)
+          break;
+        p = fieldEnd + 1;
+      }
+
+      if (found < sizeof...(kIndices))
+      {
+        result.m_field = field + 1;
+        result.m_error = IngestError::kMissingField;
+        return false;
+      }
+      return true;
+    }
+
+    // whole lines only; blank lines are skipped, and the first error stops the chunk
+    template <typename Columns, typename Buffers, std::size_t... kIndices>
+    inline ChunkResult ParseChunk(const char *first, const char *last, const char delimiter, const Columns &columns, Buffers &buffers, const std::index_sequence<kIndices...> indices)
+    {
+      ChunkResult result = { 0, 0, -1, IngestError::kNone, ParseError::kNone };
+      while (first != last)
+      {
+        const char *lineEnd = FindLineEnd(first, last);
+        const char *contentEnd = (lineEnd != first && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+        ++result.m_lines;
+
+        if (SkipBlanks(first, contentEnd) != contentEnd)
+        {
+          if (!ParseRow(first, contentEnd, delimiter, columns, buffers, result, indices))
+            return result;
+          ++result.m_rows;
+        }
+        first = (lineEnd == last) ? last : lineEnd + 1;
+      }
+      return result;
+    }
+
+    template <typename... Columns, std::size_t... kIndices>
+    inline IngestResult IngestCsv(const char *first, const char *last, const IngestOptions &options, const std::tuple<Columns...> &columns, const std::index_sequence<kIndices...> indices)
+    {
+      typedef std::tuple<std::vector<typename Columns::Unit>...> Buffers;
+
+      std::size_t headerLines = 0;
+      if (options.m_hasHeader && first != last)
+      {
+        const char *headerEnd = FindLineEnd(first, last);
+        first = (headerEnd == last) ? last : headerEnd + 1;
+        headerLines = 1;
+      }
+
+      // newline-aligned chunks of about equal size, one per thread
+      const std::size_t size = static_cast<std::size_t>(last - first);
+      const std::size_t numHardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+      const std::size_t numThreads = (options.m_numThreads > 0) ? static_cast<std::size_t>(options.m_numThreads) : numHardwareThreads;
+      const std::size_t numChunks = std::max<std::size_t>(1, std::min(numThreads, size / std::max<std::size_t>(1, options.m_minChunkBytes)));
+      std::vector<const char *> bounds(numChunks + 1, last);
+      bounds[0] = first;
+      for (std::size_t i = 1; i < numChunks; ++i)
+      {
+        const char *bound = std::max(first + size / numChunks * i, bounds[i - 1]);
+        bound = FindLineEnd(bound, last);
+        bounds[i] = (bound == last) ? last : bound + 1;
+      }
+
+      std::vector<Buffers> buffers(numChunks);
+      std::vector<ChunkResult> results(numChunks);
+      const auto parse = [&](const std::size_t i) { results[i] = ParseChunk(bounds[i], bounds[i + 1], options.m_delimiter, columns, buffers[i], indices); };
+      {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < numChunks; ++i)
+          threads.emplace_back(parse, i);
+        parse(0);
+        for (std::thread &thread : threads)
+          thread.join();
+      }
+
+      // chunks in file order, up to the first one that failed
+      IngestResult ingested = { 0, 0, -1, IngestError::kNone, ParseError::kNone };
+      std::vector<std::size_t> offsets(numChunks + 1, 0);
+      std::size_t line = headerLines;
+      std::size_t numUsed = 0;
+      for (; numUsed < numChunks && ingested.m_error == IngestError::kNone; ++numUsed)
+      {
+        offsets[numUsed + 1] = offsets[numUsed] + results[numUsed].m_rows;
+        line += results[numUsed].m_lines;
+        if (results[numUsed].m_error != IngestError::kNone)
+          ingested = IngestResult{ 0, line, results[numUsed].m_field, results[numUsed].m_error, results[numUsed].m_parseError };
+      }
+      ingested.m_rows = offsets[numUsed];
+
+      // merged into the outputs in parallel, each chunk copying to its own offset
+      (std::get<kIndices>(columns).m_values->resize(ingested.m_rows), ...);
+      const auto merge = [&](const std::size_t i)
+      {
+        const auto copy = [&](const auto &column, const auto &buffer) { std::copy(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(results[i].m_rows), column.m_values->begin() + static_cast<std::ptrdiff_t>(offsets[i])); };
+        (copy(std::get<kIndices>(columns), std::get<kIndices>(buffers[i])), ...);
+      };
+      {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < numUsed; ++i)
+          threads.emplace_back(merge, i);
+        merge(0);
+        for (std::thread &thread : threads)
+          thread.join();
+      }
+      return ingested;
+    }
+  }
+
+  // CSV text into unit columns, split into newline-aligned chunks parsed in parallel and merged in order, e.g.
+  //   std::vector<Time> times;
+  //   std::vector<Length> altitudes;
+  //   units::ingest_csv(text, units::IngestOptions(), units::csv_column(0, kTimeSymbols, times, "s"), units::csv_column(3, kLengthSymbols, altitudes));
+  // values are parsed in place from the text, with no per-row strings; fields are not quoted, and undeclared fields are skipped
+  // the outputs are replaced, and hold the rows before the first error on failure
+  template <typename... Columns>
+  inline IngestResult ingest_csv(const std::string_view text, const IngestOptions &options, const Columns... columns)
+  {
+    static_assert(sizeof...(Columns) > 0, "ingest needs at least one column");
+    return internal::IngestCsv(text.data(), text.data() + text.size(), options, std::make_tuple(columns...), std::index_sequence_for<Columns...>());
+  }
+
+  // the same, memory-mapping the file
+  template <typename... Columns>
+  inline IngestResult ingest_csv_file(const char *path, const IngestOptions &options, const Columns... columns)
+  {
+    MappedFile file;
+    if (!file.Open(path))
+      return IngestResult{ 0, 0, -1, IngestError::kOpenFailed, ParseError::kNone };
+
+    const char *text = reinterpret_cast<const char *>(file.GetData());
+    return ingest_csv(std::string_view(text, file.GetSize()), options, columns...);
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: CSV ingest
+
+
+#endif
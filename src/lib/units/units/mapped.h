@@ -0,0 +1,416 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_MAPPED_H
+#define UNITS_MAPPED_H
+
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "units/storage.h"
+
+
+// mapped files
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // read-only view of a whole file in memory, paged in on demand by the OS
+  class MappedFile
+  {
+    public:
+      MappedFile() = default;
+      MappedFile(const MappedFile &) = delete;
+      MappedFile &operator=(const MappedFile &) = delete;
+      MappedFile(MappedFile &&other) noexcept : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) { }
+      MappedFile &operator=(MappedFile &&other) noexcept
+      {
+        if (this != &other)
+        {
+          Close();
+          m_data = std::exchange(other.m_data, nullptr);
+          m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+      }
+      ~MappedFile() { Close(); }
+
+      // false if the file cannot be opened or mapped; empty files open with no data
+      bool Open(const char *path) noexcept
+      {
+        Close();
+
+#if defined(_WIN32)
+        const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+          return false;
+
+        LARGE_INTEGER size;
+        bool mapped = false;
+        if (GetFileSizeEx(file, &size))
+        {
+          mapped = (size.QuadPart == 0);
+          const HANDLE mapping = mapped ? nullptr : CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+          if (mapping)
+          {
+            // the view keeps the mapping alive
+            m_data = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            m_size = m_data ? static_cast<std::size_t>(size.QuadPart) : 0;
+            mapped = (m_data != nullptr);
+            CloseHandle(mapping);
+          }
+        }
+        CloseHandle(file);
+        return mapped;
+#else
+        const int file = open(path, O_RDONLY);
+        if (file < 0)
+          return false;
+
+        struct stat status;
+        bool mapped = false;
+        if (fstat(file, &status) == 0)
+        {
+          mapped = (status.st_size == 0);
+          void *data = mapped ? MAP_FAILED : mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+          if (data != MAP_FAILED)
+          {
+            m_data = static_cast<const unsigned char *>(data);
+            m_size = static_cast<std::size_t>(status.st_size);
+            mapped = true;
+          }
+        }
+        close(file);
+        return mapped;
+#endif
+      }
+
+      void Close() noexcept
+      {
+        if (m_data)
+        {
+#if defined(_WIN32)
+          UnmapViewOfFile(m_data);
+#else
+          munmap(const_cast<unsigned char *>(m_data), m_size);
+#endif
+        }
+        m_data = nullptr;
+        m_size = 0;
+      }
+
+      const unsigned char *GetData() const noexcept { return m_data; }
+      std::size_t GetSize() const noexcept { return m_size; }
+
+    private:
+      const unsigned char *m_data = nullptr;
+      std::size_t m_size = 0;
+  };
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: mapped files
+
+
+// column files
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // binary layout, native byte order:
+  //   header, one descriptor per column, then each column's raw values at a 64-byte aligned offset
+  // descriptors carry the full dimension (base IDs, exponents & scale) and the storage type,
+  // so a mapped column is only ever viewed as the exact unit type it was written as
+
+  struct ColumnFileHeader
+  {
+    char m_magic[8];           // "UNITCOL"
+    std::uint32_t m_version;
+    std::uint32_t m_byteOrder; // 0x01020304 as written
+    std::uint32_t m_numColumns;
+    std::uint32_t m_reserved;
+    std::uint64_t m_fileSize;
+  };
+
+  struct ColumnDescriptor
+  {
+    static const int kMaxNameLength = 47;
+
+    char m_name[kMaxNameLength + 1]; // null-terminated
+    std::uint64_t m_ids[kMaxBaseDimensions];
+    std::int32_t m_exponents[kMaxBaseDimensions];
+    std::int64_t m_scaleNumerator;
+    std::int64_t m_scaleDenominator;
+    StorageKind m_storageKind;
+    std::uint16_t m_storageSize;
+    std::uint32_t m_storageParameter;
+    std::uint64_t m_offset;    // from the start of the file
+    std::uint64_t m_count;
+  };
+
+  static_assert(sizeof(ColumnFileHeader) == 32 && sizeof(ColumnDescriptor) == 184, "column file layout must not depend on padding");
+
+  enum class ColumnFileError
+  {
+    kNone,
+    kOpenFailed,
+    kWriteFailed,
+    kNotAColumnFile,     // wrong magic or byte order
+    kUnsupportedVersion,
+    kCorrupt,            // sizes or offsets that do not fit the file
+    kInvalidName,        // empty, too long, or already used
+    kColumnNotFound,
+    kDimensionMismatch,  // the column has other base dimensions or exponents
+    kScaleMismatch,      // the column has the same base dimensions but another scale (e.g. km read as m)
+    kStorageMismatch,    // the column has another storage type (e.g. double read as float)
+  };
+
+  namespace internal
+  {
+    static const std::uint32_t kColumnFileVersion = 1;
+    static const std::uint32_t kColumnFileByteOrder = 0x01020304;
+    static const std::uint64_t kColumnAlignment = 64;
+
+    template <typename Unit>
+    inline ColumnDescriptor DescribeColumn(const std::string_view name, const std::size_t count) noexcept
+    {
+      typedef typename Unit::Storage Storage;
+      ColumnDescriptor descriptor = { };
+      std::memcpy(descriptor.m_name, name.data(), name.size());
+      for (int i = 0; i < kMaxBaseDimensions; ++i)
+      {
+        descriptor.m_ids[i] = Unit::kDimension.m_ids[i];
+        descriptor.m_exponents[i] = Unit::kDimension.m_exponents[i];
+      }
+      descriptor.m_scaleNumerator = Unit::kDimension.m_scaleNumerator;
+      descriptor.m_scaleDenominator = Unit::kDimension.m_scaleDenominator;
+      descriptor.m_storageKind = StorageTypeOf<Storage>::kKind;
+      descriptor.m_storageSize = static_cast<std::uint16_t>(sizeof(Storage));
+      descriptor.m_storageParameter = StorageTypeOf<Storage>::kParameter;
+      descriptor.m_count = count;
+      return descriptor;
+    }
+
+    inline std::uint64_t AlignColumnOffset(const std::uint64_t offset) noexcept
+    {
+      return (offset + kColumnAlignment - 1) & ~(kColumnAlignment - 1);
+    }
+  }
+
+  // collects columns (without copying them) and writes them in one go, e.g.
+  //   units::ColumnFileWriter writer;
+  //   writer.AddColumn("altitude", altitudes); // std::vector<Length>
+  //   writer.AddColumn("time", times);         // std::vector<Time>
+  //   writer.Write("flight.units");
+  // the columns must stay alive until Write returns
+  class ColumnFileWriter
+  {
+    public:
+      template <typename Range>
+      ColumnFileError AddColumn(const std::string_view name, Range &&values)
+      {
+        const auto span = std::span(values);
+        typedef typename std::remove_cv<typename decltype(span)::element_type>::type Unit;
+        static_assert(IsQuantity<Unit>::value, "column files hold unit types");
+
+        if (name.empty() || name.size() > ColumnDescriptor::kMaxNameLength || name.find('\0') != std::string_view::npos)
+          return ColumnFileError::kInvalidName;
+        for (const Column &column : m_columns)
+        {
+          if (name == column.m_descriptor.m_name)
+            return ColumnFileError::kInvalidName;
+        }
+
+        m_columns.push_back(Column{ internal::DescribeColumn<Unit>(name, span.size()), span.data() });
+        return ColumnFileError::kNone;
+      }
+
+      ColumnFileError Write(const char *path) const
+      {
+        std::vector<ColumnDescriptor> descriptors;
+        descriptors.reserve(m_columns.size());
+        std::uint64_t offset = sizeof(ColumnFileHeader) + m_columns.size() * sizeof(ColumnDescriptor);
+        for (const Column &column : m_columns)
+        {
+          descriptors.push_back(column.m_descriptor);
+          descriptors.back().m_offset = internal::AlignColumnOffset(offset);
+          offset = descriptors.back().m_offset + column.m_descriptor.m_count * column.m_descriptor.m_storageSize;
+        }
+
+        ColumnFileHeader header = { { 'U', 'N', 'I', 'T', 'C', 'O', 'L', '\0' }, internal::kColumnFileVersion, internal::kColumnFileByteOrder, static_cast<std::uint32_t>(m_columns.size()), 0, offset };
+
+#if defined(_MSC_VER)
+        std::FILE *file = nullptr;
+        if (fopen_s(&file, path, "wb") != 0)
+          file = nullptr;
+#else
+        std::FILE *file = std::fopen(path, "wb");
+#endif
+        if (!file)
+          return ColumnFileError::kOpenFailed;
+
+        static const unsigned char kPadding[internal::kColumnAlignment] = { };
+        bool written = (std::fwrite(&header, sizeof(header), 1, file) == 1);
+        written = written && (descriptors.empty() || std::fwrite(descriptors.data(), sizeof(ColumnDescriptor), descriptors.size(), file) == descriptors.size());
+        std::uint64_t position = sizeof(ColumnFileHeader) + descriptors.size() * sizeof(ColumnDescriptor);
+        for (std::size_t i = 0; i < descriptors.size() && written; ++i)
+        {
+          const std::size_t padding = static_cast<std::size_t>(descriptors[i].m_offset - position);
+          const std::size_t bytes = static_cast<std::size_t>(descriptors[i].m_count * descriptors[i].m_storageSize);
+          written = (padding == 0 || std::fwrite(kPadding, 1, padding, file) == padding) && (bytes == 0 || std::fwrite(m_columns[i].m_data, 1, bytes, file) == bytes);
+          position = descriptors[i].m_offset + bytes;
+        }
+
+        written = (std::fclose(file) == 0) && written;
+        return written ? ColumnFileError::kNone : ColumnFileError::kWriteFailed;
+      }
+
+    private:
+      struct Column
+      {
+        ColumnDescriptor m_descriptor;
+        const void *m_data;
+      };
+
+      std::vector<Column> m_columns;
+  };
+
+  // a mapped column file; opening only checks the header & descriptors, and columns are zero-copy views into the mapping, e.g.
+  //   units::ColumnFile file;
+  //   std::span<const Length> altitudes;
+  //   if (file.Open("flight.units") == units::ColumnFileError::kNone && file.GetColumn("altitude", altitudes) == units::ColumnFileError::kNone)
+  //     ...
+  // views stay valid until the file is closed
+  class ColumnFile
+  {
+    public:
+      ColumnFileError Open(const char *path) noexcept
+      {
+        Close();
+        if (!m_file.Open(path))
+          return ColumnFileError::kOpenFailed;
+
+        const ColumnFileError error = Validate();
+        if (error != ColumnFileError::kNone)
+          Close();
+        return error;
+      }
+
+      void Close() noexcept
+      {
+        m_file.Close();
+        m_descriptors = std::span<const ColumnDescriptor>();
+      }
+
+      int GetNumColumns() const noexcept { return static_cast<int>(m_descriptors.size()); }
+      const ColumnDescriptor &GetDescriptor(const int i) const noexcept { return m_descriptors[i]; }
+
+      // index of a named column, or -1
+      int Find(const std::string_view name) const noexcept
+      {
+        for (std::size_t i = 0; i < m_descriptors.size(); ++i)
+        {
+          if (name == m_descriptors[i].m_name)
+            return static_cast<int>(i);
+        }
+        return -1;
+      }
+
+      // the column as the unit type it was written as; the view is left untouched on failure
+      template <typename Unit>
+      ColumnFileError GetColumn(const std::string_view name, std::span<const Unit> &values) const noexcept
+      {
+        static_assert(IsQuantity<Unit>::value, "column files hold unit types");
+        typedef typename Unit::Storage Storage;
+
+        const int index = Find(name);
+        if (index < 0)
+          return ColumnFileError::kColumnNotFound;
+
+        const ColumnDescriptor &descriptor = m_descriptors[index];
+        for (int i = 0; i < kMaxBaseDimensions; ++i)
+        {
+          if (descriptor.m_ids[i] != Unit::kDimension.m_ids[i] || descriptor.m_exponents[i] != Unit::kDimension.m_exponents[i])
+            return ColumnFileError::kDimensionMismatch;
+        }
+        if (descriptor.m_scaleNumerator != Unit::kDimension.m_scaleNumerator || descriptor.m_scaleDenominator != Unit::kDimension.m_scaleDenominator)
+          return ColumnFileError::kScaleMismatch;
+        if (descriptor.m_storageKind != internal::StorageTypeOf<Storage>::kKind || descriptor.m_storageSize != sizeof(Storage)
+            || descriptor.m_storageParameter != internal::StorageTypeOf<Storage>::kParameter)
+          return ColumnFileError::kStorageMismatch;
+
+        static_assert(alignof(Unit) <= internal::kColumnAlignment, "column alignment too small for the unit type");
+        values = std::span<const Unit>(reinterpret_cast<const Unit *>(m_file.GetData() + descriptor.m_offset), static_cast<std::size_t>(descriptor.m_count));
+        return ColumnFileError::kNone;
+      }
+
+    private:
+      ColumnFileError Validate() noexcept
+      {
+        const std::size_t size = m_file.GetSize();
+        if (size < sizeof(ColumnFileHeader))
+          return ColumnFileError::kNotAColumnFile;
+
+        ColumnFileHeader header;
+        std::memcpy(&header, m_file.GetData(), sizeof(header));
+        if (std::memcmp(header.m_magic, "UNITCOL", 8) != 0 || header.m_byteOrder != internal::kColumnFileByteOrder)
+          return ColumnFileError::kNotAColumnFile;
+        if (header.m_version != internal::kColumnFileVersion)
+          return ColumnFileError::kUnsupportedVersion;
+        if (header.m_fileSize != size || header.m_numColumns > (size - sizeof(ColumnFileHeader)) / sizeof(ColumnDescriptor))
+          return ColumnFileError::kCorrupt;
+
+        // the mapping is page aligned, so the descriptors right after the 32-byte header are suitably aligned
+        const ColumnDescriptor *descriptors = reinterpret_cast<const ColumnDescriptor *>(m_file.GetData() + sizeof(ColumnFileHeader));
+        const std::uint64_t dataBegin = sizeof(ColumnFileHeader) + std::uint64_t(header.m_numColumns) * sizeof(ColumnDescriptor);
+        for (std::uint32_t i = 0; i < header.m_numColumns; ++i)
+        {
+          const ColumnDescriptor &descriptor = descriptors[i];
+          if (std::memchr(descriptor.m_name, '\0', sizeof(descriptor.m_name)) == nullptr)
+            return ColumnFileError::kCorrupt;
+          if (descriptor.m_storageSize == 0 || descriptor.m_offset % internal::kColumnAlignment != 0 || descriptor.m_offset < dataBegin || descriptor.m_offset > size)
+            return ColumnFileError::kCorrupt;
+          if (descriptor.m_count > (size - descriptor.m_offset) / descriptor.m_storageSize)
+            return ColumnFileError::kCorrupt;
+        }
+
+        m_descriptors = std::span<const ColumnDescriptor>(descriptors, header.m_numColumns);
+        return ColumnFileError::kNone;
+      }
+
+      MappedFile m_file;
+      std::span<const ColumnDescriptor> m_descriptors;
+  };
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: column files
+
+
+#endif
@@ -0,0 +1,408 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_MATH_H
+#define UNITS_MATH_H
+
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "units/batch.h"
+
+
+// math functions
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // std math function on a raw value; number classes (fixed-point, 16-bit floats) go through double
+    template <typename Storage, typename Function>
+    inline Storage ApplyReal(const Storage value, const Function function) noexcept
+    {
+      if constexpr (std::is_arithmetic<Storage>::value)
+        return static_cast<Storage>(function(value));
+      else
+        return static_cast<Storage>(function(static_cast<double>(value)));
+    }
+
+    // repeated multiplication, unrolled at compile time
+    template <int kPower, typename Storage>
+    constexpr Storage PowerOf(const Storage value) noexcept
+    {
+      if constexpr (kPower < 0)
+        return Storage(1) / PowerOf<-kPower>(value);
+      else if constexpr (kPower == 0)
+        return Storage(1);
+      else if constexpr (kPower == 1)
+        return value;
+      else
+      {
+        const Storage half = PowerOf<kPower / 2>(value);
+        return (kPower % 2) ? half * half * value : half * half;
+      }
+    }
+  }
+
+  // e.g. cbrt(Volume) -> Length
+  template <typename Storage, Dimension kDim>
+  inline auto cbrt(const Quantity<Storage, kDim> value) noexcept
+  {
+    constexpr Dimension kResult = RootDimension(kDim, 3);
+    return Quantity<Storage, kResult>::From(internal::ApplyReal(value.GetRaw(), [](const auto x) { return std::cbrt(x); }));
+  }
+
+  // integer powers, e.g. pow<2>(Length) -> Area, pow<-1>(Time) -> Frequency; pow<0> is a raw 1
+  template <int kPower, typename Storage, Dimension kDim>
+  constexpr auto pow(const Quantity<Storage, kDim> value) noexcept
+  {
+    constexpr Dimension kResult = PowerDimension(kDim, kPower);
+    typedef QuantityOf<Storage, kResult> Result;
+    return MakeQuantity<Result, kResult>(internal::PowerOf<kPower>(value.GetRaw()));
+  }
+
+  template <typename Storage, Dimension kDim>
+  inline Quantity<Storage, kDim> abs(const Quantity<Storage, kDim> value) noexcept
+  {
+    if constexpr (std::is_arithmetic<Storage>::value)
+      return Quantity<Storage, kDim>::From(std::abs(value.GetRaw()));
+    else
+      return (value < Quantity<Storage, kDim>::Zero()) ? -value : value;
+  }
+
+  // same conventions as std::min & std::max: the first argument wins ties
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> min(const Quantity<Storage, kDim> lhs, const Quantity<Storage, kDim> rhs) noexcept
+  {
+    return (rhs < lhs) ? rhs : lhs;
+  }
+
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> max(const Quantity<Storage, kDim> lhs, const Quantity<Storage, kDim> rhs) noexcept
+  {
+    return (lhs < rhs) ? rhs : lhs;
+  }
+
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> clamp(const Quantity<Storage, kDim> value, const Quantity<Storage, kDim> lo, const Quantity<Storage, kDim> hi) noexcept
+  {
+    return (value < lo) ? lo : (hi < value) ? hi : value;
+  }
+
+  // a * b + c with a single rounding (one instruction where the target has FMA), e.g. fma(Velocity, Time, Length) -> Length
+  // the addend must have the unit of the product
+  template <typename A, typename B, typename C, typename = typename std::enable_if<IsQuantity<A>::value || IsQuantity<B>::value>::type>
+  inline C fma(const A a, const B b, const C c) noexcept
+  {
+    static_assert(std::is_same<decltype(a * b), C>::value, "fma addend unit must be the product of the multiplied units");
+    if constexpr (IsQuantity<C>::value)
+      return C::From(internal::ApplyReal(internal::RawValue(a), [&](const auto x) { return std::fma(x, static_cast<decltype(x)>(internal::RawValue(b)), static_cast<decltype(x)>(c.GetRaw())); }));
+    else
+      return a * b + c; // dimensionless products may carry a scale that only the product operator applies
+  }
+
+  // sqrt(a^2 + b^2) without intermediate overflow or underflow, e.g. hypot(Length, Length) -> Length
+  template <typename Storage, Dimension kDim>
+  inline Quantity<Storage, kDim> hypot(const Quantity<Storage, kDim> a, const Quantity<Storage, kDim> b) noexcept
+  {
+    return Quantity<Storage, kDim>::From(internal::ApplyReal(a.GetRaw(), [&](const auto x) { return std::hypot(x, static_cast<decltype(x)>(b.GetRaw())); }));
+  }
+
+  // a + (b - a) * t for a raw interpolant t, exact at both ends
+  template <typename Storage, Dimension kDim, typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+  inline Quantity<Storage, kDim> lerp(const Quantity<Storage, kDim> a, const Quantity<Storage, kDim> b, const T t) noexcept
+  {
+    if constexpr (std::is_floating_point<Storage>::value)
+      return Quantity<Storage, kDim>::From(std::lerp(a.GetRaw(), b.GetRaw(), static_cast<Storage>(t)));
+    else
+      return a + (b - a) * t;
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: math functions
+
+
+// precision policy
+// ------------------------------------------------------------------------------------------------------------------------------
+
+// sqrt, rsqrt, reciprocal, exp, log & divide take a precision policy, e.g. units::sqrt<units::Precision::kFast>(area)
+// the default is exact; define UNITS_FAST_MATH for a whole translation unit (e.g. next to _RELEASE or _SHIP) to default to fast
+// the defaulted functions live in an inline namespace named after the default, so translation units built either way can be
+// linked together without ODR violations
+#if defined(UNITS_FAST_MATH)
+  #define UNITS_PRECISION_NAMESPACE fast_precision
+#else
+  #define UNITS_PRECISION_NAMESPACE exact_precision
+#endif
+
+namespace units
+{
+  enum class Precision
+  {
+    kExact, // std math, correctly rounded where the standard library is
+    kFast,  // float approximations with the max relative errors documented below; other storage types stay exact
+  };
+
+  namespace internal
+  {
+    // the approximations are plain float & integer arithmetic with selects instead of branches, so loops over them vectorize
+    // (GCC only turns the selects of exp & log into blends with -fno-trapping-math), and they give bit-identical results on every
+    // target, unlike rsqrtps/rcpps, whose estimates differ between CPU vendors
+    // rsqrt, sqrt & reciprocal take one Newton step, trading precision for latency as graphics & control loops can (sqrtps & divps
+    // are already fast where they are fully pipelined, so measure before switching; see the benchmark project)
+
+    // max relative error 1.8e-3; inputs must be positive and finite, subnormals included
+    // integer estimate (max relative error 3.4%) refined by one Newton step
+    inline float FastReciprocalSqrt(const float x) noexcept
+    {
+      // subnormals are scaled by 2^24 into range, and the result back by 2^12 (1 / sqrt(2^24) = 2^-12 is exact);
+      // the factors are built in the exponent field rather than selected, since GCC turns float selects into branches that block vectorization
+      const std::uint32_t subnormal = ((std::bit_cast<std::uint32_t>(x) & 0x7f800000u) == 0);
+      const float scaled = x * std::bit_cast<float>(0x3f800000u + (subnormal * (24u << 23)));
+      const float half = 0.5f * scaled;
+      float y = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<std::uint32_t>(scaled) >> 1));
+      y = y * (1.5f - half * y * y);
+      return y * std::bit_cast<float>(0x3f800000u + (subnormal * (12u << 23)));
+    }
+
+    // max relative error 1.8e-3; inputs must be non-negative and finite, subnormals included (the estimate of 1 / sqrt(0) is finite, so 0 maps to 0)
+    inline float FastSqrt(const float x) noexcept
+    {
+      return x * FastReciprocalSqrt(x);
+    }
+
+    // max relative error 1.03e-2; inputs must be normal with a magnitude below 2^126, so the result is normal too
+    // integer estimate (max relative error 12%) refined by one Newton step
+    inline float FastReciprocal(const float x) noexcept
+    {
+      const float y = std::bit_cast<float>(0x7ef311c3u - std::bit_cast<std::uint32_t>(x));
+      return y * (2.0f - x * y);
+    }
+
+    // max relative error 2.6e-7; results below FLT_MIN flush to zero, results above FLT_MAX are infinite
+    // x = n * ln(2) + r with |r| <= ln(2) / 2, exp(r) by a degree-6 polynomial, 2^n by two exponent-field multiplies
+    inline float FastExp(const float x) noexcept
+    {
+      const float kMin = -87.33654f; // ln(FLT_MIN)
+      const float kMax = 88.72283f;  // ln(FLT_MAX)
+      const float clamped = (x < kMin) ? kMin : (x > kMax) ? kMax : x;
+
+      const float kRound = 12582912.0f; // 1.5 * 2^23, rounds to the nearest integer without a library call
+      const float n = (clamped * 1.44269504f + kRound) - kRound;
+      const float r = (clamped - n * 0.693145751953125f) - n * 1.428606765330187e-06f; // ln(2) split in two for an exact product
+      float p = 1.0f / 720.0f;
+      p = p * r + 1.0f / 120.0f;
+      p = p * r + 1.0f / 24.0f;
+      p = p * r + 1.0f / 6.0f;
+      p = p * r + 0.5f;
+      p = p * r + 1.0f;
+      p = p * r + 1.0f;
+
+      const int exponent = static_cast<int>(n);
+      const int half = exponent / 2;
+      const float lo = std::bit_cast<float>(static_cast<std::uint32_t>(half + 127) << 23);
+      const float hi = std::bit_cast<float>(static_cast<std::uint32_t>(exponent - half + 127) << 23);
+      const float result = p * lo * hi;
+      return (x < kMin) ? 0.0f : (x > kMax) ? std::numeric_limits<float>::infinity() : (x != x) ? x : result;
+    }
+
+    // max relative error 2.3e-7; log(0) is -infinity, log(+infinity) is +infinity, negative & NaN inputs are NaN
+    // x = m * 2^e with m in [sqrt(1/2), sqrt(2)), log(m) = 2 * atanh((m - 1) / (m + 1)) by a degree-9 odd series
+    inline float FastLog(const float x) noexcept
+    {
+      const bool subnormal = (x < std::numeric_limits<float>::min());
+      const std::uint32_t bits = std::bit_cast<std::uint32_t>(subnormal ? x * 8388608.0f : x); // 2^23 brings subnormals into range
+      const bool large = ((bits & 0x007fffffu) > 0x003504f3u); // mantissa above sqrt(2)
+      const float m = std::bit_cast<float>((bits & 0x007fffffu) | (large ? 0x3f000000u : 0x3f800000u));
+      const int exponent = static_cast<int>(bits >> 23) - (large ? 126 : 127) - (subnormal ? 23 : 0);
+
+      const float s = (m - 1.0f) / (m + 1.0f);
+      const float s2 = s * s;
+      float p = 1.0f / 9.0f;
+      p = p * s2 + 1.0f / 7.0f;
+      p = p * s2 + 1.0f / 5.0f;
+      p = p * s2 + 1.0f / 3.0f;
+      p = p * s2 + 1.0f;
+      const float result = static_cast<float>(exponent) * 0.693147180559945f + 2.0f * s * p;
+
+      const float kInfinity = std::numeric_limits<float>::infinity();
+      return (x > 0.0f && x < kInfinity) ? result : (x == 0.0f) ? -kInfinity : (x == kInfinity) ? x : std::numeric_limits<float>::quiet_NaN();
+    }
+
+    template <Precision kPrecision, typename Storage>
+    struct IsFastPath : std::integral_constant<bool, kPrecision == Precision::kFast && std::is_same<Storage, float>::value> { };
+  }
+
+  inline namespace UNITS_PRECISION_NAMESPACE
+  {
+#if defined(UNITS_FAST_MATH)
+    static constexpr Precision kDefaultPrecision = Precision::kFast;
+#else
+    static constexpr Precision kDefaultPrecision = Precision::kExact;
+#endif
+
+    // e.g. sqrt(Area) -> Length; the dimension (and scale) must have an exact square root, checked at compile time
+    template <Precision kPrecision = kDefaultPrecision, typename Storage, Dimension kDim>
+    inline auto sqrt(const Quantity<Storage, kDim> value) noexcept
+    {
+      constexpr Dimension kResult = RootDimension(kDim, 2);
+      if constexpr (internal::IsFastPath<kPrecision, Storage>::value)
+        return Quantity<Storage, kResult>::From(internal::FastSqrt(value.GetRaw()));
+      else
+        return Quantity<Storage, kResult>::From(internal::ApplyReal(value.GetRaw(), [](const auto x) { return std::sqrt(x); }));
+    }
+
+    // 1 / sqrt(value), e.g. rsqrt(Area) -> 1 / Length, or a raw scalar for raw scalars
+    template <Precision kPrecision = kDefaultPrecision, typename T>
+    inline auto rsqrt(const T value) noexcept
+    {
+      typedef typename StorageOf<T>::Type Storage;
+      const Storage raw = internal::RawValue(value);
+      Storage result;
+      if constexpr (internal::IsFastPath<kPrecision, Storage>::value)
+        result = internal::FastReciprocalSqrt(raw);
+      else
+        result = internal::ApplyReal(raw, [](const auto x) { return decltype(x)(1) / std::sqrt(x); });
+
+      if constexpr (IsQuantity<T>::value)
+        return Quantity<Storage, InvertDimension(RootDimension(T::kDimension, 2))>::From(result);
+      else
+        return result;
+    }
+
+    // 1 / value, e.g. reciprocal(Time) -> Frequency, or a raw scalar for raw scalars
+    template <Precision kPrecision = kDefaultPrecision, typename T>
+    inline auto reciprocal(const T value) noexcept
+    {
+      typedef typename StorageOf<T>::Type Storage;
+      const Storage raw = internal::RawValue(value);
+      Storage result;
+      if constexpr (internal::IsFastPath<kPrecision, Storage>::value)
+        result = internal::FastReciprocal(raw);
+      else
+        result = Storage(1) / raw;
+
+      if constexpr (IsQuantity<T>::value)
+        return Quantity<Storage, InvertDimension(T::kDimension)>::From(result);
+      else
+        return result;
+    }
+
+    // lhs / rhs with the same result type as operator/, e.g. divide<Precision::kFast>(Length, Time) -> Velocity
+    // the fast path multiplies by the fast reciprocal: max relative error 1.04e-2
+    template <Precision kPrecision = kDefaultPrecision, typename Lhs, typename Rhs, typename = typename std::enable_if<IsQuantity<Lhs>::value || IsQuantity<Rhs>::value>::type>
+    inline auto divide(const Lhs lhs, const Rhs rhs) noexcept
+    {
+      typedef typename StorageOf<Lhs>::Type LhsStorage;
+      typedef typename StorageOf<Rhs>::Type RhsStorage;
+      if constexpr (internal::IsFastPath<kPrecision, LhsStorage>::value && internal::IsFastPath<kPrecision, RhsStorage>::value)
+        return lhs * reciprocal<kPrecision>(rhs);
+      else
+        return lhs / rhs;
+    }
+
+    // exponentials and logarithms only exist for dimensionless values, which are raw storage
+    template <Precision kPrecision = kDefaultPrecision, typename T>
+    inline T exp(const T value) noexcept
+    {
+      static_assert(std::is_arithmetic<T>::value, "exp requires a dimensionless value");
+      if constexpr (internal::IsFastPath<kPrecision, T>::value)
+        return internal::FastExp(value);
+      else
+        return std::exp(value);
+    }
+
+    template <Precision kPrecision = kDefaultPrecision, typename T>
+    inline T log(const T value) noexcept
+    {
+      static_assert(std::is_arithmetic<T>::value, "log requires a dimensionless value");
+      if constexpr (internal::IsFastPath<kPrecision, T>::value)
+        return internal::FastLog(value);
+      else
+        return std::log(value);
+    }
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: precision policy
+
+
+// batch math functions
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // out[i] = sqrt(in[i]), e.g. areas -> lengths
+  template <typename In, typename Out>
+  inline void sqrt(const In &in, Out &&out)
+  {
+    typedef decltype(units::sqrt(internal::RangeValue<In>())) Root;
+    static_assert(std::is_same<Root, internal::RangeValue<Out>>::value, "sqrt output unit must be the square root of the input unit");
+
+    const auto a = raw_span(std::span(in));
+    internal::BatchUnary<internal::UnaryOp::kSqrt>(a.data(), internal::OutputSpan(out, a.size()).data(), a.size());
+  }
+
+  // out[i] = |in[i]|
+  template <typename In, typename Out>
+  inline void abs(const In &in, Out &&out)
+  {
+    static_assert(std::is_same<internal::RangeValue<In>, internal::RangeValue<Out>>::value, "abs requires identical units");
+
+    const auto a = raw_span(std::span(in));
+    internal::BatchUnary<internal::UnaryOp::kAbs>(a.data(), internal::OutputSpan(out, a.size()).data(), a.size());
+  }
+
+  // out[i] = min(lhs[i], rhs[i]); unlike the scalar form, rhs wins ties and NaNs (minps/minpd semantics)
+  template <typename Lhs, typename Rhs, typename Out>
+  inline void min(const Lhs &lhs, const Rhs &rhs, Out &&out)
+  {
+    typedef internal::RangeValue<Lhs> Unit;
+    static_assert(std::is_same<Unit, internal::RangeValue<Rhs>>::value && std::is_same<Unit, internal::RangeValue<Out>>::value, "min requires identical units");
+
+    const auto a = raw_span(std::span(lhs));
+    const auto b = raw_span(std::span(rhs));
+    assert(a.size() == b.size() && "batch operands must have the same size");
+    internal::BatchBinary<internal::BinaryOp::kMin>(a.data(), b.data(), internal::OutputSpan(out, a.size()).data(), a.size());
+  }
+
+  // out[i] = max(lhs[i], rhs[i]); rhs wins ties and NaNs (maxps/maxpd semantics)
+  template <typename Lhs, typename Rhs, typename Out>
+  inline void max(const Lhs &lhs, const Rhs &rhs, Out &&out)
+  {
+    typedef internal::RangeValue<Lhs> Unit;
+    static_assert(std::is_same<Unit, internal::RangeValue<Rhs>>::value && std::is_same<Unit, internal::RangeValue<Out>>::value, "max requires identical units");
+
+    const auto a = raw_span(std::span(lhs));
+    const auto b = raw_span(std::span(rhs));
+    assert(a.size() == b.size() && "batch operands must have the same size");
+    internal::BatchBinary<internal::BinaryOp::kMax>(a.data(), b.data(), internal::OutputSpan(out, a.size()).data(), a.size());
+  }
+
+  // out[i] = clamp(in[i], lo, hi) for single-value bounds
+  template <typename In, typename Unit, typename Out>
+  inline void clamp(const In &in, const Unit lo, const Unit hi, Out &&out)
+  {
+    static_assert(std::is_same<Unit, internal::RangeValue<In>>::value && std::is_same<Unit, internal::RangeValue<Out>>::value, "clamp requires identical units");
+
+    const auto a = raw_span(std::span(in));
+    internal::BatchClamp(a.data(), internal::RawValue(lo), internal::RawValue(hi), internal::OutputSpan(out, a.size()).data(), a.size());
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: batch math functions
+
+
+#endif
@@ -0,0 +1,340 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_MATRIX_H
+#define UNITS_MATRIX_H
+
+
+#include <cassert>
+#include <span>
+
+#include "units/vector.h"
+
+
+// matrices
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // dimensionless 3x3 matrix (rotation, scale, shear) that maps vectors of any unit to vectors of the same unit
+  // column-major, each column padded to four lanes like Vec3, so a matrix-vector product is three multiply-adds of whole columns
+  template <typename StorageType>
+  class Mat3
+  {
+    static_assert(std::is_arithmetic<StorageType>::value, "matrix elements are raw scalars");
+
+    public:
+      typedef StorageType Storage;
+
+      Mat3() = default;
+
+      static constexpr Mat3 Identity() noexcept
+      {
+        return FromColumns(Vec3<Storage>(1, 0, 0), Vec3<Storage>(0, 1, 0), Vec3<Storage>(0, 0, 1));
+      }
+
+      static constexpr Mat3 FromColumns(const Vec3<Storage> &c0, const Vec3<Storage> &c1, const Vec3<Storage> &c2) noexcept
+      {
+        Mat3 result;
+        result.m_columns[0] = c0;
+        result.m_columns[1] = c1;
+        result.m_columns[2] = c2;
+        return result;
+      }
+
+      constexpr Vec3<Storage> Column(const int col) const noexcept { return m_columns[col]; }
+      constexpr Storage operator()(const int row, const int col) const noexcept { return m_columns[col][row]; }
+      constexpr Storage &operator()(const int row, const int col) noexcept { return m_columns[col][row]; }
+
+      // e.g. Mat3<float> * Vec3<Velocity> -> Vec3<Velocity>
+      template <typename Unit>
+      constexpr Vec3<Unit> operator*(const Vec3<Unit> &v) const noexcept
+      {
+        Vec3<Unit> result = Vec3<Unit>::Zero();
+        for (int i = 0; i < Vec3<Unit>::kNumLanes; ++i) // pad lanes are zero in every column
+          result[i] = v[0] * m_columns[0][i] + v[1] * m_columns[1][i] + v[2] * m_columns[2][i];
+        return result;
+      }
+
+      constexpr Mat3 operator*(const Mat3 &rhs) const noexcept
+      {
+        return FromColumns(*this * rhs.m_columns[0], *this * rhs.m_columns[1], *this * rhs.m_columns[2]);
+      }
+
+      constexpr Mat3 Transposed() const noexcept
+      {
+        Mat3 result = *this;
+        for (int row = 0; row < 3; ++row)
+          for (int col = 0; col < 3; ++col)
+            result(row, col) = (*this)(col, row);
+        return result;
+      }
+
+      // cofactors over the determinant; singular matrices are not allowed
+      constexpr Mat3 Inverse() const noexcept
+      {
+        const Vec3<Storage> r0 = cross(m_columns[1], m_columns[2]);
+        const Vec3<Storage> r1 = cross(m_columns[2], m_columns[0]);
+        const Vec3<Storage> r2 = cross(m_columns[0], m_columns[1]);
+        const Storage inverseDeterminant = Storage(1) / dot(m_columns[0], r0);
+        return FromColumns(r0 * inverseDeterminant, r1 * inverseDeterminant, r2 * inverseDeterminant).Transposed();
+      }
+
+      constexpr bool operator==(const Mat3 &rhs) const noexcept { return m_columns[0] == rhs.m_columns[0] && m_columns[1] == rhs.m_columns[1] && m_columns[2] == rhs.m_columns[2]; }
+      constexpr bool operator!=(const Mat3 &rhs) const noexcept { return !(*this == rhs); }
+
+    private:
+      Vec3<Storage> m_columns[3];
+  };
+
+  // rotation quaternion of raw scalars (x, y, z vector part, w scalar part), rotating vectors of any unit
+  template <typename StorageType>
+  class Quaternion
+  {
+    static_assert(std::is_arithmetic<StorageType>::value, "quaternion elements are raw scalars");
+
+    public:
+      typedef StorageType Storage;
+
+      Quaternion() = default;
+      constexpr Quaternion(const Storage x, const Storage y, const Storage z, const Storage w) noexcept : m_xyzw(x, y, z, w) { }
+
+      static constexpr Quaternion Identity() noexcept { return Quaternion(0, 0, 0, 1); }
+
+      // axis must be unit-length; angle in radians
+      static Quaternion FromAxisAngle(const Vec3<Storage> &axis, const Storage angle) noexcept
+      {
+        const Storage s = std::sin(angle / 2);
+        return Quaternion(axis.X() * s, axis.Y() * s, axis.Z() * s, std::cos(angle / 2));
+      }
+
+      constexpr Storage X() const noexcept { return m_xyzw.X(); }
+      constexpr Storage Y() const noexcept { return m_xyzw.Y(); }
+      constexpr Storage Z() const noexcept { return m_xyzw.Z(); }
+      constexpr Storage W() const noexcept { return m_xyzw.W(); }
+      constexpr Vec3<Storage> GetVector() const noexcept { return Vec3<Storage>(X(), Y(), Z()); }
+
+      // inverse of a unit quaternion
+      constexpr Quaternion Conjugate() const noexcept { return Quaternion(-X(), -Y(), -Z(), W()); }
+
+      Quaternion Normalized() const noexcept
+      {
+        const Vec4<Storage> xyzw = m_xyzw / std::sqrt(length_squared(m_xyzw));
+        return Quaternion(xyzw.X(), xyzw.Y(), xyzw.Z(), xyzw.W());
+      }
+
+      // this after rhs
+      constexpr Quaternion operator*(const Quaternion &rhs) const noexcept
+      {
+        return Quaternion
+        (
+          W() * rhs.X() + X() * rhs.W() + Y() * rhs.Z() - Z() * rhs.Y(),
+          W() * rhs.Y() - X() * rhs.Z() + Y() * rhs.W() + Z() * rhs.X(),
+          W() * rhs.Z() + X() * rhs.Y() - Y() * rhs.X() + Z() * rhs.W(),
+          W() * rhs.W() - X() * rhs.X() - Y() * rhs.Y() - Z() * rhs.Z()
+        );
+      }
+
+      // v + 2w (q x v) + 2 q x (q x v), units preserved
+      template <typename Unit>
+      constexpr Vec3<Unit> Rotate(const Vec3<Unit> &v) const noexcept
+      {
+        const Vec3<Storage> q = GetVector();
+        const Vec3<Unit> t = cross(q, v) * Storage(2);
+        return v + t * W() + cross(q, t);
+      }
+
+      // for rotating many vectors, a matrix is cheaper per vector
+      constexpr Mat3<Storage> ToMat3() const noexcept
+      {
+        const Storage xx = X() * X(), yy = Y() * Y(), zz = Z() * Z();
+        const Storage xy = X() * Y(), xz = X() * Z(), yz = Y() * Z();
+        const Storage wx = W() * X(), wy = W() * Y(), wz = W() * Z();
+        return Mat3<Storage>::FromColumns
+        (
+          Vec3<Storage>(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy)),
+          Vec3<Storage>(2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx)),
+          Vec3<Storage>(2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy))
+        );
+      }
+
+    private:
+      Vec4<Storage> m_xyzw;
+  };
+
+  // affine 4x4 frame transform: dimensionless 3x3 linear part plus a translation in TranslationUnit, e.g. Mat4<Length>;
+  // the last row is implied to be (0, 0, 0, 1), so points must be in the translation's unit while free vectors (velocities, forces)
+  // take only the linear part; stored as four padded columns, column-major
+  template <typename TranslationUnit>
+  class Mat4
+  {
+    public:
+      typedef TranslationUnit Unit;
+      typedef decltype(internal::RawOf(Unit())) Storage;
+
+      Mat4() = default;
+
+      static constexpr Mat4 Identity() noexcept { return FromRotationTranslation(Mat3<Storage>::Identity(), Vec3<Unit>::Zero()); }
+
+      static constexpr Mat4 FromRotationTranslation(const Mat3<Storage> &linear, const Vec3<Unit> &translation) noexcept
+      {
+        Mat4 result;
+        result.m_linear = linear;
+        result.m_translation = translation;
+        return result;
+      }
+
+      static constexpr Mat4 FromRotationTranslation(const Quaternion<Storage> &rotation, const Vec3<Unit> &translation) noexcept
+      {
+        return FromRotationTranslation(rotation.ToMat3(), translation);
+      }
+
+      constexpr Mat3<Storage> GetLinear() const noexcept { return m_linear; }
+      constexpr Vec3<Unit> GetTranslation() const noexcept { return m_translation; }
+
+      // raw elements, including the implied last row
+      constexpr Storage operator()(const int row, const int col) const noexcept
+      {
+        if (row == 3)
+          return (col == 3) ? Storage(1) : Storage(0);
+        return (col == 3) ? internal::RawOf(m_translation[row]) : m_linear(row, col);
+      }
+
+      constexpr Vec3<Unit> TransformPoint(const Vec3<Unit> &p) const noexcept { return m_linear * p + m_translation; }
+
+      template <typename VectorUnit>
+      constexpr Vec3<VectorUnit> TransformVector(const Vec3<VectorUnit> &v) const noexcept { return m_linear * v; }
+
+      // this after rhs
+      constexpr Mat4 operator*(const Mat4 &rhs) const noexcept
+      {
+        return FromRotationTranslation(m_linear * rhs.m_linear, TransformPoint(rhs.m_translation));
+      }
+
+      constexpr Mat4 Inverse() const noexcept
+      {
+        const Mat3<Storage> inverseLinear = m_linear.Inverse();
+        return FromRotationTranslation(inverseLinear, -(inverseLinear * m_translation));
+      }
+
+      // cheaper inverse for rotations plus translations (orthonormal linear part)
+      constexpr Mat4 InverseRigid() const noexcept
+      {
+        const Mat3<Storage> inverseLinear = m_linear.Transposed();
+        return FromRotationTranslation(inverseLinear, -(inverseLinear * m_translation));
+      }
+
+    private:
+      Mat3<Storage> m_linear;
+      Vec3<Unit> m_translation;
+  };
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: matrices
+
+
+// batch transforms
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    template <typename Range>
+    using VecRangeValue = typename std::remove_cv<typename decltype(std::span(std::declval<Range &>()))::element_type>::type;
+  }
+
+  // out[i] = frame.TransformPoint(points[i]), over arrays of Vec3 (e.g. sensor points to world space); out may alias points
+  template <typename Unit, typename In, typename Out>
+  inline void transform_points(const Mat4<Unit> &frame, const In &points, Out &&out)
+  {
+    static_assert(std::is_same<internal::VecRangeValue<In>, Vec3<Unit>>::value && std::is_same<internal::VecRangeValue<Out>, Vec3<Unit>>::value, "points must be in the frame's translation unit");
+    const auto in = std::span(points);
+    const auto result = std::span(out);
+    assert(in.size() == result.size() && "batch operands must have the same size");
+
+    const Mat3<typename Mat4<Unit>::Storage> linear = frame.GetLinear();
+    const Vec3<Unit> translation = frame.GetTranslation();
+    for (std::size_t i = 0; i < in.size(); ++i)
+      result[i] = linear * in[i] + translation;
+  }
+
+  // structure-of-arrays version (e.g. UnitSoA columns), vectorized across points rather than within each point
+  template <typename Unit>
+  inline void transform_points
+  (
+    const Mat4<Unit> &frame,
+    const std::type_identity_t<std::span<const Unit>> xs, const std::type_identity_t<std::span<const Unit>> ys, const std::type_identity_t<std::span<const Unit>> zs,
+    const std::type_identity_t<std::span<Unit>> outXs, const std::type_identity_t<std::span<Unit>> outYs, const std::type_identity_t<std::span<Unit>> outZs
+  )
+  {
+    typedef typename Mat4<Unit>::Storage Storage;
+    const std::size_t n = xs.size();
+    assert(ys.size() == n && zs.size() == n && outXs.size() == n && outYs.size() == n && outZs.size() == n && "batch operands must have the same size");
+
+    Storage m[3][4];
+    for (int row = 0; row < 3; ++row)
+      for (int col = 0; col < 4; ++col)
+        m[row][col] = frame(row, col);
+
+    // staged through local blocks, so outputs may alias inputs while the compiler still vectorizes the arithmetic
+    const std::size_t kBlock = 64;
+    Storage x[kBlock], y[kBlock], z[kBlock];
+    for (std::size_t begin = 0; begin < n; begin += kBlock)
+    {
+      const std::size_t count = (n - begin < kBlock) ? n - begin : kBlock;
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        x[i] = internal::RawOf(xs[begin + i]);
+        y[i] = internal::RawOf(ys[begin + i]);
+        z[i] = internal::RawOf(zs[begin + i]);
+      }
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        const Storage px = x[i], py = y[i], pz = z[i];
+        x[i] = m[0][0] * px + m[0][1] * py + m[0][2] * pz + m[0][3];
+        y[i] = m[1][0] * px + m[1][1] * py + m[1][2] * pz + m[1][3];
+        z[i] = m[2][0] * px + m[2][1] * py + m[2][2] * pz + m[2][3];
+      }
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        outXs[begin + i] = internal::FromRaw<Unit>(x[i]);
+        outYs[begin + i] = internal::FromRaw<Unit>(y[i]);
+        outZs[begin + i] = internal::FromRaw<Unit>(z[i]);
+      }
+    }
+  }
+
+  // out[i] = linear * vectors[i], for free vectors of any unit (velocities, forces); out may alias vectors
+  template <typename Storage, typename In, typename Out>
+  inline void transform_vectors(const Mat3<Storage> &linear, const In &vectors, Out &&out)
+  {
+    typedef internal::VecRangeValue<In> Vector;
+    static_assert(std::is_same<Vector, internal::VecRangeValue<Out>>::value, "transformed vectors keep their unit");
+    const auto in = std::span(vectors);
+    const auto result = std::span(out);
+    assert(in.size() == result.size() && "batch operands must have the same size");
+
+    for (std::size_t i = 0; i < in.size(); ++i)
+      result[i] = linear * in[i];
+  }
+
+  // out[i] = rotation.Rotate(vectors[i]), through the equivalent matrix
+  template <typename Storage, typename In, typename Out>
+  inline void rotate(const Quaternion<Storage> &rotation, const In &vectors, Out &&out)
+  {
+    transform_vectors(rotation.ToMat3(), vectors, out);
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: batch transforms
+
+
+#endif
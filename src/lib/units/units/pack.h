@@ -0,0 +1,662 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_PACK_H
+#define UNITS_PACK_H
+
+
+#include <cstdint>
+#include <type_traits>
+
+#include "units/simd.h"
+#include "units/units.h"
+
+
+// packs
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // native register backing kWidth lanes of T, where the compiler targets an instruction set that has one (UNITS_SIMD_BASELINE);
+    // masks are kept as whole-lane bit patterns, or as mask registers on AVX-512
+    template <typename T, int kWidth>
+    struct PackRegister
+    {
+      static const bool kNative = false;
+    };
+
+#if UNITS_SIMD_BASELINE >= 1
+    template <>
+    struct PackRegister<float, 4>
+    {
+      static const bool kNative = true;
+      static const int kNumLanes = 4;
+      static const unsigned kAllBits = 0xf;
+      typedef __m128 Type;
+      typedef __m128 MaskType;
+
+      static Type Load(const float *p) noexcept { return _mm_load_ps(p); }
+      static Type LoadUnaligned(const float *p) noexcept { return _mm_loadu_ps(p); }
+      static void Store(float *p, const Type a) noexcept { _mm_store_ps(p, a); }
+      static void StoreUnaligned(float *p, const Type a) noexcept { _mm_storeu_ps(p, a); }
+      static Type Broadcast(const float value) noexcept { return _mm_set1_ps(value); }
+
+      static Type Add(const Type a, const Type b) noexcept { return _mm_add_ps(a, b); }
+      static Type Subtract(const Type a, const Type b) noexcept { return _mm_sub_ps(a, b); }
+      static Type Multiply(const Type a, const Type b) noexcept { return _mm_mul_ps(a, b); }
+      static Type Divide(const Type a, const Type b) noexcept { return _mm_div_ps(a, b); }
+      static Type Negate(const Type a) noexcept { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+
+      static MaskType Greater(const Type a, const Type b) noexcept { return _mm_cmpgt_ps(a, b); }
+      static MaskType GreaterEqual(const Type a, const Type b) noexcept { return _mm_cmpge_ps(a, b); }
+      static MaskType Less(const Type a, const Type b) noexcept { return _mm_cmplt_ps(a, b); }
+      static MaskType LessEqual(const Type a, const Type b) noexcept { return _mm_cmple_ps(a, b); }
+      static MaskType Equal(const Type a, const Type b) noexcept { return _mm_cmpeq_ps(a, b); }
+      static MaskType NotEqual(const Type a, const Type b) noexcept { return _mm_cmpneq_ps(a, b); }
+
+      static MaskType LoadMask(const std::int32_t *p) noexcept { return _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i *>(p))); }
+      static void StoreMask(std::int32_t *p, const MaskType m) noexcept { _mm_store_si128(reinterpret_cast<__m128i *>(p), _mm_castps_si128(m)); }
+      static MaskType And(const MaskType a, const MaskType b) noexcept { return _mm_and_ps(a, b); }
+      static MaskType Or(const MaskType a, const MaskType b) noexcept { return _mm_or_ps(a, b); }
+      static MaskType Not(const MaskType a) noexcept { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+      static unsigned Bits(const MaskType m) noexcept { return unsigned(_mm_movemask_ps(m)); }
+      static Type Select(const MaskType m, const Type ifTrue, const Type ifFalse) noexcept { return _mm_or_ps(_mm_and_ps(m, ifTrue), _mm_andnot_ps(m, ifFalse)); }
+    };
+
+    template <>
+    struct PackRegister<double, 2>
+    {
+      static const bool kNative = true;
+      static const int kNumLanes = 2;
+      static const unsigned kAllBits = 0x3;
+      typedef __m128d Type;
+      typedef __m128d MaskType;
+
+      static Type Load(const double *p) noexcept { return _mm_load_pd(p); }
+      static Type LoadUnaligned(const double *p) noexcept { return _mm_loadu_pd(p); }
+      static void Store(double *p, const Type a) noexcept { _mm_store_pd(p, a); }
+      static void StoreUnaligned(double *p, const Type a) noexcept { _mm_storeu_pd(p, a); }
+      static Type Broadcast(const double value) noexcept { return _mm_set1_pd(value); }
+
+      static Type Add(const Type a, const Type b) noexcept { return _mm_add_pd(a, b); }
+      static Type Subtract(const Type a, const Type b) noexcept { return _mm_sub_pd(a, b); }
+      static Type Multiply(const Type a, const Type b) noexcept { return _mm_mul_pd(a, b); }
+      static Type Divide(const Type a, const Type b) noexcept { return _mm_div_pd(a, b); }
+      static Type Negate(const Type a) noexcept { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+
+      static MaskType Greater(const Type a, const Type b) noexcept { return _mm_cmpgt_pd(a, b); }
+      static MaskType GreaterEqual(const Type a, const Type b) noexcept { return _mm_cmpge_pd(a, b); }
+      static MaskType Less(const Type a, const Type b) noexcept { return _mm_cmplt_pd(a, b); }
+      static MaskType LessEqual(const Type a, const Type b) noexcept { return _mm_cmple_pd(a, b); }
+      static MaskType Equal(const Type a, const Type b) noexcept { return _mm_cmpeq_pd(a, b); }
+      static MaskType NotEqual(const Type a, const Type b) noexcept { return _mm_cmpneq_pd(a, b); }
+
+      static MaskType LoadMask(const std::int64_t *p) noexcept { return _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i *>(p))); }
+      static void StoreMask(std::int64_t *p, const MaskType m) noexcept { _mm_store_si128(reinterpret_cast<__m128i *>(p), _mm_castpd_si128(m)); }
+      static MaskType And(const MaskType a, const MaskType b) noexcept { return _mm_and_pd(a, b); }
+      static MaskType Or(const MaskType a, const MaskType b) noexcept { return _mm_or_pd(a, b); }
+      static MaskType Not(const MaskType a) noexcept { return _mm_xor_pd(a, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+      static unsigned Bits(const MaskType m) noexcept { return unsigned(_mm_movemask_pd(m)); }
+      static Type Select(const MaskType m, const Type ifTrue, const Type ifFalse) noexcept { return _mm_or_pd(_mm_and_pd(m, ifTrue), _mm_andnot_pd(m, ifFalse)); }
+    };
+#endif
+
+#if UNITS_SIMD_BASELINE >= 2
+    template <>
+    struct PackRegister<float, 8>
+    {
+      static const bool kNative = true;
+      static const int kNumLanes = 8;
+      static const unsigned kAllBits = 0xff;
+      typedef __m256 Type;
+      typedef __m256 MaskType;
+
+      static Type Load(const float *p) noexcept { return _mm256_load_ps(p); }
+      static Type LoadUnaligned(const float *p) noexcept { return _mm256_loadu_ps(p); }
+      static void Store(float *p, const Type a) noexcept { _mm256_store_ps(p, a); }
+      static void StoreUnaligned(float *p, const Type a) noexcept { _mm256_storeu_ps(p, a); }
+      static Type Broadcast(const float value) noexcept { return _mm256_set1_ps(value); }
+
+      static Type Add(const Type a, const Type b) noexcept { return _mm256_add_ps(a, b); }
+      static Type Subtract(const Type a, const Type b) noexcept { return _mm256_sub_ps(a, b); }
+      static Type Multiply(const Type a, const Type b) noexcept { return _mm256_mul_ps(a, b); }
+      static Type Divide(const Type a, const Type b) noexcept { return _mm256_div_ps(a, b); }
+      static Type Negate(const Type a) noexcept { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+
+      static MaskType Greater(const Type a, const Type b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+      static MaskType GreaterEqual(const Type a, const Type b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+      static MaskType Less(const Type a, const Type b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+      static MaskType LessEqual(const Type a, const Type b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+      static MaskType Equal(const Type a, const Type b) noexcept { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+      static MaskType NotEqual(const Type a, const Type b) noexcept { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+
+      static MaskType LoadMask(const std::int32_t *p) noexcept { return _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i *>(p))); }
+      static void StoreMask(std::int32_t *p, const MaskType m) noexcept { _mm256_store_si256(reinterpret_cast<__m256i *>(p), _mm256_castps_si256(m)); }
+      static MaskType And(const MaskType a, const MaskType b) noexcept { return _mm256_and_ps(a, b); }
+      static MaskType Or(const MaskType a, const MaskType b) noexcept { return _mm256_or_ps(a, b); }
+      static MaskType Not(const MaskType a) noexcept { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+      static unsigned Bits(const MaskType m) noexcept { return unsigned(_mm256_movemask_ps(m)); }
+      static Type Select(const MaskType m, const Type ifTrue, const Type ifFalse) noexcept { return _mm256_blendv_ps(ifFalse, ifTrue, m); }
+    };
+
+    template <>
+    struct PackRegister<double, 4>
+    {
+      static const bool kNative = true;
+      static const int kNumLanes = 4;
+      static const unsigned kAllBits = 0xf;
+      typedef __m256d Type;
+      typedef __m256d MaskType;
+
+      static Type Load(const double *p) noexcept { return _mm256_load_pd(p); }
+      static Type LoadUnaligned(const double *p) noexcept { return _mm256_loadu_pd(p); }
+      static void Store(double *p, const Type a) noexcept { _mm256_store_pd(p, a); }
+      static void StoreUnaligned(double *p, const Type a) noexcept { _mm256_storeu_pd(p, a); }
+      static Type Broadcast(const double value) noexcept { return _mm256_set1_pd(value); }
+
+      static Type Add(const Type a, const Type b) noexcept { return _mm256_add_pd(a, b); }
+      static Type Subtract(const Type a, const Type b) noexcept { return _mm256_sub_pd(a, b); }
+      static Type Multiply(const Type a, const Type b) noexcept { return _mm256_mul_pd(a, b); }
+      static Type Divide(const Type a, const Type b) noexcept { return _mm256_div_pd(a, b); }
+      static Type Negate(const Type a) noexcept { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+
+      static MaskType Greater(const Type a, const Type b) noexcept { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+      static MaskType GreaterEqual(const Type a, const Type b) noexcept { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+      static MaskType Less(const Type a, const Type b) noexcept { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+      static MaskType LessEqual(const Type a, const Type b) noexcept { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+      static MaskType Equal(const Type a, const Type b) noexcept { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+      static MaskType NotEqual(const Type a, const Type b) noexcept { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+
+      static MaskType LoadMask(const std::int64_t *p) noexcept { return _mm256_castsi256_pd(_mm256_load_si256(reinterpret_cast<const __m256i *>(p))); }
+      static void StoreMask(std::int64_t *p, const MaskType m) noexcept { _mm256_store_si256(reinterpret_cast<__m256i *>(p), _mm256_castpd_si256(m)); }
+      static MaskType And(const MaskType a, const MaskType b) noexcept { return _mm256_and_pd(a, b); }
+      static MaskType Or(const MaskType a, const MaskType b) noexcept { return _mm256_or_pd(a, b); }
+      static MaskType Not(const MaskType a) noexcept { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi32(-1))); }
+      static unsigned Bits(const MaskType m) noexcept { return unsigned(_mm256_movemask_pd(m)); }
+      static Type Select(const MaskType m, const Type ifTrue, const Type ifFalse) noexcept { return _mm256_blendv_pd(ifFalse, ifTrue, m); }
+    };
+#endif
+
+#if UNITS_SIMD_BASELINE >= 3
+    template <>
+    struct PackRegister<float, 16>
+    {
+      static const bool kNative = true;
+      static const int kNumLanes = 16;
+      static const unsigned kAllBits = 0xffff;
+      typedef __m512 Type;
+      typedef __mmask16 MaskType;
+
+      static Type Load(const float *p) noexcept { return _mm512_load_ps(p); }
+      static Type LoadUnaligned(const float *p) noexcept { return _mm512_loadu_ps(p); }
+      static void Store(float *p, const Type a) noexcept { _mm512_store_ps(p, a); }
+      static void StoreUnaligned(float *p, const Type a) noexcept { _mm512_storeu_ps(p, a); }
+      static Type Broadcast(const float value) noexcept { return _mm512_set1_ps(value); }
+
+      static Type Add(const Type a, const Type b) noexcept { return _mm512_add_ps(a, b); }
+      static Type Subtract(const Type a, const Type b) noexcept { return _mm512_sub_ps(a, b); }
+      static Type Multiply(const Type a, const Type b) noexcept { return _mm512_mul_ps(a, b); }
+      static Type Divide(const Type a, const Type b) noexcept { return _mm512_div_ps(a, b); }
+      static Type Negate(const Type a) noexcept { return _mm512_xor_ps(a, _mm512_set1_ps(-0.0f)); }
+
+      static MaskType Greater(const Type a, const Type b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+      static MaskType GreaterEqual(const Type a, const Type b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+      static MaskType Less(const Type a, const Type b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+      static MaskType LessEqual(const Type a, const Type b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+      static MaskType Equal(const Type a, const Type b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+      static MaskType NotEqual(const Type a, const Type b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+
+      static MaskType LoadMask(const std::int32_t *p) noexcept { const __m512i lanes = _mm512_load_si512(p); return _mm512_test_epi32_mask(lanes, lanes); }
+      static void StoreMask(std::int32_t *p, const MaskType m) noexcept { _mm512_store_si512(p, _mm512_maskz_set1_epi32(m, -1)); }
+      static MaskType And(const MaskType a, const MaskType b) noexcept { return MaskType(a & b); }
+      static MaskType Or(const MaskType a, const MaskType b) noexcept { return MaskType(a | b); }
+      static MaskType Not(const MaskType a) noexcept { return MaskType(~a); }
+      static unsigned Bits(const MaskType m) noexcept { return unsigned(m); }
+      static Type Select(const MaskType m, const Type ifTrue, const Type ifFalse) noexcept { return _mm512_mask_blend_ps(m, ifFalse, ifTrue); }
+    };
+
+    template <>
+    struct PackRegister<double, 8>
+    {
+      static const bool kNative = true;
+      static const int kNumLanes = 8;
+      static const unsigned kAllBits = 0xff;
+      typedef __m512d Type;
+      typedef __mmask8 MaskType;
+
+      static Type Load(const double *p) noexcept { return _mm512_load_pd(p); }
+      static Type LoadUnaligned(const double *p) noexcept { return _mm512_loadu_pd(p); }
+      static void Store(double *p, const Type a) noexcept { _mm512_store_pd(p, a); }
+      static void StoreUnaligned(double *p, const Type a) noexcept { _mm512_storeu_pd(p, a); }
+      static Type Broadcast(const double value) noexcept { return _mm512_set1_pd(value); }
+
+      static Type Add(const Type a, const Type b) noexcept { return _mm512_add_pd(a, b); }
+      static Type Subtract(const Type a, const Type b) noexcept { return _mm512_sub_pd(a, b); }
+      static Type Multiply(const Type a, const Type b) noexcept { return _mm512_mul_pd(a, b); }
+      static Type Divide(const Type a, const Type b) noexcept { return _mm512_div_pd(a, b); }
+      static Type Negate(const Type a) noexcept { return _mm512_xor_pd(a, _mm512_set1_pd(-0.0)); }
+
+      static MaskType Greater(const Type a, const Type b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+      static MaskType GreaterEqual(const Type a, const Type b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+      static MaskType Less(const Type a, const Type b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+      static MaskType LessEqual(const Type a, const Type b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+      static MaskType Equal(const Type a, const Type b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+      static MaskType NotEqual(const Type a, const Type b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_NEQ_UQ); }
+
+      static MaskType LoadMask(const std::int64_t *p) noexcept { const __m512i lanes = _mm512_load_si512(p); return _mm512_test_epi64_mask(lanes, lanes); }
+      static void StoreMask(std::int64_t *p, const MaskType m) noexcept { _mm512_store_si512(p, _mm512_maskz_set1_epi64(m, -1)); }
+      static MaskType And(const MaskType a, const MaskType b) noexcept { return MaskType(a & b); }
+      static MaskType Or(const MaskType a, const MaskType b) noexcept { return MaskType(a | b); }
+      static MaskType Not(const MaskType a) noexcept { return MaskType(~a); }
+      static unsigned Bits(const MaskType m) noexcept { return unsigned(m); }
+      static Type Select(const MaskType m, const Type ifTrue, const Type ifFalse) noexcept { return _mm512_mask_blend_pd(m, ifFalse, ifTrue); }
+    };
+#endif
+
+    // widest native register a pack splits evenly into (lane counts are powers of two), or a non-native one
+    template <typename T, int kLanes>
+    struct PackRegisterSelect
+    {
+      typedef typename std::conditional<PackRegister<T, kLanes>::kNative, PackRegister<T, kLanes>, typename PackRegisterSelect<T, kLanes / 2>::Type>::type Type;
+    };
+
+    template <typename T>
+    struct PackRegisterSelect<T, 0>
+    {
+      typedef PackRegister<T, 0> Type;
+    };
+
+    template <typename T, int kLanes>
+    using PackRegisterOf = typename PackRegisterSelect<T, kLanes>::Type;
+  }
+
+  // lane-wise comparison result of two packs, one all-ones or all-zeros integer per lane (same lane width as the pack)
+  template <typename T, int kLanes>
+  class PackMask
+  {
+    public:
+      typedef typename std::conditional<sizeof(T) == 8, std::int64_t, typename std::conditional<sizeof(T) == 4, std::int32_t, std::int16_t>::type>::type Lane;
+      static const int kNumLanes = kLanes;
+      typedef internal::PackRegisterOf<T, kLanes> Register;
+
+      constexpr bool operator[](const int lane) const noexcept { return m_lanes[lane] != 0; }
+      constexpr void Set(const int lane, const bool value) noexcept { m_lanes[lane] = value ? Lane(-1) : Lane(0); }
+
+      #define UNITS_PACK_MASK_BINARY_OP(Op, Name)                                                                                      \
+        constexpr PackMask operator Op(const PackMask rhs) const noexcept                                                              \
+        {                                                                                                                              \
+          PackMask result = { };                                                                                                       \
+          if constexpr (Register::kNative)                                                                                             \
+          {                                                                                                                            \
+            if (!std::is_constant_evaluated())                                                                                         \
+            {                                                                                                                          \
+              for (int i = 0; i < kLanes; i += Register::kNumLanes)                                                                    \
+                Register::StoreMask(result.m_lanes + i, Register::Name(Register::LoadMask(m_lanes + i), Register::LoadMask(rhs.m_lanes + i))); \
+              return result;                                                                                                           \
+            }                                                                                                                          \
+          }                                                                                                                            \
+          for (int i = 0; i < kLanes; ++i)                                                                                             \
+            result.m_lanes[i] = m_lanes[i] Op rhs.m_lanes[i];                                                                          \
+          return result;                                                                                                               \
+        }                                                                                                                              \
+
+      UNITS_PACK_MASK_BINARY_OP(&, And)
+      UNITS_PACK_MASK_BINARY_OP(|, Or)
+
+      #undef UNITS_PACK_MASK_BINARY_OP
+
+      constexpr PackMask operator~() const noexcept
+      {
+        PackMask result = { };
+        if constexpr (Register::kNative)
+        {
+          if (!std::is_constant_evaluated())
+          {
+            for (int i = 0; i < kLanes; i += Register::kNumLanes)
+              Register::StoreMask(result.m_lanes + i, Register::Not(Register::LoadMask(m_lanes + i)));
+            return result;
+          }
+        }
+        for (int i = 0; i < kLanes; ++i)
+          result.m_lanes[i] = ~m_lanes[i];
+        return result;
+      }
+
+      alignas(kLanes * sizeof(Lane)) Lane m_lanes[kLanes];
+  };
+
+  template <typename T, int kLanes>
+  constexpr bool any(const PackMask<T, kLanes> mask) noexcept
+  {
+    typedef typename PackMask<T, kLanes>::Register Register;
+    if constexpr (Register::kNative)
+    {
+      if (!std::is_constant_evaluated())
+      {
+        unsigned bits = 0;
+        for (int i = 0; i < kLanes; i += Register::kNumLanes)
+          bits |= Register::Bits(Register::LoadMask(mask.m_lanes + i));
+        return bits != 0;
+      }
+    }
+
+    typename PackMask<T, kLanes>::Lane result = 0;
+    for (int i = 0; i < kLanes; ++i)
+      result |= mask.m_lanes[i];
+    return result != 0;
+  }
+
+  template <typename T, int kLanes>
+  constexpr bool all(const PackMask<T, kLanes> mask) noexcept
+  {
+    typedef typename PackMask<T, kLanes>::Register Register;
+    if constexpr (Register::kNative)
+    {
+      if (!std::is_constant_evaluated())
+      {
+        unsigned bits = Register::kAllBits;
+        for (int i = 0; i < kLanes; i += Register::kNumLanes)
+          bits &= Register::Bits(Register::LoadMask(mask.m_lanes + i));
+        return bits == Register::kAllBits;
+      }
+    }
+
+    typename PackMask<T, kLanes>::Lane result = -1;
+    for (int i = 0; i < kLanes; ++i)
+      result &= mask.m_lanes[i];
+    return result != 0;
+  }
+
+  template <typename T, int kLanes>
+  constexpr bool none(const PackMask<T, kLanes> mask) noexcept
+  {
+    return !any(mask);
+  }
+
+  // fixed-width group of lanes usable as a unit storage type, e.g. eight lengths in one AVX register:
+  //   typedef units::PackOf<Length, 8> Length8;
+  // float & double packs run on the native registers of the targeted instruction set (see internal::PackRegister),
+  // one or more per pack; other lane types, and constant evaluation, use plain lane loops;
+  // dimensions are still checked by the Quantity wrapper
+  template <typename T, int kLanes>
+  class Pack
+  {
+    static_assert(kLanes > 0 && (kLanes & (kLanes - 1)) == 0, "pack lane count must be a power of two");
+
+    public:
+      typedef T Scalar;
+      typedef PackMask<T, kLanes> Mask;
+      typedef internal::PackRegisterOf<T, kLanes> Register;
+      static const int kNumLanes = kLanes;
+
+      Pack() = default;
+      constexpr explicit Pack(const T value) noexcept : m_lanes()
+      {
+        if constexpr (Register::kNative)
+        {
+          if (!std::is_constant_evaluated())
+          {
+            for (int i = 0; i < kLanes; i += Register::kNumLanes)
+              Register::Store(m_lanes + i, Register::Broadcast(value));
+            return;
+          }
+        }
+        for (int i = 0; i < kLanes; ++i)
+          m_lanes[i] = value;
+      }
+
+      // broadcast from any arithmetic value, so Quantity::From & Zero work on packs
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      constexpr explicit Pack(const V value) noexcept : Pack(static_cast<T>(value)) { }
+
+      static Pack Load(const T *p) noexcept
+      {
+        Pack result;
+        if constexpr (Register::kNative)
+        {
+          for (int i = 0; i < kLanes; i += Register::kNumLanes)
+            Register::Store(result.m_lanes + i, Register::LoadUnaligned(p + i));
+        }
+        else
+        {
+          for (int i = 0; i < kLanes; ++i)
+            result.m_lanes[i] = p[i];
+        }
+        return result;
+      }
+
+      void Store(T *p) const noexcept
+      {
+        if constexpr (Register::kNative)
+        {
+          for (int i = 0; i < kLanes; i += Register::kNumLanes)
+            Register::StoreUnaligned(p + i, Register::Load(m_lanes + i));
+        }
+        else
+        {
+          for (int i = 0; i < kLanes; ++i)
+            p[i] = m_lanes[i];
+        }
+      }
+
+      constexpr T operator[](const int lane) const noexcept { return m_lanes[lane]; }
+      constexpr T &operator[](const int lane) noexcept { return m_lanes[lane]; }
+
+      #define UNITS_PACK_BINARY_OP(Op, Name)                                                                                           \
+        friend constexpr Pack operator Op(const Pack lhs, const Pack rhs) noexcept                                                     \
+        {                                                                                                                              \
+          Pack result = lhs;                                                                                                           \
+          if constexpr (Register::kNative)                                                                                             \
+          {                                                                                                                            \
+            if (!std::is_constant_evaluated())                                                                                         \
+            {                                                                                                                          \
+              for (int i = 0; i < kLanes; i += Register::kNumLanes)                                                                    \
+                Register::Store(result.m_lanes + i, Register::Name(Register::Load(lhs.m_lanes + i), Register::Load(rhs.m_lanes + i)));   \
+              return result;                                                                                                           \
+            }                                                                                                                          \
+          }                                                                                                                            \
+          for (int i = 0; i < kLanes; ++i)                                                                                             \
+            result.m_lanes[i] = lhs.m_lanes[i] Op rhs.m_lanes[i];                                                                      \
+          return result;                                                                                                               \
+        }                                                                                                                              \
+        friend constexpr Pack operator Op(const Pack lhs, const T rhs) noexcept { return lhs Op Pack(rhs); }                           \
+        friend constexpr Pack operator Op(const T lhs, const Pack rhs) noexcept { return Pack(lhs) Op rhs; }                           \
+        constexpr Pack &operator Op##=(const Pack rhs) noexcept { return *this = *this Op rhs; }                                       \
+        constexpr Pack &operator Op##=(const T rhs) noexcept { return *this = *this Op Pack(rhs); }                                    \
+
+      #define UNITS_PACK_COMPARISON_OP(Op, Name)                                                                                       \
+        friend constexpr Mask operator Op(const Pack lhs, const Pack rhs) noexcept                                                     \
+        {                                                                                                                              \
+          Mask result = { };                                                                                                           \
+          if constexpr (Register::kNative)                                                                                             \
+          {                                                                                                                            \
+            if (!std::is_constant_evaluated())                                                                                         \
+            {                                                                                                                          \
+              for (int i = 0; i < kLanes; i += Register::kNumLanes)                                                                    \
+                Register::StoreMask(result.m_lanes + i, Register::Name(Register::Load(lhs.m_lanes + i), Register::Load(rhs.m_lanes + i))); \
+              return result;                                                                                                           \
+            }                                                                                                                          \
+          }                                                                                                                            \
+          for (int i = 0; i < kLanes; ++i)                                                                                             \
+            result.Set(i, lhs.m_lanes[i] Op rhs.m_lanes[i]);                                                                           \
+          return result;                                                                                                               \
+        }                                                                                                                              \
+
+      UNITS_PACK_BINARY_OP(+, Add)
+      UNITS_PACK_BINARY_OP(-, Subtract)
+      UNITS_PACK_BINARY_OP(*, Multiply)
+      UNITS_PACK_BINARY_OP(/, Divide)
+      UNITS_PACK_COMPARISON_OP(>, Greater)
+      UNITS_PACK_COMPARISON_OP(>=, GreaterEqual)
+      UNITS_PACK_COMPARISON_OP(<, Less)
+      UNITS_PACK_COMPARISON_OP(<=, LessEqual)
+      UNITS_PACK_COMPARISON_OP(==, Equal)
+      UNITS_PACK_COMPARISON_OP(!=, NotEqual)
+
+      #undef UNITS_PACK_BINARY_OP
+      #undef UNITS_PACK_COMPARISON_OP
+
+      constexpr Pack operator+() const noexcept { return *this; }
+      constexpr Pack operator-() const noexcept
+      {
+        Pack result = *this;
+        if constexpr (Register::kNative)
+        {
+          if (!std::is_constant_evaluated())
+          {
+            for (int i = 0; i < kLanes; i += Register::kNumLanes)
+              Register::Store(result.m_lanes + i, Register::Negate(Register::Load(m_lanes + i)));
+            return result;
+          }
+        }
+        for (int i = 0; i < kLanes; ++i)
+          result.m_lanes[i] = -m_lanes[i];
+        return result;
+      }
+
+      alignas(kLanes * sizeof(T)) T m_lanes[kLanes];
+  };
+
+  template <typename T, int kLanes>
+  constexpr Pack<T, kLanes> Select(const PackMask<T, kLanes> mask, const Pack<T, kLanes> ifTrue, const Pack<T, kLanes> ifFalse) noexcept
+  {
+    typedef internal::PackRegisterOf<T, kLanes> Register;
+    Pack<T, kLanes> result = ifFalse;
+    if constexpr (Register::kNative)
+    {
+      if (!std::is_constant_evaluated())
+      {
+        for (int i = 0; i < kLanes; i += Register::kNumLanes)
+          Register::Store(result.m_lanes + i, Register::Select(Register::LoadMask(mask.m_lanes + i), Register::Load(ifTrue.m_lanes + i), Register::Load(ifFalse.m_lanes + i)));
+        return result;
+      }
+    }
+    for (int i = 0; i < kLanes; ++i)
+      result.m_lanes[i] = mask.m_lanes[i] ? ifTrue.m_lanes[i] : ifFalse.m_lanes[i];
+    return result;
+  }
+
+  template <typename T> struct IsPack : std::false_type { };
+  template <typename T, int kLanes> struct IsPack<Pack<T, kLanes>> : std::true_type { };
+
+  // packed version of a scalar unit, and back
+  template <typename Unit, int kLanes>
+  using PackOf = Quantity<Pack<typename Unit::Storage, kLanes>, Unit::kDimension>;
+
+  template <typename PackedUnit>
+  using ScalarOf = Quantity<typename PackedUnit::Storage::Scalar, PackedUnit::kDimension>;
+
+  namespace internal
+  {
+    template <typename T, int kLanes>
+    struct StorageLimits<Pack<T, kLanes>>
+    {
+      static constexpr Pack<T, kLanes> Max() noexcept { return Pack<T, kLanes>(StorageLimits<T>::Max()); }
+      static constexpr Pack<T, kLanes> Lowest() noexcept { return Pack<T, kLanes>(StorageLimits<T>::Lowest()); }
+    };
+
+    template <typename T, int kLanes>
+    struct IsFloatingStorage<Pack<T, kLanes>> : IsFloatingStorage<T> { };
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: packs
+
+
+// packed units
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  template <typename PackedUnit>
+  inline PackedUnit load(const ScalarOf<PackedUnit> *units) noexcept
+  {
+    return PackedUnit::From(PackedUnit::Storage::Load(reinterpret_cast<const typename PackedUnit::Storage::Scalar *>(units)));
+  }
+
+  template <typename T, int kLanes, Dimension kDim>
+  inline void store(Quantity<T, kDim> *units, const Quantity<Pack<T, kLanes>, kDim> packed) noexcept
+  {
+    packed.GetRaw().Store(reinterpret_cast<T *>(units));
+  }
+
+  template <typename PackedUnit>
+  constexpr PackedUnit broadcast(const ScalarOf<PackedUnit> unit) noexcept
+  {
+    return PackedUnit::From(typename PackedUnit::Storage(unit.GetRaw()));
+  }
+
+  template <typename T, int kLanes, Dimension kDim>
+  constexpr Quantity<T, kDim> get_lane(const Quantity<Pack<T, kLanes>, kDim> packed, const int lane) noexcept
+  {
+    return Quantity<T, kDim>::From(packed.GetRaw()[lane]);
+  }
+
+  template <typename T, int kLanes, Dimension kDim>
+  constexpr Quantity<Pack<T, kLanes>, kDim> select(const PackMask<T, kLanes> mask, const Quantity<Pack<T, kLanes>, kDim> ifTrue, const Quantity<Pack<T, kLanes>, kDim> ifFalse) noexcept
+  {
+    return Quantity<Pack<T, kLanes>, kDim>::From(Select(mask, ifTrue.GetRaw(), ifFalse.GetRaw()));
+  }
+
+  // horizontal reductions, pairwise so the lane tree matches what shuffles would do
+  // raw packs (e.g. dimensionless ratios) reduce to raw scalars
+
+  template <typename T, int kLanes>
+  constexpr T horizontal_sum(Pack<T, kLanes> lanes) noexcept
+  {
+    for (int width = kLanes / 2; width > 0; width /= 2)
+      for (int i = 0; i < width; ++i)
+        lanes.m_lanes[i] = lanes.m_lanes[i] + lanes.m_lanes[i + width];
+    return lanes.m_lanes[0];
+  }
+
+  template <typename T, int kLanes>
+  constexpr T horizontal_min(Pack<T, kLanes> lanes) noexcept
+  {
+    for (int width = kLanes / 2; width > 0; width /= 2)
+      for (int i = 0; i < width; ++i)
+        lanes.m_lanes[i] = (lanes.m_lanes[i + width] < lanes.m_lanes[i]) ? lanes.m_lanes[i + width] : lanes.m_lanes[i];
+    return lanes.m_lanes[0];
+  }
+
+  template <typename T, int kLanes>
+  constexpr T horizontal_max(Pack<T, kLanes> lanes) noexcept
+  {
+    for (int width = kLanes / 2; width > 0; width /= 2)
+      for (int i = 0; i < width; ++i)
+        lanes.m_lanes[i] = (lanes.m_lanes[i] < lanes.m_lanes[i + width]) ? lanes.m_lanes[i + width] : lanes.m_lanes[i];
+    return lanes.m_lanes[0];
+  }
+
+  template <typename T, int kLanes, Dimension kDim>
+  constexpr Quantity<T, kDim> horizontal_sum(const Quantity<Pack<T, kLanes>, kDim> packed) noexcept
+  {
+    return Quantity<T, kDim>::From(horizontal_sum(packed.GetRaw()));
+  }
+
+  template <typename T, int kLanes, Dimension kDim>
+  constexpr Quantity<T, kDim> horizontal_min(const Quantity<Pack<T, kLanes>, kDim> packed) noexcept
+  {
+    return Quantity<T, kDim>::From(horizontal_min(packed.GetRaw()));
+  }
+
+  template <typename T, int kLanes, Dimension kDim>
+  constexpr Quantity<T, kDim> horizontal_max(const Quantity<Pack<T, kLanes>, kDim> packed) noexcept
+  {
+    return Quantity<T, kDim>::From(horizontal_max(packed.GetRaw()));
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: packed units
+
+
+#endif
@@ -0,0 +1,298 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_PARSE_H
+#define UNITS_PARSE_H
+
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <system_error>
+
+#include "units/span.h"
+#include "units/symbol.h"
+
+
+// parsing
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  enum class ParseError
+  {
+    kNone,
+    kInvalidNumber,      // the text does not start with a number
+    kMissingUnit,        // a number without a unit symbol
+    kUnknownUnit,        // a unit symbol that is not in the symbol set
+    kOutOfRange,         // the value does not fit the target storage
+    kInexact,            // integer targets: the value has a fraction in the target unit (e.g. 1.5 ns into whole nanoseconds)
+    kTrailingCharacters, // columns: something other than the delimiter follows a value
+  };
+
+  // like std::from_chars_result: where parsing stopped (one past the symbol on success, at the offending text on failure)
+  struct ParseResult
+  {
+    const char *m_end;
+    ParseError m_error;
+
+    constexpr explicit operator bool() const noexcept { return m_error == ParseError::kNone; }
+  };
+
+  struct ColumnParseResult
+  {
+    std::size_t m_count; // values written
+    const char *m_end;   // where parsing stopped
+    ParseError m_error;
+
+    constexpr explicit operator bool() const noexcept { return m_error == ParseError::kNone; }
+  };
+
+  namespace internal
+  {
+    constexpr bool IsBlank(const char c) noexcept
+    {
+      return c == ' ' || c == '\t';
+    }
+
+    // symbols run up to white space, control characters, ',' & ';', or the column delimiter
+    constexpr bool IsSymbolEnd(const char c, const char delimiter) noexcept
+    {
+      return static_cast<unsigned char>(c) <= ' ' || c == ',' || c == ';' || c == delimiter;
+    }
+
+    inline const char *SkipBlanks(const char *first, const char *last) noexcept
+    {
+      while (first != last && IsBlank(*first))
+        ++first;
+      return first;
+    }
+
+    // Clinger's fast path: a decimal with at most 2^53 as its digits and a power-of-ten exponent within +/-22 is one exactly
+    // representable integer times or over one exactly representable power of ten, so a single multiply or divide is correctly
+    // rounded; typical log & CSV numbers (e.g. 12.5, 3.2e-3) take it, everything else goes through std::from_chars
+    // null if the text is not such a decimal
+    inline const char *ParseSimpleDecimal(const char *first, const char *last, double &value) noexcept
+    {
+      static const double kPowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+      const unsigned long long kMaxMantissa = 1ull << 53;
+
+      const char *p = first;
+      const bool negative = (p != last && *p == '-');
+      p += negative;
+
+      unsigned long long mantissa = 0;
+      int numDigits = 0;
+      int exponent = 0;
+      for (; p != last && static_cast<unsigned>(*p - '0') < 10; ++p, ++numDigits)
+        mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+      if (p != last && *p == '.')
+      {
+        ++p;
+        for (; p != last && static_cast<unsigned>(*p - '0') < 10; ++p, ++numDigits, --exponent)
+          mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+      }
+      if (numDigits == 0 || numDigits > 19 || mantissa > kMaxMantissa)
+        return nullptr;
+
+      if (p != last && (*p == 'e' || *p == 'E'))
+      {
+        const char *e = p + 1;
+        const bool negativeExponent = (e != last && *e == '-');
+        e += (e != last && (*e == '-' || *e == '+'));
+        int explicitExponent = 0;
+        const char *exponentDigits = e;
+        for (; e != last && static_cast<unsigned>(*e - '0') < 10 && e - exponentDigits < 4; ++e)
+          explicitExponent = explicitExponent * 10 + (*e - '0');
+        if (e == exponentDigits || (e != last && static_cast<unsigned>(*e - '0') < 10))
+          return nullptr;
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        p = e;
+      }
+      if (exponent < -22 || exponent > 22)
+        return nullptr;
+
+      const double magnitude = (exponent < 0) ? static_cast<double>(mantissa) / kPowersOfTen[-exponent] : static_cast<double>(mantissa) * kPowersOfTen[exponent];
+      value = negative ? -magnitude : magnitude;
+      return p;
+    }
+
+    // value in the target unit, checked against the target storage range; integer storage must come out whole
+    template <typename Storage>
+    inline ParseError ScaleParsed(const double parsed, const long long numerator, const long long denominator, Storage &result) noexcept
+    {
+      double value = parsed;
+      if (denominator == 1)
+        value *= static_cast<double>(numerator);
+      else if (numerator == 1)
+        value /= static_cast<double>(denominator);
+      else
+        value = value * static_cast<double>(numerator) / static_cast<double>(denominator);
+
+      if constexpr (std::is_integral<Storage>::value)
+      {
+        // one past max() is a power of two, exact in double even where max() itself would round up (e.g. 64-bit storage)
+        const double upper = std::ldexp(1.0, std::numeric_limits<Storage>::digits);
+        const double lower = std::is_unsigned<Storage>::value ? 0.0 : -upper;
+        if (!(value >= lower && value < upper))
+          return ParseError::kOutOfRange;
+        if (std::trunc(value) != value)
+          return ParseError::kInexact;
+      }
+      else
+      {
+        const double max = static_cast<double>(std::numeric_limits<Storage>::max());
+        if (std::abs(value) > max && std::abs(parsed) <= std::numeric_limits<double>::max())
+          return ParseError::kOutOfRange;
+      }
+
+      result = static_cast<Storage>(value);
+      return ParseError::kNone;
+    }
+
+    // widest integer of the storage's signedness, so whole numbers parse into the full range of unsigned storage too
+    template <typename Storage>
+    using ParsedInteger = typename std::conditional<std::is_unsigned<Storage>::value, unsigned long long, long long>::type;
+
+    // whole numbers into integer storage stay in integer arithmetic, so 64-bit counts (e.g. nanoseconds) are exact
+    template <typename Storage>
+    inline ParseError ScaleParsed(const ParsedInteger<Storage> parsed, const long long numerator, const long long denominator, Storage &result) noexcept
+    {
+      typedef ParsedInteger<Storage> Integer;
+      const Integer factor = static_cast<Integer>(numerator);
+      if (parsed > std::numeric_limits<Integer>::max() / factor || parsed < std::numeric_limits<Integer>::lowest() / factor)
+        return ParseError::kOutOfRange;
+
+      const Integer scaled = parsed * factor;
+      if (scaled % static_cast<Integer>(denominator))
+        return ParseError::kInexact;
+
+      const Integer value = scaled / static_cast<Integer>(denominator);
+      if (value < static_cast<Integer>(std::numeric_limits<Storage>::lowest()) || value > static_cast<Integer>(std::numeric_limits<Storage>::max()))
+        return ParseError::kOutOfRange;
+
+      result = static_cast<Storage>(value);
+      return ParseError::kNone;
+    }
+
+    // bare numbers take the unit of bareEntry, if given (e.g. a CSV column whose header names the unit)
+    template <typename Unit, int kNumSymbols>
+    inline ParseResult Parse(const char *first, const char *last, Unit &value, const SymbolSet<Unit, kNumSymbols> &symbols, const char delimiter,
+                             const typename SymbolSet<Unit, kNumSymbols>::Entry *bareEntry = nullptr) noexcept
+    {
+      typedef typename Unit::Storage Storage;
+
+      first = SkipBlanks(first, last);
+      const char *number = first;
+      if (number != last && *number == '+' && number + 1 != last && number[1] != '-')
+        ++number; // std::from_chars does not take a leading '+'
+
+      // integer storage parses whole numbers as integers, and everything else (fractions, exponents) as double
+      bool isInteger = false;
+      ParsedInteger<Storage> integer = 0;
+      double real = 0.0;
+      std::from_chars_result parsed = { number, std::errc() };
+      if constexpr (std::is_integral<Storage>::value)
+      {
+        parsed = std::from_chars(number, last, integer);
+        isInteger = (parsed.ec == std::errc() && (parsed.ptr == last || (*parsed.ptr != '.' && *parsed.ptr != 'e' && *parsed.ptr != 'E')));
+      }
+      if (!isInteger)
+      {
+        const char *simple = ParseSimpleDecimal(number, last, real);
+        parsed = simple ? std::from_chars_result{ simple, std::errc() } : std::from_chars(number, last, real);
+      }
+
+      if (parsed.ec == std::errc::invalid_argument)
+        return ParseResult{ first, ParseError::kInvalidNumber };
+      if (parsed.ec == std::errc::result_out_of_range)
+        return ParseResult{ first, ParseError::kOutOfRange };
+
+      const char *symbol = SkipBlanks(parsed.ptr, last);
+      const char *end = symbol;
+      std::uint32_t hash = BeginSymbolHash(symbols.GetSeed());
+      for (; end != last && !IsSymbolEnd(*end, delimiter); ++end)
+        hash = StepSymbolHash(hash, *end);
+      if (end == symbol && !bareEntry)
+        return ParseResult{ symbol, ParseError::kMissingUnit };
+
+      const auto *entry = (end == symbol) ? bareEntry : symbols.Find(std::string_view(symbol, static_cast<std::size_t>(end - symbol)), EndSymbolHash(hash));
+      if (!entry)
+        return ParseResult{ symbol, ParseError::kUnknownUnit };
+
+      Storage result = Storage();
+      ParseError error = ParseError::kNone;
+      if constexpr (std::is_integral<Storage>::value)
+        error = isInteger ? ScaleParsed<Storage>(integer, entry->m_numerator, entry->m_denominator, result) : ScaleParsed(real, entry->m_numerator, entry->m_denominator, result);
+      else
+        error = ScaleParsed(real, entry->m_numerator, entry->m_denominator, result);
+      if (error != ParseError::kNone)
+        return ParseResult{ first, error };
+
+      value = Unit::From(result);
+      return ParseResult{ end, ParseError::kNone };
+    }
+  }
+
+  // number, optional blanks, unit symbol, converted to the target unit, e.g.
+  //   constexpr auto kVelocitySymbols = units::MakeSymbolSet<Velocity>(units::Symbol<Velocity>("m/s"), units::Symbol<KilometersPerHour>("km/h"));
+  //   Velocity v;
+  //   units::parse(text, text + size, v, kVelocitySymbols); // "12.5 km/h" -> 3.47222 m/s
+  // leading blanks are skipped; the value is left untouched on failure
+  template <typename Unit, int kNumSymbols>
+  inline ParseResult parse(const char *first, const char *last, Unit &value, const SymbolSet<Unit, kNumSymbols> &symbols) noexcept
+  {
+    return internal::Parse(first, last, value, symbols, ',');
+  }
+
+  template <typename Unit, int kNumSymbols>
+  inline ParseResult parse(const std::string_view text, Unit &value, const SymbolSet<Unit, kNumSymbols> &symbols) noexcept
+  {
+    return parse(text.data(), text.data() + text.size(), value, symbols);
+  }
+
+  // one value per delimited field in a single pass (by default one per line, with '\r\n' line ends tolerated),
+  // e.g. a column cut out of a CSV file; stops at the first error, or once the output is full
+  template <typename Range, typename Unit, int kNumSymbols>
+  inline ColumnParseResult parse_column(const char *first, const char *last, Range &&out, const SymbolSet<Unit, kNumSymbols> &symbols, const char delimiter = '\n') noexcept
+  {
+    const std::span<Unit> values = std::span(out);
+    std::size_t count = 0;
+    while (first != last && count < values.size())
+    {
+      const ParseResult result = internal::Parse(first, last, values[count], symbols, delimiter);
+      if (!result)
+        return ColumnParseResult{ count, result.m_end, result.m_error };
+      ++count;
+
+      first = internal::SkipBlanks(result.m_end, last);
+      if (first != last && *first == '\r' && delimiter == '\n')
+        ++first;
+      if (first != last)
+      {
+        if (*first != delimiter)
+          return ColumnParseResult{ count, first, ParseError::kTrailingCharacters };
+        ++first;
+      }
+    }
+    return ColumnParseResult{ count, first, ParseError::kNone };
+  }
+
+  template <typename Range, typename Unit, int kNumSymbols>
+  inline ColumnParseResult parse_column(const std::string_view text, Range &&out, const SymbolSet<Unit, kNumSymbols> &symbols, const char delimiter = '\n') noexcept
+  {
+    return parse_column(text.data(), text.data() + text.size(), out, symbols, delimiter);
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: parsing
+
+
+#endif
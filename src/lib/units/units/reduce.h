@@ -0,0 +1,247 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_REDUCE_H
+#define UNITS_REDUCE_H
+
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "units/batch.h"
+
+
+// reductions
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // the shape of every reduction is fixed by the element count alone:
+    // blocks of kReduceBlockSize elements, each folded over kReduceLanes interleaved lanes (which the compiler maps to SIMD registers)
+    // and then pairwise across lanes, and block results combined in a balanced pairwise tree
+    // threads only decide who computes which block, so results are bit-identical for any thread count and instruction set
+    static const std::size_t kReduceBlockSize = 1 << 14;
+    static const int kReduceLanes = 16;
+    static const std::size_t kMinReduceBlocksPerThread = 4;
+
+    // lanes are of the result type, which may be wider than the elements (see ReduceOps::Sum)
+    template <typename Storage, typename Result, typename Op>
+    inline Result ReduceBlock(const Storage *values, const std::size_t count, const Result identity, const Op &op) noexcept
+    {
+      Result lanes[kReduceLanes];
+      for (int j = 0; j < kReduceLanes; ++j)
+        lanes[j] = identity;
+
+      std::size_t i = 0;
+      for (; i + kReduceLanes <= count; i += kReduceLanes)
+      {
+        for (int j = 0; j < kReduceLanes; ++j)
+          lanes[j] = op(lanes[j], values[i + j]);
+      }
+      for (int j = 0; i < count; ++i, ++j)
+        lanes[j] = op(lanes[j], values[i]);
+
+      for (int width = kReduceLanes / 2; width > 0; width /= 2)
+      {
+        for (int j = 0; j < width; ++j)
+          lanes[j] = op(lanes[j], lanes[j + width]);
+      }
+      return lanes[0];
+    }
+
+    template <typename Result, typename Combine>
+    inline Result CombineTree(const Result *results, const std::size_t count, const Combine &combine) noexcept
+    {
+      if (count == 1)
+        return results[0];
+      const std::size_t half = count / 2;
+      return combine(CombineTree(results, half, combine), CombineTree(results + half, count - half, combine));
+    }
+
+    // blockFunction(first, count) per block, spread over threads in contiguous runs of blocks, then combined in a fixed tree
+    template <typename Result, typename BlockFunction, typename Combine>
+    inline Result ReduceBlocks(const std::size_t count, const Result identity, const int numThreads, const BlockFunction &blockFunction, const Combine &combine)
+    {
+      const std::size_t numBlocks = (count + kReduceBlockSize - 1) / kReduceBlockSize;
+      if (numBlocks == 0)
+        return identity;
+
+      std::vector<Result> results(numBlocks, identity);
+      const auto reduce = [&](const std::size_t firstBlock, const std::size_t lastBlock)
+      {
+        for (std::size_t block = firstBlock; block < lastBlock; ++block)
+        {
+          const std::size_t first = block * kReduceBlockSize;
+          results[block] = blockFunction(first, std::min(kReduceBlockSize, count - first));
+        }
+      };
+
+      const std::size_t numHardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+      const std::size_t numRequested = (numThreads > 0) ? static_cast<std::size_t>(numThreads) : numHardwareThreads;
+      const std::size_t numUsed = std::max<std::size_t>(1, std::min(numRequested, numBlocks / kMinReduceBlocksPerThread));
+      std::vector<std::thread> threads;
+      for (std::size_t t = 1; t < numUsed; ++t)
+        threads.emplace_back(reduce, numBlocks * t / numUsed, numBlocks * (t + 1) / numUsed);
+      reduce(0, numBlocks / numUsed);
+      for (std::thread &thread : threads)
+        thread.join();
+
+      return CombineTree(results.data(), numBlocks, combine);
+    }
+
+    template <typename Storage>
+    struct ReduceOps
+    {
+      // integer sums accumulate in 64 bits, so millions of 8, 16 or 32-bit elements can't overflow on the way;
+      // floating-point sums stay in the element type, which the pairwise blocks keep accurate
+      typedef typename std::conditional
+      <
+        std::is_floating_point<Storage>::value,
+        Storage,
+        typename std::conditional<std::is_unsigned<Storage>::value, unsigned long long, long long>::type
+      >::type Sum;
+
+      static Sum Add(const Sum a, const Sum b) noexcept { return a + b; }
+      // NaNs never win, so they are skipped (the identities are infinities, never NaN)
+      static Storage Min(const Storage a, const Storage b) noexcept { return (b < a) ? b : a; }
+      static Storage Max(const Storage a, const Storage b) noexcept { return (a < b) ? b : a; }
+
+      static constexpr Storage Highest() noexcept { return std::numeric_limits<Storage>::has_infinity ? std::numeric_limits<Storage>::infinity() : std::numeric_limits<Storage>::max(); }
+      static constexpr Storage Lowest() noexcept { return std::numeric_limits<Storage>::has_infinity ? -std::numeric_limits<Storage>::infinity() : std::numeric_limits<Storage>::lowest(); }
+    };
+
+    template <typename Storage>
+    inline typename ReduceOps<Storage>::Sum ReduceSum(const std::span<const Storage> values, const int numThreads)
+    {
+      typedef ReduceOps<Storage> Ops;
+      typedef typename Ops::Sum Sum;
+      return ReduceBlocks(values.size(), Sum(), numThreads,
+                          [&](const std::size_t first, const std::size_t count) { return ReduceBlock(values.data() + first, count, Sum(), Ops::Add); },
+                          Ops::Add);
+    }
+  }
+
+  // sum of a range of units, e.g. total Energy; same unit as the elements
+  // multi-threaded & SIMD, yet bit-identical for any thread count (see ReduceBlocks); numThreads 0 uses every hardware thread
+  // integer storage accumulates in 64 bits, so only the total itself has to fit the element storage
+  template <typename Range>
+  inline internal::RangeValue<Range> reduce_sum(const Range &range, const int numThreads = 0)
+  {
+    typedef internal::RangeValue<Range> Unit;
+    typedef internal::RangeStorage<Range> Storage;
+    static_assert(IsQuantity<Unit>::value && std::is_arithmetic<Storage>::value, "reductions need unit types with integer or floating-point storage");
+
+    const auto values = raw_span(std::span(range));
+    return Unit::From(internal::ReduceSum(std::span<const Storage>(values), numThreads));
+  }
+
+  // mean in the unit of the elements (mean of Time is Time); integer storage sums & divides in 64 bits, with truncation; zero for an empty range
+  template <typename Range>
+  inline internal::RangeValue<Range> mean(const Range &range, const int numThreads = 0)
+  {
+    typedef internal::RangeValue<Range> Unit;
+    typedef internal::RangeStorage<Range> Storage;
+    static_assert(IsQuantity<Unit>::value && std::is_arithmetic<Storage>::value, "reductions need unit types with integer or floating-point storage");
+
+    const auto values = raw_span(std::span(range));
+    const auto sum = internal::ReduceSum(std::span<const Storage>(values), numThreads);
+    if (values.empty())
+      return Unit::From(Storage());
+    if constexpr (std::is_floating_point<Storage>::value)
+      return Unit::From(static_cast<double>(sum) / static_cast<double>(values.size()));
+    else
+      return Unit::From(sum / static_cast<decltype(sum)>(values.size()));
+  }
+
+  // smallest element, skipping NaNs; +infinity (the storage's max for integers) for an empty range
+  template <typename Range>
+  inline internal::RangeValue<Range> reduce_min(const Range &range, const int numThreads = 0)
+  {
+    typedef internal::RangeValue<Range> Unit;
+    typedef internal::RangeStorage<Range> Storage;
+    static_assert(IsQuantity<Unit>::value && std::is_arithmetic<Storage>::value, "reductions need unit types with integer or floating-point storage");
+
+    const auto values = raw_span(std::span(range));
+    typedef internal::ReduceOps<Storage> Ops;
+    const Storage identity = Ops::Highest();
+    return Unit::From(internal::ReduceBlocks(values.size(), identity, numThreads,
+                                             [&](const std::size_t first, const std::size_t count) { return internal::ReduceBlock(values.data() + first, count, identity, Ops::Min); },
+                                             Ops::Min));
+  }
+
+  // largest element, skipping NaNs; -infinity (the storage's lowest for integers) for an empty range
+  template <typename Range>
+  inline internal::RangeValue<Range> reduce_max(const Range &range, const int numThreads = 0)
+  {
+    typedef internal::RangeValue<Range> Unit;
+    typedef internal::RangeStorage<Range> Storage;
+    static_assert(IsQuantity<Unit>::value && std::is_arithmetic<Storage>::value, "reductions need unit types with integer or floating-point storage");
+
+    const auto values = raw_span(std::span(range));
+    typedef internal::ReduceOps<Storage> Ops;
+    const Storage identity = Ops::Lowest();
+    return Unit::From(internal::ReduceBlocks(values.size(), identity, numThreads,
+                                             [&](const std::size_t first, const std::size_t count) { return internal::ReduceBlock(values.data() + first, count, identity, Ops::Max); },
+                                             Ops::Max));
+  }
+
+  // smallest & largest elements in one pass over memory
+  template <typename Range>
+  inline std::pair<internal::RangeValue<Range>, internal::RangeValue<Range>> reduce_minmax(const Range &range, const int numThreads = 0)
+  {
+    typedef internal::RangeValue<Range> Unit;
+    typedef internal::RangeStorage<Range> Storage;
+    static_assert(IsQuantity<Unit>::value && std::is_arithmetic<Storage>::value, "reductions need unit types with integer or floating-point storage");
+
+    const auto values = raw_span(std::span(range));
+    typedef internal::ReduceOps<Storage> Ops;
+    typedef std::pair<Storage, Storage> MinMax;
+    const MinMax identity(Ops::Highest(), Ops::Lowest());
+    const auto combine = [](const MinMax &a, const MinMax &b) { return MinMax(Ops::Min(a.first, b.first), Ops::Max(a.second, b.second)); };
+    const MinMax result = internal::ReduceBlocks(values.size(), identity, numThreads, [&](const std::size_t first, const std::size_t count)
+    {
+      // two lane sets in the same loop, so each element is loaded once
+      Storage lows[internal::kReduceLanes];
+      Storage highs[internal::kReduceLanes];
+      for (int j = 0; j < internal::kReduceLanes; ++j)
+      {
+        lows[j] = identity.first;
+        highs[j] = identity.second;
+      }
+
+      const Storage *block = values.data() + first;
+      std::size_t i = 0;
+      for (; i + internal::kReduceLanes <= count; i += internal::kReduceLanes)
+      {
+        for (int j = 0; j < internal::kReduceLanes; ++j)
+        {
+          lows[j] = Ops::Min(lows[j], block[i + j]);
+          highs[j] = Ops::Max(highs[j], block[i + j]);
+        }
+      }
+      for (int j = 0; i < count; ++i, ++j)
+      {
+        lows[j] = Ops::Min(lows[j], block[i]);
+        highs[j] = Ops::Max(highs[j], block[i]);
+      }
+      return MinMax(internal::ReduceBlock(lows, internal::kReduceLanes, identity.first, Ops::Min), internal::ReduceBlock(highs, internal::kReduceLanes, identity.second, Ops::Max));
+    }, combine);
+    return std::make_pair(Unit::From(result.first), Unit::From(result.second));
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: reductions
+
+
+#endif
@@ -0,0 +1,207 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_REGISTRY_H
+#define UNITS_REGISTRY_H
+
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "units/dynamic.h"
+#include "units/storage.h"
+#include "units/symbol.h"
+
+
+// unit registry
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // a unit type described at runtime; name & symbol text must outlive the registry (literals do)
+  struct UnitDescriptor
+  {
+    std::string_view m_name;        // type name, e.g. "Velocity"
+    std::string_view m_symbol;      // literal suffix without the underscore (e.g. "m_s"), or a registered alias (e.g. "m/s")
+    Dimension m_dimension;          // base dimensions, exponents & scale
+    std::uint64_t m_fingerprint;    // see DimensionFingerprint
+    StorageKind m_storageKind;
+    std::uint16_t m_storageSize;
+    std::uint32_t m_storageParameter;
+
+    // a value in this unit, e.g. a labeled metric, ready to be checked against static unit types
+    constexpr DynamicQuantity MakeQuantity(const double value) const noexcept
+    {
+      return DynamicQuantity(value, m_fingerprint, m_dimension.m_scaleNumerator, m_dimension.m_scaleDenominator);
+    }
+  };
+
+  template <typename Unit>
+  constexpr UnitDescriptor DescribeUnit(const std::string_view name, const std::string_view symbol) noexcept
+  {
+    typedef typename Unit::Storage Storage;
+    return UnitDescriptor
+    {
+      name,
+      symbol,
+      Unit::kDimension,
+      std::integral_constant<std::uint64_t, DimensionFingerprint(Unit::kDimension)>::value,
+      internal::StorageTypeOf<Storage>::kKind,
+      static_cast<std::uint16_t>(sizeof(Storage)),
+      internal::StorageTypeOf<Storage>::kParameter,
+    };
+  }
+
+  // symbol -> unit descriptor, through a perfect hash (hash & displace) rebuilt whenever a unit is registered,
+  // so a lookup is one symbol hash, two table loads and one comparison, with no allocation and no probing
+  // units are registered during static initialization by the unit macros (see UNITS_REGISTER_UNIT below);
+  // register before other threads look up, lookups themselves never write
+  class UnitRegistry
+  {
+    public:
+      // the registry the unit macros populate
+      static UnitRegistry &Instance()
+      {
+        static UnitRegistry s_instance;
+        return s_instance;
+      }
+
+      // false if the symbol is taken by another unit; registering the same unit & symbol again is a no-op
+      bool Register(const UnitDescriptor &unit)
+      {
+        if (unit.m_symbol.empty())
+          return false;
+        if (const UnitDescriptor *existing = Find(unit.m_symbol))
+          return existing->m_name == unit.m_name;
+
+        m_units.push_back(unit);
+        BuildTable();
+        return true;
+      }
+
+      // null if no unit has the symbol
+      const UnitDescriptor *Find(const std::string_view symbol) const noexcept
+      {
+        return Find(symbol, internal::HashSymbol(symbol, m_seed));
+      }
+
+      // for text already hashed with this registry's seed, e.g. while scanning for the end of the symbol
+      const UnitDescriptor *Find(const std::string_view symbol, const std::uint32_t hash) const noexcept
+      {
+        if (m_units.empty())
+          return nullptr;
+        const std::uint32_t displacement = m_displacements[hash & m_bucketMask];
+        const std::uint32_t index = m_slots[SlotHash(hash, displacement) & m_slotMask];
+        if (!index || m_units[index - 1].m_symbol != symbol)
+          return nullptr;
+        return &m_units[index - 1];
+      }
+
+      std::uint32_t GetSeed() const noexcept { return m_seed; }
+
+      // every registered symbol, for tooling; in registration order, which across translation units is unspecified
+      std::span<const UnitDescriptor> GetUnits() const noexcept { return std::span<const UnitDescriptor>(m_units); }
+
+    private:
+      static const std::uint32_t kMaxDisplacement = 1 << 12;
+
+      static std::uint32_t SlotHash(std::uint32_t hash, const std::uint32_t displacement) noexcept
+      {
+        hash ^= displacement * 0x9e3779b9u;
+        hash ^= hash >> 16;
+        hash *= 0x7feb352du;
+        return hash ^ (hash >> 15);
+      }
+
+      // twice as many slots as symbols, about two symbols per bucket; buckets are placed largest first,
+      // each trying displacements until all its symbols land in free slots, and the seed changes if one never does
+      void BuildTable()
+      {
+        std::uint32_t numSlots = 4;
+        while (numSlots < 2 * m_units.size())
+          numSlots *= 2;
+        const std::uint32_t numBuckets = numSlots / 4;
+        m_slotMask = numSlots - 1;
+        m_bucketMask = numBuckets - 1;
+
+        std::vector<std::uint32_t> hashes(m_units.size());
+        std::vector<std::vector<std::uint32_t>> buckets(numBuckets);
+        std::vector<std::uint32_t> order(numBuckets);
+        std::vector<std::uint32_t> candidates;
+        for (m_seed = 0;; ++m_seed)
+        {
+          for (std::vector<std::uint32_t> &bucket : buckets)
+            bucket.clear();
+          for (std::uint32_t i = 0; i < m_units.size(); ++i)
+          {
+            hashes[i] = internal::HashSymbol(m_units[i].m_symbol, m_seed);
+            buckets[hashes[i] & m_bucketMask].push_back(i);
+          }
+          for (std::uint32_t b = 0; b < numBuckets; ++b)
+            order[b] = b;
+          std::stable_sort(order.begin(), order.end(), [&](const std::uint32_t a, const std::uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+          m_slots.assign(numSlots, 0);
+          m_displacements.assign(numBuckets, 0);
+          bool placed = true;
+          for (std::uint32_t b = 0; b < numBuckets && placed && !buckets[order[b]].empty(); ++b)
+          {
+            const std::vector<std::uint32_t> &bucket = buckets[order[b]];
+            placed = false;
+            for (std::uint32_t displacement = 0; displacement < kMaxDisplacement && !placed; ++displacement)
+            {
+              candidates.clear();
+              placed = true;
+              for (const std::uint32_t i : bucket)
+              {
+                const std::uint32_t slot = SlotHash(hashes[i], displacement) & m_slotMask;
+                placed = placed && !m_slots[slot] && std::find(candidates.begin(), candidates.end(), slot) == candidates.end();
+                candidates.push_back(slot);
+              }
+              if (!placed)
+                continue;
+
+              m_displacements[order[b]] = displacement;
+              for (std::size_t j = 0; j < bucket.size(); ++j)
+                m_slots[candidates[j]] = bucket[j] + 1;
+            }
+          }
+          if (placed)
+            return;
+        }
+      }
+
+      std::vector<UnitDescriptor> m_units;
+      std::vector<std::uint32_t> m_displacements; // per bucket
+      std::vector<std::uint32_t> m_slots;         // unit index + 1, zero for empty slots
+      std::uint32_t m_bucketMask = 0;
+      std::uint32_t m_slotMask = 0;
+      std::uint32_t m_seed = 0;
+  };
+}
+
+// units defined after this header is included register themselves under their literal suffix, e.g. "m" for
+// MAKE_BASIC_UNIT(Length, float, _m), so include it before the unit definitions (e.g. at the top of the unit catalog header)
+#undef UNITS_REGISTER_UNIT
+#define UNITS_REGISTER_UNIT(UnitName, LiteralSuffix)                                                                                   \
+  inline const bool UNITS_MACRO_CONCAT(UnitName, Registered) =                                                                         \
+    units::UnitRegistry::Instance().Register(units::DescribeUnit<UnitName>(#UnitName, std::string_view(#LiteralSuffix).substr(1)));    \
+
+// more symbols for a registered unit (e.g. "m/s" for Velocity); in one source file, at namespace scope
+#define UNITS_REGISTER_SYMBOL(UnitName, Symbol)                                                                                        \
+  static const bool UNITS_MACRO_CONCAT(UnitsSymbolRegistered, __LINE__) =                                                              \
+    units::UnitRegistry::Instance().Register(units::DescribeUnit<UnitName>(#UnitName, Symbol))                                         \
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: unit registry
+
+
+#endif
@@ -0,0 +1,145 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_SIMD_H
+#define UNITS_SIMD_H
+
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define UNITS_SIMD_X64 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+  #endif
+#else
+  #define UNITS_SIMD_X64 0
+#endif
+
+// instruction set every function may assume, from what the compiler was told to target (e.g. -mavx2, /arch:AVX2),
+// numbered like InstructionSet; inline value types (see units/pack.h) pick their registers from it, batch kernels dispatch at runtime
+#if UNITS_SIMD_X64 && defined(__AVX512F__) && defined(__AVX512DQ__)
+  #define UNITS_SIMD_BASELINE 3
+#elif UNITS_SIMD_X64 && defined(__AVX2__) && (defined(_MSC_VER) || (defined(__FMA__) && defined(__F16C__)))
+  #define UNITS_SIMD_BASELINE 2
+#elif UNITS_SIMD_X64
+  #define UNITS_SIMD_BASELINE 1
+#else
+  #define UNITS_SIMD_BASELINE 0
+#endif
+
+// MSVC lets any function use any intrinsic, whereas GCC & Clang need the instruction set enabled per function
+#if UNITS_SIMD_X64 && (defined(__GNUC__) || defined(__clang__))
+  #define UNITS_TARGET_SSE2
+  #define UNITS_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+  #define UNITS_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx2,fma,f16c")))
+  #define UNITS_FORCE_INLINE inline __attribute__((always_inline))
+#else
+  #define UNITS_TARGET_SSE2
+  #define UNITS_TARGET_AVX2
+  #define UNITS_TARGET_AVX512
+  #if defined(_MSC_VER)
+    #define UNITS_FORCE_INLINE __forceinline
+  #else
+    #define UNITS_FORCE_INLINE inline
+  #endif
+#endif
+
+
+// instruction sets
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // ordered, so a higher instruction set implies all lower ones
+  enum class InstructionSet
+  {
+    kScalar,
+    kSse2,
+    kAvx2,   // AVX2 + FMA + F16C
+    kAvx512, // AVX-512 F + DQ
+  };
+
+  inline InstructionSet DetectInstructionSet()
+  {
+#if UNITS_SIMD_X64 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+    if (avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+      return InstructionSet::kAvx512;
+    if (avx2)
+      return InstructionSet::kAvx2;
+    return InstructionSet::kSse2;
+#elif UNITS_SIMD_X64 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool f16c = (info[2] & (1 << 29)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || maxLeaf < 7)
+      return InstructionSet::kSse2;
+
+    // the OS must save the wider registers on context switches
+    const unsigned long long xcr0 = _xgetbv(0);
+    const bool osAvx = (xcr0 & 0x6) == 0x6;
+    const bool osAvx512 = (xcr0 & 0xe6) == 0xe6;
+
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    const bool avx512f = (info[1] & (1 << 16)) != 0;
+    const bool avx512dq = (info[1] & (1 << 17)) != 0;
+
+    if (osAvx512 && avx512f && avx512dq && avx2 && fma && f16c)
+      return InstructionSet::kAvx512;
+    if (osAvx && avx2 && fma && f16c)
+      return InstructionSet::kAvx2;
+    return InstructionSet::kSse2;
+#else
+    return InstructionSet::kScalar;
+#endif
+  }
+
+  // best instruction set supported by this machine, detected once
+  inline InstructionSet GetSupportedInstructionSet()
+  {
+    static const InstructionSet kSupported = DetectInstructionSet();
+    return kSupported;
+  }
+
+  namespace internal
+  {
+    // atomic since batch kernels on other threads read it while it is set; relaxed, as no other data is published with it
+    inline std::atomic<InstructionSet> &ActiveInstructionSet()
+    {
+      static std::atomic<InstructionSet> s_active(GetSupportedInstructionSet());
+      return s_active;
+    }
+  }
+
+  // instruction set batch kernels dispatch to
+  inline InstructionSet GetInstructionSet()
+  {
+    return internal::ActiveInstructionSet().load(std::memory_order_relaxed);
+  }
+
+  // restricts dispatch (e.g. to test or benchmark narrower kernels); clamped to what the machine supports
+  inline void SetInstructionSet(const InstructionSet instructionSet)
+  {
+    internal::ActiveInstructionSet().store((instructionSet < GetSupportedInstructionSet()) ? instructionSet : GetSupportedInstructionSet(), std::memory_order_relaxed);
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: instruction sets
+
+
+#endif
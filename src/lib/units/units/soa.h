@@ -0,0 +1,231 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_SOA_H
+#define UNITS_SOA_H
+
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "units/span.h"
+
+
+// structure of arrays
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // records of unit-typed fields, stored as one contiguous raw storage column per field
+  // so a kernel touching a single field streams only that field's cache lines, e.g.
+  //   UnitSoA<Length, Velocity, Time> bodies;
+  //   bodies.PushBack(1.0_m, 2.0_m_s, 0.0_s);
+  //   std::span<Velocity> velocities = bodies.Column<1>();
+  //   bodies[0].Get<0>() += bodies[0].Get<1>() * 1.0_s;
+  template <typename... Fields>
+  class UnitSoA
+  {
+    public:
+      static const std::size_t kNumFields = sizeof...(Fields);
+      static const std::size_t kAlignment = 64; // every column starts on a cache line, and capacities are padded to whole cache lines
+
+      template <std::size_t kField> using Field = typename std::tuple_element<kField, std::tuple<Fields...>>::type;
+      template <std::size_t kField> using FieldStorage = typename StorageOf<Field<kField>>::Type;
+
+      // typed view of a single record
+      template <bool kConst>
+      class ElementProxy
+      {
+        public:
+          template <std::size_t kField>
+          typename std::conditional<kConst, const Field<kField>, Field<kField>>::type &Get() const
+          {
+            return m_soa->template Column<kField>()[m_index];
+          }
+
+          std::tuple<Fields...> Load() const { return m_soa->Load(m_index); }
+
+        private:
+          friend class UnitSoA;
+          typedef typename std::conditional<kConst, const UnitSoA, UnitSoA>::type Owner;
+          ElementProxy(Owner *soa, std::size_t index) : m_soa(soa), m_index(index) { }
+          Owner *m_soa;
+          std::size_t m_index;
+      };
+      typedef ElementProxy<false> Reference;
+      typedef ElementProxy<true> ConstReference;
+
+      UnitSoA() : m_columns(), m_size(0), m_capacity(0) { }
+      explicit UnitSoA(std::size_t size) : UnitSoA() { Resize(size); }
+      UnitSoA(const UnitSoA &rhs) : UnitSoA() { *this = rhs; }
+      UnitSoA(UnitSoA &&rhs) noexcept : UnitSoA() { Swap(rhs); }
+      ~UnitSoA() { Deallocate(m_columns, std::index_sequence_for<Fields...>()); }
+
+      UnitSoA &operator=(const UnitSoA &rhs)
+      {
+        if (this != &rhs)
+        {
+          Clear();
+          Reserve(rhs.m_size);
+          CopyColumns(m_columns, rhs.m_columns, rhs.m_size, std::index_sequence_for<Fields...>());
+          m_size = rhs.m_size;
+        }
+        return *this;
+      }
+
+      UnitSoA &operator=(UnitSoA &&rhs) noexcept
+      {
+        UnitSoA(std::move(rhs)).Swap(*this);
+        return *this;
+      }
+
+      void Swap(UnitSoA &rhs) noexcept
+      {
+        std::swap(m_columns, rhs.m_columns);
+        std::swap(m_size, rhs.m_size);
+        std::swap(m_capacity, rhs.m_capacity);
+      }
+
+      std::size_t Size() const { return m_size; }
+      std::size_t Capacity() const { return m_capacity; }
+      bool Empty() const { return m_size == 0; }
+
+      void Clear() { m_size = 0; }
+
+      void Reserve(std::size_t capacity)
+      {
+        if (capacity <= m_capacity)
+          return;
+
+        capacity = PadCapacity(capacity);
+        Columns columns = { };
+        Allocate(columns, capacity, std::index_sequence_for<Fields...>());
+        CopyColumns(columns, m_columns, m_size, std::index_sequence_for<Fields...>());
+        Deallocate(m_columns, std::index_sequence_for<Fields...>());
+        m_columns = columns;
+        m_capacity = capacity;
+      }
+
+      // new records are zeroed
+      void Resize(std::size_t size)
+      {
+        Reserve(size);
+        if (size > m_size)
+          ZeroColumns(m_size, size - m_size, std::index_sequence_for<Fields...>());
+        m_size = size;
+      }
+
+      void PushBack(const Fields... values)
+      {
+        if (m_size == m_capacity)
+          Reserve(m_capacity ? m_capacity * 2 : 1);
+        Store(m_size++, values...);
+      }
+
+      void Store(std::size_t index, const Fields... values)
+      {
+        StoreColumns(index, std::index_sequence_for<Fields...>(), values...);
+      }
+
+      std::tuple<Fields...> Load(std::size_t index) const
+      {
+        return LoadColumns(index, std::index_sequence_for<Fields...>());
+      }
+
+      Reference operator[](std::size_t index) { return Reference(this, index); }
+      ConstReference operator[](std::size_t index) const { return ConstReference(this, index); }
+
+      template <std::size_t kField> std::span<Field<kField>> Column() { return TypedColumn<Field<kField>>(RawColumn<kField>()); }
+      template <std::size_t kField> std::span<const Field<kField>> Column() const { return TypedColumn<const Field<kField>>(RawColumn<kField>()); }
+
+      template <std::size_t kField> std::span<FieldStorage<kField>> RawColumn() { return std::span<FieldStorage<kField>>(std::get<kField>(m_columns), m_size); }
+      template <std::size_t kField> std::span<const FieldStorage<kField>> RawColumn() const { return std::span<const FieldStorage<kField>>(std::get<kField>(m_columns), m_size); }
+
+    private:
+      typedef std::tuple<typename StorageOf<Fields>::Type *...> Columns;
+
+      // raw fields (e.g. a float mass) are allowed alongside unit fields
+      template <typename T, typename Raw>
+      static std::span<T> TypedColumn(const std::span<Raw> raw)
+      {
+        if constexpr (std::is_same<T, Raw>::value)
+          return raw;
+        else
+          return span_cast<T>(raw);
+      }
+
+      static std::size_t PadCapacity(std::size_t capacity)
+      {
+        // pad to a whole cache line of the smallest storage type; every column then ends on a cache line boundary
+        // when all storage sizes divide the alignment, storage wider than a cache line pads by one record
+        const std::size_t kMinStorageSize = std::min({ sizeof(typename StorageOf<Fields>::Type)... });
+        const std::size_t kGranularity = std::max<std::size_t>(kAlignment / kMinStorageSize, 1);
+        return (capacity + kGranularity - 1) / kGranularity * kGranularity;
+      }
+
+      template <std::size_t... kFields>
+      static void Allocate(Columns &columns, std::size_t capacity, std::index_sequence<kFields...> fields)
+      {
+        // columns start null, so a throw part way through frees just the ones already allocated
+        try
+        {
+          ((std::get<kFields>(columns) = static_cast<FieldStorage<kFields> *>(::operator new(capacity * sizeof(FieldStorage<kFields>), std::align_val_t(kAlignment)))), ...);
+        }
+        catch (...)
+        {
+          Deallocate(columns, fields);
+          throw;
+        }
+      }
+
+      template <std::size_t... kFields>
+      static void Deallocate(Columns &columns, std::index_sequence<kFields...>)
+      {
+        ((std::get<kFields>(columns) ? ::operator delete(std::get<kFields>(columns), std::align_val_t(kAlignment)) : void()), ...);
+        columns = Columns();
+      }
+
+      template <std::size_t... kFields>
+      static void CopyColumns(Columns &dst, const Columns &src, std::size_t size, std::index_sequence<kFields...>)
+      {
+        if (size)
+          (std::memcpy(std::get<kFields>(dst), std::get<kFields>(src), size * sizeof(FieldStorage<kFields>)), ...);
+      }
+
+      template <std::size_t... kFields>
+      void ZeroColumns(std::size_t begin, std::size_t count, std::index_sequence<kFields...>)
+      {
+        (std::memset(std::get<kFields>(m_columns) + begin, 0, count * sizeof(FieldStorage<kFields>)), ...);
+      }
+
+      template <std::size_t... kFields>
+      void StoreColumns(std::size_t index, std::index_sequence<kFields...>, const Fields... values)
+      {
+        ((Column<kFields>()[index] = values), ...);
+      }
+
+      template <std::size_t... kFields>
+      std::tuple<Fields...> LoadColumns(std::size_t index, std::index_sequence<kFields...>) const
+      {
+        return std::tuple<Fields...>(Column<kFields>()[index]...);
+      }
+
+      Columns m_columns;
+      std::size_t m_size;
+      std::size_t m_capacity;
+  };
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: structure of arrays
+
+
+#endif
@@ -0,0 +1,71 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_SPAN_H
+#define UNITS_SPAN_H
+
+
+#include <span>
+
+#include "units/units.h"
+
+
+// span casts
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // raw storage of a unit type, or the type itself for raw types (cv-qualifiers dropped)
+  template <typename T, bool = IsQuantity<typename std::remove_cv<T>::type>::value>
+  struct StorageOf { typedef typename std::remove_cv<T>::type Type; };
+  template <typename T>
+  struct StorageOf<T, true> { typedef typename std::remove_cv<T>::type::Storage Type; };
+
+  // a span cast only re-labels elements between a unit type and its raw storage,
+  // never between two unit types (that would defeat the dimension check) and never casting away const
+  template <typename To, typename From>
+  struct IsSpanCastable
+    : std::integral_constant
+      <
+        bool, 
+        IsQuantity<typename std::remove_cv<To>::type>::value != IsQuantity<typename std::remove_cv<From>::type>::value
+        && std::is_same<typename StorageOf<To>::Type, typename StorageOf<From>::Type>::value
+        && (std::is_const<To>::value || !std::is_const<From>::value)
+      >
+  { };
+
+  // zero-copy view of raw samples as units (or vice versa), e.g.
+  //   std::span<float> samples = ...;
+  //   std::span<Length> lengths = units::span_cast<Length>(samples);
+  // relies on the layout contract enforced by UNITS_LAYOUT_CHECK
+  template <typename To, typename From, std::size_t kExtent>
+  inline std::span<To, kExtent> span_cast(const std::span<From, kExtent> from) noexcept
+  {
+    static_assert(IsSpanCastable<To, From>::value, "span_cast only converts between a unit type and its storage type");
+    static_assert(sizeof(To) == sizeof(From) && alignof(To) == alignof(From), "span_cast requires layout-compatible element types");
+
+    return std::span<To, kExtent>(reinterpret_cast<To *>(from.data()), from.size());
+  }
+
+  // raw storage view of a span of units (or of a raw span, unchanged), preserving const
+  template <typename T, std::size_t kExtent>
+  inline auto raw_span(const std::span<T, kExtent> from) noexcept
+  {
+    typedef typename std::conditional<std::is_const<T>::value, const typename StorageOf<T>::Type, typename StorageOf<T>::Type>::type Raw;
+    if constexpr (std::is_same<T, Raw>::value)
+      return from;
+    else
+      return span_cast<Raw>(from);
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: span casts
+
+
+#endif
@@ -0,0 +1,66 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_STORAGE_H
+#define UNITS_STORAGE_H
+
+
+#include <cstdint>
+
+#include "units/fixed.h"
+#include "units/half.h"
+#include "units/units.h"
+
+
+// storage kinds
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // storage types described at runtime (column files, the unit registry), as kind + size + parameter
+  enum class StorageKind : std::uint16_t
+  {
+    kUnknown,
+    kFloat,
+    kSigned,
+    kUnsigned,
+    kHalf,
+    kBFloat16,
+    kFixed, // parameter: fraction bits
+  };
+
+  namespace internal
+  {
+    template <typename Storage>
+    struct StorageTypeOf
+    {
+      static_assert(std::is_arithmetic<Storage>::value, "described storage must be arithmetic, Float16 or Fixed");
+      static constexpr StorageKind kKind = std::is_floating_point<Storage>::value ? StorageKind::kFloat : (std::is_signed<Storage>::value ? StorageKind::kSigned : StorageKind::kUnsigned);
+      static constexpr std::uint32_t kParameter = 0;
+    };
+    template <Float16Format kFormat>
+    struct StorageTypeOf<Float16<kFormat>>
+    {
+      static constexpr StorageKind kKind = (kFormat == Float16Format::kHalf) ? StorageKind::kHalf : StorageKind::kBFloat16;
+      static constexpr std::uint32_t kParameter = 0;
+    };
+    // the overflow policy only affects arithmetic, not the stored bits
+    template <int kFractionBits, typename RawType, Overflow kOverflow>
+    struct StorageTypeOf<Fixed<kFractionBits, RawType, kOverflow>>
+    {
+      static constexpr StorageKind kKind = StorageKind::kFixed;
+      static constexpr std::uint32_t kParameter = kFractionBits;
+    };
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: storage kinds
+
+
+#endif
@@ -0,0 +1,165 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_SYMBOL_H
+#define UNITS_SYMBOL_H
+
+
+#include <cstdint>
+#include <string_view>
+
+#include "units/units.h"
+
+
+// unit symbols
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // text of a unit type's symbol, e.g. Symbol<Kilometers>("km"); any UTF-8 text without white space, ',' or ';' works
+  template <typename UnitType>
+  struct Symbol
+  {
+    typedef UnitType Unit;
+    constexpr explicit Symbol(const char *text) noexcept : m_text(text) { }
+    std::string_view m_text;
+  };
+
+  namespace internal
+  {
+    // seeded FNV-1a, folded so the low bits depend on every byte
+    // split in steps so parsers can hash a symbol in the same pass that finds its end
+    constexpr std::uint32_t BeginSymbolHash(const std::uint32_t seed) noexcept { return 2166136261u ^ seed; }
+    constexpr std::uint32_t StepSymbolHash(const std::uint32_t hash, const char c) noexcept { return (hash ^ static_cast<unsigned char>(c)) * 16777619u; }
+    constexpr std::uint32_t EndSymbolHash(const std::uint32_t hash) noexcept { return hash ^ (hash >> 15); }
+
+    constexpr std::uint32_t HashSymbol(const std::string_view text, const std::uint32_t seed) noexcept
+    {
+      std::uint32_t hash = BeginSymbolHash(seed);
+      for (const char c : text)
+        hash = StepSymbolHash(hash, c);
+      return EndSymbolHash(hash);
+    }
+
+    constexpr int SymbolTableSize(const int numSymbols)
+    {
+      int size = 4;
+      while (size < 2 * numSymbols)
+        size *= 2;
+      return size;
+    }
+  }
+
+  // symbols of units sharing the base dimensions of a target unit, e.g. m, km & mm for Length,
+  // each with the ratio that converts its values to the target unit, folded at compile time,
+  // and a collision-free (perfect) hash table from symbol text to symbol, seeded at compile time
+  template <typename TargetUnit, int kNumSymbols>
+  class SymbolSet
+  {
+    public:
+      typedef TargetUnit Unit;
+      static const int kSize = kNumSymbols;
+      static const int kTableSize = internal::SymbolTableSize(kNumSymbols);
+
+      struct Entry
+      {
+        std::string_view m_text;
+        long long m_numerator;   // symbol value * numerator / denominator = target value
+        long long m_denominator;
+      };
+
+      template <typename... Units>
+      constexpr explicit SymbolSet(const Symbol<Units>... symbols) : m_entries{ MakeEntry(symbols)... }, m_table(), m_seed(0)
+      {
+        static_assert(sizeof...(Units) == kNumSymbols, "symbol count mismatch");
+
+        for (int i = 0; i < kNumSymbols; ++i)
+        {
+          if (m_entries[i].m_text.empty())
+            throw "units: empty unit symbol"; // not a constant expression -> compile error
+          for (int j = 0; j < i; ++j)
+          {
+            if (m_entries[i].m_text == m_entries[j].m_text)
+              throw "units: duplicate unit symbol"; // not a constant expression -> compile error
+          }
+        }
+
+        // try seeds until no two symbols share a slot; with the table at least twice the symbol count this takes a few tries
+        for (;; ++m_seed)
+        {
+          if (m_seed == 1u << 16)
+            throw "units: no perfect hash seed found"; // not a constant expression -> compile error
+
+          for (int slot = 0; slot < kTableSize; ++slot)
+            m_table[slot] = 0;
+
+          bool collided = false;
+          for (int i = 0; i < kNumSymbols && !collided; ++i)
+          {
+            const int slot = Slot(m_entries[i].m_text);
+            collided = (m_table[slot] != 0);
+            m_table[slot] = static_cast<unsigned char>(i + 1);
+          }
+          if (!collided)
+            break;
+        }
+      }
+
+      constexpr const Entry &operator[](const int i) const noexcept { return m_entries[i]; }
+
+      // one hash and one comparison; null if the text is not one of the symbols
+      constexpr const Entry *Find(const std::string_view text) const noexcept
+      {
+        return Find(text, internal::HashSymbol(text, m_seed));
+      }
+
+      // for text already hashed with this set's seed
+      constexpr const Entry *Find(const std::string_view text, const std::uint32_t hash) const noexcept
+      {
+        const int index = m_table[hash & (kTableSize - 1)];
+        if (!index || m_entries[index - 1].m_text != text)
+          return nullptr;
+        return &m_entries[index - 1];
+      }
+
+      constexpr std::uint32_t GetSeed() const noexcept { return m_seed; }
+
+    private:
+      static_assert(kNumSymbols > 0 && kNumSymbols < 256, "symbol sets hold 1 to 255 symbols");
+
+      template <typename SymbolUnit>
+      static constexpr Entry MakeEntry(const Symbol<SymbolUnit> symbol)
+      {
+        static_assert(HasSameBaseDimensions(SymbolUnit::kDimension, Unit::kDimension), "symbol unit must share the base dimensions of the target unit");
+        constexpr Dimension kRatio = DivideDimensions(SymbolUnit::kDimension, Unit::kDimension);
+        return Entry{ symbol.m_text, kRatio.m_scaleNumerator, kRatio.m_scaleDenominator };
+      }
+
+      constexpr int Slot(const std::string_view text) const noexcept
+      {
+        return static_cast<int>(internal::HashSymbol(text, m_seed) & (kTableSize - 1));
+      }
+
+      Entry m_entries[kNumSymbols];
+      unsigned char m_table[kTableSize]; // symbol index + 1, zero for empty slots
+      std::uint32_t m_seed;
+  };
+
+  // e.g. constexpr auto kLengthSymbols = units::MakeSymbolSet<Length>(units::Symbol<Length>("m"), units::Symbol<Kilometers>("km"));
+  template <typename TargetUnit, typename... Units>
+  constexpr SymbolSet<TargetUnit, sizeof...(Units)> MakeSymbolSet(const Symbol<Units>... symbols)
+  {
+    return SymbolSet<TargetUnit, sizeof...(Units)>(symbols...);
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: unit symbols
+
+
+#endif
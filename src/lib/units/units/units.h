@@ -10,61 +10,464 @@
 #define UNITS_H
 
 
-#include <limits>
+#include <cfloat>
+#include <climits>
+#include <type_traits>
 
 #define UNITS_MACRO_CONCAT2(x, y) x ## y
 #define UNITS_MACRO_CONCAT(x, y) UNITS_MACRO_CONCAT2(x, y)
-#define UNITS_MACRO_END_HELPER(UnitName) struct UNITS_MACRO_CONCAT(UnitName, MacroEndHelper) { } // so we can end macro with a semi-colon
 
+// expanded by every unit macro; units/registry.h defines it to record units in the runtime registry, nothing does otherwise
+#ifndef UNITS_REGISTER_UNIT
+  #define UNITS_REGISTER_UNIT(UnitName, LiteralSuffix)
+#endif
+
+// layout contract: a unit is bit-for-bit its storage, so unit arrays can alias raw arrays and be memcpy'd
+// every unit of a storage type is the same class template, so the contract is checked once per storage type (see IsLayoutCompatible)
+// also ends unit macros with a semi-colon without declaring anything
+#define UNITS_LAYOUT_CHECK(UnitName)                                                                                                   \
+  static_assert(units::internal::IsLayoutCompatible<UnitName::Storage>::value,                                                         \
+                #UnitName " must be layout-compatible with its storage type")                                                          \
+
+
+// dimensions
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  // max number of distinct base dimensions a single dimension can be composed of
+  static const int kMaxBaseDimensions = 8;
+
+  // a dimension is a list of (base dimension ID, exponent) pairs, sorted by ID, with unused trailing entries zeroed out
+  // every basic unit introduces a new base dimension, identified by the hash of the unit's name,
+  // so the same unit name yields the same dimension in every translation unit
+  // the scale is the size of the unit relative to the unscaled unit of the same base dimensions (e.g. 1000/1 for kilometers),
+  // kept reduced so equal scales compare equal
+  struct Dimension
+  {
+    unsigned long long m_ids[kMaxBaseDimensions];
+    int m_exponents[kMaxBaseDimensions];
+    long long m_scaleNumerator = 1;
+    long long m_scaleDenominator = 1;
+  };
+
+  // FNV-1a
+  constexpr unsigned long long HashDimensionName(const char *name)
+  {
+    unsigned long long hash = 14695981039346656037ull;
+    for (; *name; ++name)
+    {
+      hash ^= static_cast<unsigned char>(*name);
+      hash *= 1099511628211ull;
+    }
+    return hash ? hash : 1; // ID zero marks unused entries
+  }
+
+  constexpr Dimension BaseDimension(const char *name)
+  {
+    Dimension result = { };
+    result.m_ids[0] = HashDimensionName(name);
+    result.m_exponents[0] = 1;
+    return result;
+  }
+
+  constexpr bool IsDimensionless(const Dimension &dimension)
+  {
+    return dimension.m_ids[0] == 0;
+  }
+
+  constexpr bool IsUnscaled(const Dimension &dimension)
+  {
+    return dimension.m_scaleNumerator == dimension.m_scaleDenominator;
+  }
+
+  // same base dimensions and exponents, regardless of scale (e.g. meters & kilometers)
+  constexpr bool HasSameBaseDimensions(const Dimension &lhs, const Dimension &rhs)
+  {
+    for (int i = 0; i < kMaxBaseDimensions; ++i)
+    {
+      if (lhs.m_ids[i] != rhs.m_ids[i] || lhs.m_exponents[i] != rhs.m_exponents[i])
+        return false;
+    }
+    return true;
+  }
+
+  constexpr long long GreatestCommonDivisor(long long a, long long b)
+  {
+    while (b)
+    {
+      const long long r = a % b;
+      a = b;
+      b = r;
+    }
+    return a;
+  }
+
+  // scale multiplied by numerator / denominator, cross-reduced first to stay clear of overflow
+  constexpr Dimension ScaleDimension(const Dimension &dimension, const long long numerator, const long long denominator)
+  {
+    if (numerator <= 0 || denominator <= 0)
+      throw "units: scales must be positive"; // not a constant expression -> compile error
+
+    const long long a = GreatestCommonDivisor(dimension.m_scaleNumerator, denominator);
+    const long long b = GreatestCommonDivisor(numerator, dimension.m_scaleDenominator);
+    const long long lhsNumerator = dimension.m_scaleNumerator / a;
+    const long long rhsNumerator = numerator / b;
+    const long long lhsDenominator = dimension.m_scaleDenominator / b;
+    const long long rhsDenominator = denominator / a;
+    if (lhsNumerator > LLONG_MAX / rhsNumerator || lhsDenominator > LLONG_MAX / rhsDenominator)
+      throw "units: scale overflow"; // not a constant expression -> compile error
+
+    Dimension result = dimension;
+    result.m_scaleNumerator = lhsNumerator * rhsNumerator;
+    result.m_scaleDenominator = lhsDenominator * rhsDenominator;
+    return result;
+  }
+
+  constexpr Dimension MultiplyDimensions(const Dimension &lhs, const Dimension &rhs)
+  {
+    Dimension result = { };
+    int i = 0;
+    int j = 0;
+    int n = 0;
+    while ((i < kMaxBaseDimensions && lhs.m_ids[i]) || (j < kMaxBaseDimensions && rhs.m_ids[j]))
+    {
+      const unsigned long long lhsId = (i < kMaxBaseDimensions) ? lhs.m_ids[i] : 0;
+      const unsigned long long rhsId = (j < kMaxBaseDimensions) ? rhs.m_ids[j] : 0;
+
+      unsigned long long id = 0;
+      int exponent = 0;
+      if (lhsId && (!rhsId || lhsId < rhsId))
+      {
+        id = lhsId;
+        exponent = lhs.m_exponents[i++];
+      }
+      else if (rhsId && (!lhsId || rhsId < lhsId))
+      {
+        id = rhsId;
+        exponent = rhs.m_exponents[j++];
+      }
+      else
+      {
+        id = lhsId;
+        exponent = lhs.m_exponents[i++] + rhs.m_exponents[j++];
+      }
+
+      if (exponent == 0)
+        continue;
+
+      if (n == kMaxBaseDimensions)
+        throw "units: too many base dimensions (raise kMaxBaseDimensions)"; // not a constant expression -> compile error
+
+      result.m_ids[n] = id;
+      result.m_exponents[n] = exponent;
+      ++n;
+    }
+    return ScaleDimension(ScaleDimension(result, lhs.m_scaleNumerator, lhs.m_scaleDenominator), rhs.m_scaleNumerator, rhs.m_scaleDenominator);
+  }
+
+  constexpr Dimension InvertDimension(const Dimension &dimension)
+  {
+    Dimension result = dimension;
+    for (int i = 0; i < kMaxBaseDimensions; ++i)
+      result.m_exponents[i] = -result.m_exponents[i];
+    result.m_scaleNumerator = dimension.m_scaleDenominator;
+    result.m_scaleDenominator = dimension.m_scaleNumerator;
+    return result;
+  }
+
+  constexpr Dimension DivideDimensions(const Dimension &lhs, const Dimension &rhs)
+  {
+    return MultiplyDimensions(lhs, InvertDimension(rhs));
+  }
+
+  // dimension raised to an integer power, e.g. length^3 -> volume; the scale is raised too (km^2 -> 10^6 m^2)
+  constexpr Dimension PowerDimension(const Dimension &dimension, const int power)
+  {
+    if (power < 0)
+      return PowerDimension(InvertDimension(dimension), -power);
+
+    Dimension result = { };
+    if (power == 0)
+      return result;
+
+    for (int i = 0; i < kMaxBaseDimensions && dimension.m_ids[i]; ++i)
+    {
+      result.m_ids[i] = dimension.m_ids[i];
+      result.m_exponents[i] = dimension.m_exponents[i] * power;
+    }
+    for (int i = 0; i < power; ++i)
+      result = ScaleDimension(result, dimension.m_scaleNumerator, dimension.m_scaleDenominator);
+    return result;
+  }
+
+  // exact integer root of a positive scale term, or zero if there is none
+  constexpr long long IntegerRoot(const long long value, const int root)
+  {
+    for (long long candidate = 1; ; ++candidate)
+    {
+      long long power = 1;
+      for (int i = 0; i < root && power <= value; ++i)
+        power = (power > value / candidate) ? value + 1 : power * candidate;
+      if (power == value)
+        return candidate;
+      if (power > value)
+        return 0;
+    }
+  }
+
+  // dimension whose power is the given dimension, e.g. the square root of area -> length
+  // every exponent and the scale must have an exact root
+  constexpr Dimension RootDimension(const Dimension &dimension, const int root)
+  {
+    if (root <= 0)
+      throw "units: roots must be positive"; // not a constant expression -> compile error
+
+    Dimension result = dimension;
+    for (int i = 0; i < kMaxBaseDimensions; ++i)
+    {
+      if (dimension.m_exponents[i] % root)
+        throw "units: dimension has no exact root"; // not a constant expression -> compile error
+      result.m_exponents[i] = dimension.m_exponents[i] / root;
+    }
+
+    result.m_scaleNumerator = IntegerRoot(dimension.m_scaleNumerator, root);
+    result.m_scaleDenominator = IntegerRoot(dimension.m_scaleDenominator, root);
+    if (!result.m_scaleNumerator || !result.m_scaleDenominator)
+      throw "units: scale has no exact root"; // not a constant expression -> compile error
+    return result;
+  }
+}
 
-// basic units
 // ------------------------------------------------------------------------------------------------------------------------------
+// end: dimensions
 
-#define BASIC_UNIT_INTERNAL(UnitName, StorageType)                                                                                     \
-    public:                                                                                                                            \
-      typedef StorageType Storage;                                                                                                     \
-                                                                                                                                       \
-      static const UnitName PosInfinity() { return UnitName(std::numeric_limits<Storage>::max()); }                                    \
-      static const UnitName NegInfinity() { return UnitName(std::numeric_limits<Storage>::lowest()); }                                 \
-      static const UnitName Zero() { return From(0.0); }                                                                               \
-                                                                                                                                       \
-      template <typename V> static const UnitName From(V value) { return UnitName(static_cast<Storage>(value)); }                      \
-      template <typename V> const V To() const { return static_cast<V>(m_data); }                                                      \
-                                                                                                                                       \
-      const Storage GetRaw() const { return m_data; }                                                                                  \
-                                                                                                                                       \
-      const UnitName operator+(const UnitName rhs) const { return UnitName(m_data + rhs.m_data); }                                     \
-      const UnitName operator-(const UnitName rhs) const { return UnitName(m_data - rhs.m_data); }                                     \
-      const UnitName operator+() const { return UnitName(+m_data); }                                                                   \
-      const UnitName operator-() const { return UnitName(-m_data); }                                                                   \
-      const bool operator>(const UnitName rhs) const { return m_data > rhs.m_data; }                                                   \
-      const bool operator>=(const UnitName rhs) const { return m_data >= rhs.m_data; }                                                 \
-      const bool operator<(const UnitName rhs) const { return m_data < rhs.m_data; }                                                   \
-      const bool operator<=(const UnitName rhs) const { return m_data <= rhs.m_data; }                                                 \
-      const bool operator==(const UnitName rhs) const { return m_data == rhs.m_data; }                                                 \
-      const bool operator!=(const UnitName rhs) const { return m_data != rhs.m_data; }                                                 \
-                                                                                                                                       \
-      template <typename V> const UnitName operator*(const V rhs) const { return From(m_data * rhs); }                                 \
-      template <typename V> const UnitName operator/(const V rhs) const { return From(m_data / rhs); }                                 \
-      template <typename V> UnitName &operator*=(const V rhs) { m_data *= static_cast<Storage>(rhs); return *this; }                   \
-      template <typename V> UnitName &operator/=(const V rhs) { m_data /= static_cast<Storage>(rhs); return *this; }                   \
-                                                                                                                                       \
-    private:                                                                                                                           \
-      explicit UnitName(Storage data) : m_data(data) { }                                                                               \
-  Storage m_data;                                                                                                                      \
+
+// quantities
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    // scalar type a storage type can be multiplied by (lane type for packs, double for number classes)
+    template <typename Storage, typename = void> struct FactorOf { typedef double Type; };
+    template <typename Storage> struct FactorOf<Storage, typename std::enable_if<std::is_arithmetic<Storage>::value>::type> { typedef Storage Type; };
+    template <typename Storage> struct FactorOf<Storage, std::void_t<typename Storage::Scalar>> { typedef typename Storage::Scalar Type; };
+
+    // value * (numerator / denominator), with the factor folded at compile time
+    // whole multiples & fractions (e.g. km -> m, m -> km) multiply or divide exactly like std::chrono does,
+    // other ratios multiply once by the folded factor in floating point, or multiply then divide in integers
+    template <long long kNumerator, long long kDenominator, typename Storage>
+    constexpr Storage Rescale(const Storage value) noexcept
+    {
+      typedef typename FactorOf<Storage>::Type Factor;
+      if constexpr (kNumerator == kDenominator)
+        return value;
+      else if constexpr (kDenominator == 1)
+        return value * static_cast<Factor>(kNumerator);
+      else if constexpr (kNumerator == 1)
+        return value / static_cast<Factor>(kDenominator);
+      else if constexpr (std::is_integral<Factor>::value)
+        return value * static_cast<Factor>(kNumerator) / static_cast<Factor>(kDenominator);
+      else
+        return value * static_cast<Factor>(static_cast<long double>(kNumerator) / static_cast<long double>(kDenominator));
+    }
+
+    // largest & lowest finite values of a storage type, behind Quantity::PosInfinity & NegInfinity
+    // arithmetic types are covered here with <cfloat> & <climits> rather than <limits>, which every includer would pay for;
+    // class storage types specialize it themselves (see units/fixed.h, units/half.h & units/pack.h)
+    template <typename Storage, typename = void>
+    struct StorageLimits;
+
+    template <typename Storage>
+    struct StorageLimits<Storage, typename std::enable_if<std::is_integral<Storage>::value>::type>
+    {
+      static constexpr Storage Max() noexcept { return static_cast<Storage>(std::is_signed<Storage>::value ? ~0ull >> (CHAR_BIT * (sizeof(unsigned long long) - sizeof(Storage)) + 1) : ~0ull); }
+      static constexpr Storage Lowest() noexcept { return std::is_signed<Storage>::value ? static_cast<Storage>(-Max() - 1) : Storage(); }
+    };
+
+    template <typename Storage>
+    struct StorageLimits<Storage, typename std::enable_if<std::is_floating_point<Storage>::value>::type>
+    {
+      static constexpr Storage Max() noexcept { return static_cast<Storage>(std::is_same<Storage, float>::value ? FLT_MAX : (std::is_same<Storage, double>::value ? DBL_MAX : LDBL_MAX)); }
+      static constexpr Storage Lowest() noexcept { return -Max(); }
+    };
+  }
+
+  namespace internal
+  {
+    // storage types that hold fractions, like std::chrono::treat_as_floating_point; converting into them is never truncating
+    // class storage types specialize it next to their StorageLimits (see units/half.h & units/pack.h), fixed-point counts as integral
+    template <typename Storage, typename = void>
+    struct IsFloatingStorage : std::is_floating_point<Storage> { };
+
+    // conversions that are implicit: into floating-point storage from anything, or by a whole factor (e.g. seconds -> nanoseconds) from non-floating storage
+    template <typename Storage, typename RhsStorage, Dimension kRatio>
+    struct IsExactConversion
+      : std::integral_constant<bool, IsFloatingStorage<Storage>::value || (kRatio.m_scaleDenominator == 1 && !IsFloatingStorage<RhsStorage>::value)>
+    { };
+  }
+
+  // a value of a given storage type tagged with a compile-time dimension
+  // all unit macros below are thin aliases of this template, so products and quotients of any two units
+  // get the right type without a hand-written relationship
+  template <typename StorageType, Dimension kDim>
+  class Quantity
+  {
+    public:
+      typedef StorageType Storage;
+      static constexpr Dimension kDimension = kDim;
+
+      static constexpr Quantity PosInfinity() noexcept { return Quantity(internal::StorageLimits<Storage>::Max()); }
+      static constexpr Quantity NegInfinity() noexcept { return Quantity(internal::StorageLimits<Storage>::Lowest()); }
+      static constexpr Quantity Zero() noexcept { return Quantity(Storage()); } // value-initialized, no float round trip
+
+      template <typename V> static constexpr Quantity From(V value) noexcept { return Quantity(static_cast<Storage>(value)); }
+      template <typename V> constexpr V To() const noexcept { return static_cast<V>(m_data); }
+
+      constexpr Storage GetRaw() const noexcept { return m_data; }
+
+      Quantity() = default;
+
+      // same dimension, different storage and/or scale (e.g. kilometers to meters), converted by a compile-time factor
+      // implicit only when nothing is truncated, as with std::chrono::duration; otherwise explicit (see unit_cast), e.g. nanoseconds to integer seconds
+      template <typename RhsStorage, Dimension kRhs, typename = typename std::enable_if<HasSameBaseDimensions(kRhs, kDim)>::type>
+      constexpr explicit(!internal::IsExactConversion<Storage, RhsStorage, DivideDimensions(kRhs, kDim)>::value) Quantity(const Quantity<RhsStorage, kRhs> rhs) noexcept
+        : m_data(internal::Rescale<DivideDimensions(kRhs, kDim).m_scaleNumerator, DivideDimensions(kRhs, kDim).m_scaleDenominator>(static_cast<Storage>(rhs.GetRaw())))
+      { }
+
+    private:
+      constexpr explicit Quantity(Storage data) noexcept : m_data(data) { }
+      Storage m_data;
+  };
+
+  // explicit conversion between units of the same dimension, truncating toward zero for integral storage
+  template <typename To, typename Storage, Dimension kDim>
+  constexpr To unit_cast(const Quantity<Storage, kDim> from) noexcept
+  {
+    return To(from);
+  }
+
+  // arithmetic & comparison operators are free templates rather than members, so a unit definition instantiates only the members above;
+  // the right-hand side is not deduced (std::type_identity_t), so it converts like a member operand would (e.g. Length + Kilometers)
+  template <typename Storage, Dimension kDim>
+  using SameQuantity = std::type_identity_t<Quantity<Storage, kDim>>;
+
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> operator+(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return Quantity<Storage, kDim>::From(lhs.GetRaw() + rhs.GetRaw()); }
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> operator-(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return Quantity<Storage, kDim>::From(lhs.GetRaw() - rhs.GetRaw()); }
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> operator+(const Quantity<Storage, kDim> value) noexcept { return Quantity<Storage, kDim>::From(+value.GetRaw()); }
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> operator-(const Quantity<Storage, kDim> value) noexcept { return Quantity<Storage, kDim>::From(-value.GetRaw()); }
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> &operator+=(Quantity<Storage, kDim> &lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs = lhs + rhs; }
+  template <typename Storage, Dimension kDim>
+  constexpr Quantity<Storage, kDim> &operator-=(Quantity<Storage, kDim> &lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs = lhs - rhs; }
+
+  // bool for scalar storage, lane masks for packed storage (see units/pack.h)
+  template <typename Storage, Dimension kDim>
+  constexpr auto operator>(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs.GetRaw() > rhs.GetRaw(); }
+  template <typename Storage, Dimension kDim>
+  constexpr auto operator>=(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs.GetRaw() >= rhs.GetRaw(); }
+  template <typename Storage, Dimension kDim>
+  constexpr auto operator<(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs.GetRaw() < rhs.GetRaw(); }
+  template <typename Storage, Dimension kDim>
+  constexpr auto operator<=(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs.GetRaw() <= rhs.GetRaw(); }
+  template <typename Storage, Dimension kDim>
+  constexpr auto operator==(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs.GetRaw() == rhs.GetRaw(); }
+  template <typename Storage, Dimension kDim>
+  constexpr auto operator!=(const Quantity<Storage, kDim> lhs, const SameQuantity<Storage, kDim> rhs) noexcept { return lhs.GetRaw() != rhs.GetRaw(); }
+
+  template <typename Storage, Dimension kDim, typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+  constexpr Quantity<Storage, kDim> operator*(const Quantity<Storage, kDim> lhs, const V rhs) noexcept { return Quantity<Storage, kDim>::From(lhs.GetRaw() * rhs); }
+  template <typename Storage, Dimension kDim, typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+  constexpr Quantity<Storage, kDim> operator/(const Quantity<Storage, kDim> lhs, const V rhs) noexcept { return Quantity<Storage, kDim>::From(lhs.GetRaw() / rhs); }
+  template <typename Storage, Dimension kDim, typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+  constexpr Quantity<Storage, kDim> &operator*=(Quantity<Storage, kDim> &lhs, const V rhs) noexcept { return lhs = Quantity<Storage, kDim>::From(lhs.GetRaw() * static_cast<Storage>(rhs)); }
+  template <typename Storage, Dimension kDim, typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+  constexpr Quantity<Storage, kDim> &operator/=(Quantity<Storage, kDim> &lhs, const V rhs) noexcept { return lhs = Quantity<Storage, kDim>::From(lhs.GetRaw() / static_cast<Storage>(rhs)); }
+
+  template <typename T> struct IsQuantity : std::false_type { };
+  template <typename Storage, Dimension kDim> struct IsQuantity<Quantity<Storage, kDim>> : std::true_type { };
+
+  namespace internal
+  {
+    // the layout contract of every unit with this storage (see UNITS_LAYOUT_CHECK)
+    template <typename Storage>
+    struct IsLayoutCompatible
+    {
+      typedef Quantity<Storage, Dimension{ }> Unit;
+      static constexpr bool value = std::is_trivially_copyable<Unit>::value && std::is_standard_layout<Unit>::value
+                                    && sizeof(Unit) == sizeof(Storage) && alignof(Unit) == alignof(Storage);
+    };
+  }
+
+  // dimensionless results collapse to the raw storage type (e.g. length / length), with any scale applied (e.g. kilometers / meters)
+  template <typename Storage, Dimension kDim>
+  using QuantityOf = typename std::conditional<IsDimensionless(kDim), Storage, Quantity<Storage, kDim>>::type;
+
+  template <typename Result, Dimension kDim, typename V>
+  constexpr Result MakeQuantity(V value) noexcept
+  {
+    if constexpr (!IsQuantity<Result>::value)
+      return internal::Rescale<kDim.m_scaleNumerator, kDim.m_scaleDenominator>(static_cast<Result>(value));
+    else
+      return Result::From(value);
+  }
+
+  template <typename V, typename Storage, Dimension kDim, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+  constexpr Quantity<Storage, kDim> operator*(const V lhs, const Quantity<Storage, kDim> rhs) noexcept
+  {
+    return Quantity<Storage, kDim>::From(lhs * rhs.GetRaw());
+  }
+
+  // result types are deduced rather than spelled out, keeping dimension arithmetic out of mangled names
+
+  template <typename V, typename Storage, Dimension kDim, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+  constexpr auto operator/(const V lhs, const Quantity<Storage, kDim> rhs) noexcept
+  {
+    return Quantity<Storage, InvertDimension(kDim)>::From(lhs / rhs.GetRaw());
+  }
+
+  template <typename LhsStorage, Dimension kLhs, typename RhsStorage, Dimension kRhs>
+  constexpr auto operator*(const Quantity<LhsStorage, kLhs> lhs, const Quantity<RhsStorage, kRhs> rhs) noexcept
+  {
+    constexpr Dimension kResult = MultiplyDimensions(kLhs, kRhs);
+    typedef QuantityOf<decltype(LhsStorage() * RhsStorage()), kResult> Result;
+    return MakeQuantity<Result, kResult>(lhs.GetRaw() * rhs.GetRaw());
+  }
+
+  template <typename LhsStorage, Dimension kLhs, typename RhsStorage, Dimension kRhs>
+  constexpr auto operator/(const Quantity<LhsStorage, kLhs> lhs, const Quantity<RhsStorage, kRhs> rhs) noexcept
+  {
+    constexpr Dimension kResult = DivideDimensions(kLhs, kRhs);
+    typedef QuantityOf<decltype(LhsStorage() / RhsStorage()), kResult> Result;
+    if constexpr (!IsQuantity<Result>::value && std::is_integral<Result>::value)
+      return internal::Rescale<kResult.m_scaleNumerator, 1>(lhs.GetRaw()) / internal::Rescale<kResult.m_scaleDenominator, 1>(rhs.GetRaw()); // scale before the truncating divide, so 3 km / 2 m is 1500, not 1 * 1000
+    else
+      return MakeQuantity<Result, kResult>(lhs.GetRaw() / rhs.GetRaw());
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: quantities
+
+
+// basic units
+// ------------------------------------------------------------------------------------------------------------------------------
 
 #define BASIC_UNIT_EXTERNAL(UnitName, StorageType, LiteralSuffix)                                                                      \
-  template <typename V> const UnitName operator*(V lhs, UnitName rhs) { return UnitName::From(lhs * rhs.GetRaw()); }                   \
-  static const UnitName operator"" LiteralSuffix (long double data) { return UnitName::From(static_cast<UnitName::Storage>(data)); }   \
-  static const UnitName operator"" LiteralSuffix (std::size_t data) { return UnitName::From(static_cast<UnitName::Storage>(data)); }   \
+  constexpr UnitName operator"" LiteralSuffix (long double data) noexcept { return UnitName::From(static_cast<UnitName::Storage>(data)); }   \
+  constexpr UnitName operator"" LiteralSuffix (unsigned long long data) noexcept { return UnitName::From(static_cast<UnitName::Storage>(data)); } \
 
 #define MAKE_BASIC_UNIT(UnitName, StorageType, LiteralSuffix)                                                                          \
-  class UnitName                                                                                                                       \
-  {                                                                                                                                    \
-    BASIC_UNIT_INTERNAL(UnitName, StorageType)                                                                                         \
-  };                                                                                                                                   \
+  typedef units::Quantity<StorageType, units::BaseDimension(#UnitName)> UnitName;                                                      \
   BASIC_UNIT_EXTERNAL(UnitName, StorageType, LiteralSuffix)                                                                            \
-  UNITS_MACRO_END_HELPER(UnitName)                                                                                                     \
+  UNITS_REGISTER_UNIT(UnitName, LiteralSuffix)                                                                                         \
+  UNITS_LAYOUT_CHECK(UnitName)                                                                                                         \
 
 // ------------------------------------------------------------------------------------------------------------------------------
 // end basic units
@@ -73,24 +476,11 @@
 // derived units (division)
 // ------------------------------------------------------------------------------------------------------------------------------
 
-#define DERIVED_UNIT_DIV_INTERNAL(UnitName, LhsType, RhsType)                                                                          \
-    public:                                                                                                                            \
-      typedef LhsType Lhs;                                                                                                             \
-      typedef RhsType Rhs;                                                                                                             \
-      const Lhs operator*(Rhs rhs) const { return Lhs::From(m_data * rhs.GetRaw()); }
-
-#define DERIVED_UNIT_DIV_EXTERNAL(UnitName, LhsType, RhsType)                                                                          \
-  static const UnitName operator/(LhsType lhs, RhsType rhs) { return UnitName::From(lhs.GetRaw() / rhs.GetRaw()); }                    \
-
 #define MAKE_DERIVED_UNIT_DIV(UnitName, StorageType, LiteralSuffix, LhsType, RhsType)                                                  \
-  class UnitName                                                                                                                       \
-  {                                                                                                                                    \
-    BASIC_UNIT_INTERNAL(UnitName, StorageType)                                                                                         \
-    DERIVED_UNIT_DIV_INTERNAL(UnitName, LhsType, RhsType)                                                                              \
-  };                                                                                                                                   \
+  typedef units::Quantity<StorageType, units::DivideDimensions(LhsType::kDimension, RhsType::kDimension)> UnitName;                    \
   BASIC_UNIT_EXTERNAL(UnitName, StorageType, LiteralSuffix)                                                                            \
-  DERIVED_UNIT_DIV_EXTERNAL(UnitName, LhsType, RhsType)                                                                                \
-  UNITS_MACRO_END_HELPER(UnitName)                                                                                                     \
+  UNITS_REGISTER_UNIT(UnitName, LiteralSuffix)                                                                                         \
+  UNITS_LAYOUT_CHECK(UnitName)                                                                                                         \
 
 // ------------------------------------------------------------------------------------------------------------------------------
 // end: derived units (division)
@@ -99,68 +489,74 @@
 // derived units (multiplication)
 // ------------------------------------------------------------------------------------------------------------------------------
 
-#define DERIVED_UNIT_MUL_INTERNAL(UnitName, LhsType, RhsType)                                                                          \
-    public:                                                                                                                            \
-      typedef LhsType Lhs;                                                                                                             \
-      typedef RhsType Rhs;                                                                                                             \
-      const Lhs operator/(Rhs rhs) const { return Lhs::From(m_data / rhs.GetRaw()); }                                                  \
-      const Rhs operator/(Lhs lhs) const { return Rhs::From(m_data / lhs.GetRaw()); }                                                  \
-
-#define DERIVED_UNIT_MUL_EXTERNAL(UnitName, LhsType, RhsType)                                                                          \
-  static const UnitName operator*(LhsType lhs, RhsType rhs) { return UnitName::From(lhs.GetRaw() * rhs.GetRaw()); }                    \
-  static const UnitName operator*(RhsType rhs, LhsType lhs) { return UnitName::From(rhs.GetRaw() * lhs.GetRaw()); }                    \
-
 #define MAKE_DERIVED_UNIT_MUL(UnitName, StorageType, LiteralSuffix, LhsType, RhsType)                                                  \
-  class UnitName                                                                                                                       \
-  {                                                                                                                                    \
-    BASIC_UNIT_INTERNAL(UnitName, StorageType)                                                                                         \
-    DERIVED_UNIT_MUL_INTERNAL(UnitName, LhsType, RhsType)                                                                              \
-  };                                                                                                                                   \
+  typedef units::Quantity<StorageType, units::MultiplyDimensions(LhsType::kDimension, RhsType::kDimension)> UnitName;                  \
   BASIC_UNIT_EXTERNAL(UnitName, StorageType, LiteralSuffix)                                                                            \
-  DERIVED_UNIT_MUL_EXTERNAL(UnitName, LhsType, RhsType)                                                                                \
-  UNITS_MACRO_END_HELPER(UnitName)                                                                                                     \
+  UNITS_REGISTER_UNIT(UnitName, LiteralSuffix)                                                                                         \
+  UNITS_LAYOUT_CHECK(UnitName)                                                                                                         \
 
 // ------------------------------------------------------------------------------------------------------------------------------
 // end: derived units (multiplication)
 
 
-// reference class
-/*
-class Meter
+// unit variants
+// ------------------------------------------------------------------------------------------------------------------------------
+
+// same dimension as an existing unit, different storage (e.g. fixed-point, see units/fixed.h)
+#define MAKE_UNIT_VARIANT(UnitName, StorageType, LiteralSuffix, UnitType)                                                              \
+  typedef units::Quantity<StorageType, UnitType::kDimension> UnitName;                                                                 \
+  BASIC_UNIT_EXTERNAL(UnitName, StorageType, LiteralSuffix)                                                                            \
+  UNITS_REGISTER_UNIT(UnitName, LiteralSuffix)                                                                                         \
+  UNITS_LAYOUT_CHECK(UnitName)                                                                                                         \
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: unit variants
+
+
+// scaled units
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
 {
-  public:
-    typedef float Storage;
-
-    static const Meter PosInfinity() { return Meter(std::numeric_limits<Storage>::max()); }
-    static const Meter NegInfinity() { return Meter(std::numeric_limits<Storage>::lowest()); }
-    static const Meter Zero() { return From(0.0); }
-
-    template <typename V> static const Meter From(V value) { return Meter(static_cast<Storage>(value)); }
-    template <typename V> const V To() const { return static_cast<V>(m_data); }
-
-    const Storage GetRaw() const { return m_data; }
-
-    const Meter operator+(const Meter rhs) const { return Meter(m_data + rhs.m_data); }
-    const Meter operator-(const Meter rhs) const { return Meter(m_data - rhs.m_data); }
-    const Meter operator>(const Meter rhs) const { return m_data > rhs.m_data; }
-    const Meter operator>=(const Meter rhs) const { return m_data >= rhs.m_data; }
-    const Meter operator<(const Meter rhs) const { return m_data < rhs.m_data; }
-    const Meter operator<=(const Meter rhs) const { return m_data <= rhs.m_data; }
-    const Meter operator==(const Meter rhs) const { return m_data == rhs.m_data; }
-    
-    template <typename V> const Meter operator*(const V rhs) const { return From(m_data * rhs); }
-    template <typename V> const Meter operator/(const V rhs) const { return From(m_data / rhs); }
-    template <typename V> Meter &operator*=(const V rhs) { m_data *= static_cast<Storage>(rhs); return *this; }
-    template <typename V> Meter &operator/=(const V rhs) { m_data /= static_cast<Storage>(rhs); return *this; }
-
-  protected:
-    Meter(Storage data) : m_data(data) { }
-    Storage m_data;
-};
-
-template <typename V> const Meter operator*(V lhs, Meter rhs) { return Meter::From(lhs * rhs.GetRaw()); }
-const Meter operator""_m(long double data) { return Meter::From(static_cast<Meter::Storage>(data)); }
-const Meter operator""_m(std::size_t data) { return Meter::From(static_cast<Meter::Storage>(data)); }
+  // unit scaled by a ratio of another unit, e.g. Scaled<Length, std::kilo> or Scaled<Time, std::ratio<3600>>
+  // any type with num & den members works as the ratio; scales fold through products and quotients at compile time
+  template <typename Unit, typename Ratio>
+  using Scaled = Quantity<typename Unit::Storage, ScaleDimension(Unit::kDimension, Ratio::num, Ratio::den)>;
+}
+
+#define MAKE_SCALED_UNIT(UnitName, LiteralSuffix, UnitType, Ratio)                                                                    \
+  typedef units::Scaled<UnitType, Ratio> UnitName;                                                                                     \
+  BASIC_UNIT_EXTERNAL(UnitName, UnitName::Storage, LiteralSuffix)                                                                      \
+  UNITS_REGISTER_UNIT(UnitName, LiteralSuffix)                                                                                         \
+  UNITS_LAYOUT_CHECK(UnitName)                                                                                                         \
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: scaled units
+
+
+// reference expansion
+/*
+MAKE_BASIC_UNIT(Length, float, _m);
+MAKE_BASIC_UNIT(Time, float, _s);
+MAKE_DERIVED_UNIT_DIV(Velocity, float, _m_s, Length, Time);
+
+typedef units::Quantity<float, units::BaseDimension("Length")> Length;
+constexpr Length operator""_m(long double data) noexcept { return Length::From(static_cast<Length::Storage>(data)); }
+constexpr Length operator""_m(unsigned long long data) noexcept { return Length::From(static_cast<Length::Storage>(data)); }
+static_assert(units::internal::IsLayoutCompatible<Length::Storage>::value, "Length must be layout-compatible with its storage type");
+
+typedef units::Quantity<float, units::BaseDimension("Time")> Time;
+constexpr Time operator""_s(long double data) noexcept { return Time::From(static_cast<Time::Storage>(data)); }
+constexpr Time operator""_s(unsigned long long data) noexcept { return Time::From(static_cast<Time::Storage>(data)); }
+
+typedef units::Quantity<float, units::DivideDimensions(Length::kDimension, Time::kDimension)> Velocity;
+constexpr Velocity operator""_m_s(long double data) noexcept { return Velocity::From(static_cast<Velocity::Storage>(data)); }
+constexpr Velocity operator""_m_s(unsigned long long data) noexcept { return Velocity::From(static_cast<Velocity::Storage>(data)); }
+
+// no hand-written relationships needed
+const Velocity v = 4.0_m / 2.0_s;
+const Length l = v * 2.0_s;
+const float ratio = 4.0_m / 2.0_m;
 */
 
 
@@ -0,0 +1,216 @@
+/******************************************************************************/
+/*
+  Author  - Ming-Lun "Allen" Chou
+  Web     - http://AllenChou.net
+  Twitter - @TheAllenChou
+*/
+/******************************************************************************/
+
+#ifndef UNITS_VECTOR_H
+#define UNITS_VECTOR_H
+
+
+#include <cmath>
+
+#include "units/units.h"
+
+
+// vectors
+// ------------------------------------------------------------------------------------------------------------------------------
+
+namespace units
+{
+  namespace internal
+  {
+    template <typename T>
+    constexpr auto RawOf(const T value) noexcept
+    {
+      if constexpr (IsQuantity<T>::value)
+        return value.GetRaw();
+      else
+        return value;
+    }
+
+    template <typename T, typename V>
+    constexpr T FromRaw(const V raw) noexcept
+    {
+      if constexpr (IsQuantity<T>::value)
+        return T::From(raw);
+      else
+        return static_cast<T>(raw);
+    }
+  }
+
+  // 2D/3D/4D vector of a unit (or of a raw scalar type, e.g. directions), e.g. Vec3<Length> for positions
+  // 3D vectors are padded with a zero fourth lane and aligned to four elements, so Vec3<Length> is one 16-byte SSE/NEON register;
+  // element-wise operations run over all padded lanes as fixed-trip-count loops, which compilers turn into single vector instructions
+  template <typename UnitType, int kSize>
+  class Vec
+  {
+    static_assert(kSize >= 2 && kSize <= 4, "vectors have 2 to 4 elements");
+
+    public:
+      typedef UnitType Unit;
+      static const int kNumElements = kSize;
+      static const int kNumLanes = (kSize == 3) ? 4 : kSize;
+
+      Vec() = default;
+      constexpr Vec(const Unit x, const Unit y) noexcept requires (kSize == 2) : m_elements{ x, y } { }
+      constexpr Vec(const Unit x, const Unit y, const Unit z) noexcept requires (kSize == 3) : m_elements{ x, y, z, Unit() } { }
+      constexpr Vec(const Unit x, const Unit y, const Unit z, const Unit w) noexcept requires (kSize == 4) : m_elements{ x, y, z, w } { }
+
+      static constexpr Vec Zero() noexcept { return Vec(Lanes()); }
+
+      // same dimension, different storage and/or scale, element by element
+      template <typename RhsUnit, typename = typename std::enable_if<std::is_convertible<RhsUnit, Unit>::value && !std::is_same<RhsUnit, Unit>::value>::type>
+      constexpr Vec(const Vec<RhsUnit, kSize> &rhs) noexcept : m_elements()
+      {
+        for (int i = 0; i < kSize; ++i)
+          m_elements[i] = rhs[i];
+      }
+
+      constexpr Unit operator[](const int i) const noexcept { return m_elements[i]; }
+      constexpr Unit &operator[](const int i) noexcept { return m_elements[i]; }
+
+      constexpr Unit X() const noexcept { return m_elements[0]; }
+      constexpr Unit Y() const noexcept { return m_elements[1]; }
+      constexpr Unit Z() const noexcept requires (kSize >= 3) { return m_elements[2]; }
+      constexpr Unit W() const noexcept requires (kSize == 4) { return m_elements[3]; }
+      constexpr Unit &X() noexcept { return m_elements[0]; }
+      constexpr Unit &Y() noexcept { return m_elements[1]; }
+      constexpr Unit &Z() noexcept requires (kSize >= 3) { return m_elements[2]; }
+      constexpr Unit &W() noexcept requires (kSize == 4) { return m_elements[3]; }
+
+      constexpr Vec operator+(const Vec &rhs) const noexcept { Vec result = *this; for (int i = 0; i < kNumLanes; ++i) result.m_elements[i] += rhs.m_elements[i]; return result; }
+      constexpr Vec operator-(const Vec &rhs) const noexcept { Vec result = *this; for (int i = 0; i < kNumLanes; ++i) result.m_elements[i] -= rhs.m_elements[i]; return result; }
+      constexpr Vec operator+() const noexcept { return *this; }
+      constexpr Vec operator-() const noexcept { Vec result = *this; for (int i = 0; i < kNumLanes; ++i) result.m_elements[i] = -m_elements[i]; return result; }
+      constexpr Vec &operator+=(const Vec &rhs) noexcept { return *this = *this + rhs; }
+      constexpr Vec &operator-=(const Vec &rhs) noexcept { return *this = *this - rhs; }
+
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      constexpr Vec &operator*=(const V rhs) noexcept { for (int i = 0; i < kNumLanes; ++i) m_elements[i] *= rhs; return *this; }
+      template <typename V, typename = typename std::enable_if<std::is_arithmetic<V>::value>::type>
+      constexpr Vec &operator/=(const V rhs) noexcept { for (int i = 0; i < kNumLanes; ++i) m_elements[i] /= rhs; return *this; }
+
+      constexpr bool operator==(const Vec &rhs) const noexcept
+      {
+        bool result = true;
+        for (int i = 0; i < kSize; ++i)
+          result = result && (m_elements[i] == rhs.m_elements[i]);
+        return result;
+      }
+
+      constexpr bool operator!=(const Vec &rhs) const noexcept { return !(*this == rhs); }
+
+    private:
+      struct Lanes { };
+      constexpr explicit Vec(Lanes) noexcept : m_elements() { }
+
+      alignas(kNumLanes * sizeof(Unit)) Unit m_elements[kNumLanes];
+  };
+
+  template <typename Unit> using Vec2 = Vec<Unit, 2>;
+  template <typename Unit> using Vec3 = Vec<Unit, 3>;
+  template <typename Unit> using Vec4 = Vec<Unit, 4>;
+
+  template <typename T> struct IsVec : std::false_type { };
+  template <typename Unit, int kSize> struct IsVec<Vec<Unit, kSize>> : std::true_type { };
+
+  namespace internal
+  {
+    // single values vectors can be scaled by: raw scalars or units (e.g. velocity * time step)
+    template <typename T>
+    struct IsVecFactor : std::integral_constant<bool, IsQuantity<T>::value || std::is_arithmetic<T>::value> { };
+
+    template <typename Result, typename Lhs, typename Rhs, typename Op>
+    constexpr Result MapLanes(const Lhs &lhs, const Rhs &rhs, const Op op) noexcept
+    {
+      Result result = Result::Zero();
+      for (int i = 0; i < Result::kNumLanes; ++i)
+      {
+        if constexpr (IsVec<Lhs>::value && IsVec<Rhs>::value)
+          result[i] = op(lhs[i], rhs[i]);
+        else if constexpr (IsVec<Lhs>::value)
+          result[i] = op(lhs[i], rhs);
+        else
+          result[i] = op(lhs, rhs[i]);
+      }
+      return result;
+    }
+  }
+
+  // vector * factor and factor * vector, e.g. Vec3<Velocity> * Time -> Vec3<Length>
+
+  template <typename Unit, int kSize, typename V, typename = typename std::enable_if<internal::IsVecFactor<V>::value>::type>
+  constexpr auto operator*(const Vec<Unit, kSize> &lhs, const V rhs) noexcept
+  {
+    typedef Vec<decltype(Unit() * V()), kSize> Result;
+    return internal::MapLanes<Result>(lhs, rhs, [](const Unit a, const V b) { return a * b; });
+  }
+
+  template <typename Unit, int kSize, typename V, typename = typename std::enable_if<internal::IsVecFactor<V>::value>::type>
+  constexpr auto operator*(const V lhs, const Vec<Unit, kSize> &rhs) noexcept
+  {
+    typedef Vec<decltype(V() * Unit()), kSize> Result;
+    return internal::MapLanes<Result>(lhs, rhs, [](const V a, const Unit b) { return a * b; });
+  }
+
+  // the zero pad lane of a 3D vector stays zero unless the divisor is zero (it is never read back)
+  template <typename Unit, int kSize, typename V, typename = typename std::enable_if<internal::IsVecFactor<V>::value>::type>
+  constexpr auto operator/(const Vec<Unit, kSize> &lhs, const V rhs) noexcept
+  {
+    typedef Vec<decltype(Unit() / V()), kSize> Result;
+    return internal::MapLanes<Result>(lhs, rhs, [](const Unit a, const V b) { return a / b; });
+  }
+
+  // sum of element-wise products, e.g. dot(Vec3<Length>, Vec3<Length>) -> Area
+  template <typename LhsUnit, typename RhsUnit, int kSize>
+  constexpr auto dot(const Vec<LhsUnit, kSize> &lhs, const Vec<RhsUnit, kSize> &rhs) noexcept
+  {
+    auto result = lhs[0] * rhs[0];
+    for (int i = 1; i < kSize; ++i)
+      result += lhs[i] * rhs[i];
+    return result;
+  }
+
+  // e.g. cross(Vec3<Length>, Vec3<Force>) -> Vec3<Torque>
+  template <typename LhsUnit, typename RhsUnit>
+  constexpr auto cross(const Vec3<LhsUnit> &lhs, const Vec3<RhsUnit> &rhs) noexcept
+  {
+    typedef decltype(LhsUnit() * RhsUnit()) Product;
+    return Vec3<Product>
+    (
+      lhs[1] * rhs[2] - lhs[2] * rhs[1],
+      lhs[2] * rhs[0] - lhs[0] * rhs[2],
+      lhs[0] * rhs[1] - lhs[1] * rhs[0]
+    );
+  }
+
+  template <typename Unit, int kSize>
+  constexpr auto length_squared(const Vec<Unit, kSize> &v) noexcept
+  {
+    return dot(v, v);
+  }
+
+  template <typename Unit, int kSize>
+  inline Unit length(const Vec<Unit, kSize> &v) noexcept
+  {
+    return internal::FromRaw<Unit>(std::sqrt(internal::RawOf(length_squared(v))));
+  }
+
+  // dimensionless unit-length direction, e.g. normalize(Vec3<Length>) -> Vec3<float>; zero vectors are not allowed
+  template <typename Unit, int kSize>
+  inline auto normalize(const Vec<Unit, kSize> &v) noexcept
+  {
+    typedef decltype(internal::RawOf(Unit())) Storage;
+    const Storage inverseLength = Storage(1) / internal::RawOf(length(v));
+    return internal::MapLanes<Vec<Storage, kSize>>(v, inverseLength, [](const Unit a, const Storage b) { return internal::RawOf(a) * b; });
+  }
+}
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// end: vectors
+
+
+#endif